@@ -0,0 +1,1010 @@
+// A Bison parser, made by GNU Bison 3.8.2.
+
+// Skeleton interface for Bison LALR(1) parsers in C++
+
+// Copyright (C) 2002-2015, 2018-2021 Free Software Foundation, Inc.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// As a special exception, you may create a larger work that contains
+// part or all of the Bison parser skeleton and distribute that work
+// under terms of your choice, so long as that work isn't itself a
+// parser generator using the skeleton or a modified version thereof
+// as a parser skeleton.  Alternatively, if you modify or redistribute
+// the parser skeleton itself, you may (at your option) remove this
+// special exception, which will cause the skeleton and the resulting
+// Bison output files to be licensed under the GNU General Public
+// License without this special exception.
+
+// This special exception was added by the Free Software Foundation in
+// version 2.2 of Bison.
+
+
+/**
+ ** \file objs/cfdg.tab.hpp
+ ** Define the yy::parser class.
+ */
+
+// C++ LALR(1) parser skeleton written by Akim Demaille.
+
+// DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+// especially those whose name start with YY_ or yy_.  They are
+// private implementation details that can be changed or removed.
+
+#ifndef YY_YY_OBJS_CFDG_TAB_HPP_INCLUDED
+# define YY_YY_OBJS_CFDG_TAB_HPP_INCLUDED
+// "%code requires" blocks.
+#line 41 "src-common/cfdg.ypp"
+
+#include "builder.h"
+#include <string>
+namespace AST {
+    class ASTexpression;
+    class ASTmodTerm;
+    class ASTmodification;
+    class ASTpath;
+    class ASTreplacement;
+    class ASTbodyContainer;
+    class ASTloop;
+    class ASTif;
+    class ASTswitch;
+    class ASTpathBody;
+    class ASTpathLoop;
+    class ASTruleSpecifier;
+    class ASTrule;
+    class ASTdefine;
+}
+
+#line 70 "objs/cfdg.tab.hpp"
+
+
+# include <cstdlib> // std::abort
+# include <iostream>
+# include <stdexcept>
+# include <string>
+# include <vector>
+
+#if defined __cplusplus
+# define YY_CPLUSPLUS __cplusplus
+#else
+# define YY_CPLUSPLUS 199711L
+#endif
+
+// Support move semantics when possible.
+#if 201103L <= YY_CPLUSPLUS
+# define YY_MOVE           std::move
+# define YY_MOVE_OR_COPY   move
+# define YY_MOVE_REF(Type) Type&&
+# define YY_RVREF(Type)    Type&&
+# define YY_COPY(Type)     Type
+#else
+# define YY_MOVE
+# define YY_MOVE_OR_COPY   copy
+# define YY_MOVE_REF(Type) Type&
+# define YY_RVREF(Type)    const Type&
+# define YY_COPY(Type)     const Type&
+#endif
+
+// Support noexcept when possible.
+#if 201103L <= YY_CPLUSPLUS
+# define YY_NOEXCEPT noexcept
+# define YY_NOTHROW
+#else
+# define YY_NOEXCEPT
+# define YY_NOTHROW throw ()
+#endif
+
+// Support constexpr when possible.
+#if 201703 <= YY_CPLUSPLUS
+# define YY_CONSTEXPR constexpr
+#else
+# define YY_CONSTEXPR
+#endif
+# include "location.hh"
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+
+namespace yy {
+#line 205 "objs/cfdg.tab.hpp"
+
+
+
+
+  /// A Bison parser.
+  class CfdgParser
+  {
+  public:
+#ifdef YYSTYPE
+# ifdef __GNUC__
+#  pragma GCC message "bison: do not #define YYSTYPE in C++, use %define api.value.type"
+# endif
+    typedef YYSTYPE value_type;
+#else
+    /// Symbol semantic values.
+    union value_type
+    {
+#line 63 "src-common/cfdg.ypp"
+
+    int modToken;
+    std::string*  string;
+    const std::string*  cstring;
+    AST::ASTexpression* expression;
+    AST::ASTmodTerm* term;
+    AST::ASTmodification* mod;
+    AST::ASTreplacement* component;
+    AST::ASTloop* loopObj;
+    AST::ASTif* ifObj;
+    AST::ASTswitch* switchObj;
+    AST::ASTruleSpecifier* ruleSpec;
+    AST::ASTrule* ruleObj;
+    AST::ASTrepContainer* bodyObj;
+    AST::ASTdefine* defObj;
+
+#line 240 "objs/cfdg.tab.hpp"
+
+    };
+#endif
+    /// Backward compatibility (Bison 3.8).
+    typedef value_type semantic_type;
+
+    /// Symbol locations.
+    typedef location location_type;
+
+    /// Syntax errors thrown from user actions.
+    struct syntax_error : std::runtime_error
+    {
+      syntax_error (const location_type& l, const std::string& m)
+        : std::runtime_error (m)
+        , location (l)
+      {}
+
+      syntax_error (const syntax_error& s)
+        : std::runtime_error (s.what ())
+        , location (s.location)
+      {}
+
+      ~syntax_error () YY_NOEXCEPT YY_NOTHROW;
+
+      location_type location;
+    };
+
+    /// Token kinds.
+    struct token
+    {
+      enum token_kind_type
+      {
+        YYEMPTY = -2,
+    YYEOF = 0,                     // "end of file"
+    YYerror = 256,                 // error
+    YYUNDEF = 257,                 // "invalid token"
+    STARTSHAPE = 258,              // STARTSHAPE
+    CFDG2 = 259,                   // CFDG2
+    CFDG3 = 260,                   // CFDG3
+    SHAPE = 261,                   // SHAPE
+    RULE = 262,                    // RULE
+    PATH = 263,                    // PATH
+    DEFINE = 264,                  // DEFINE
+    BECOMES = 265,                 // BECOMES
+    LOOP = 266,                    // LOOP
+    FINALLY = 267,                 // FINALLY
+    IF = 268,                      // IF
+    ELSE = 269,                    // ELSE
+    SWITCH = 270,                  // SWITCH
+    CASE = 271,                    // CASE
+    CLONE = 272,                   // CLONE
+    LET = 273,                     // LET
+    MODTYPE = 274,                 // MODTYPE
+    PARAM = 275,                   // PARAM
+    BACKGROUND = 276,              // BACKGROUND
+    BADEOF = 277,                  // BADEOF
+    GOODEOF = 278,                 // GOODEOF
+    RANGEOP = 279,                 // RANGEOP
+    PLUSMINUSOP = 280,             // PLUSMINUSOP
+    USER_STRING = 281,             // USER_STRING
+    USER_INTEGER = 282,            // USER_INTEGER
+    USER_RATIONAL = 283,           // USER_RATIONAL
+    USER_FILENAME = 284,           // USER_FILENAME
+    USER_QSTRING = 285,            // USER_QSTRING
+    USER_ARRAYNAME = 286,          // USER_ARRAYNAME
+    INCLUDE = 287,                 // INCLUDE
+    IMPORT = 288,                  // IMPORT
+    TILE = 289,                    // TILE
+    PARAMETERS = 290,              // PARAMETERS
+    USER_PATHOP = 291,             // USER_PATHOP
+    STROKEWIDTH = 292,             // STROKEWIDTH
+    LE = 293,                      // LE
+    LT = 294,                      // LT
+    GE = 295,                      // GE
+    GT = 296,                      // GT
+    EQ = 297,                      // EQ
+    NEQ = 298,                     // NEQ
+    NOT = 299,                     // NOT
+    AND = 300,                     // AND
+    OR = 301,                      // OR
+    XOR = 302,                     // XOR
+    CF_INFINITY = 303,             // CF_INFINITY
+    NEG = 304,                     // NEG
+    POS = 305                      // POS
+      };
+      /// Backward compatibility alias (Bison 3.6).
+      typedef token_kind_type yytokentype;
+    };
+
+    /// Token kind, as returned by yylex.
+    typedef token::token_kind_type token_kind_type;
+
+    /// Backward compatibility alias (Bison 3.6).
+    typedef token_kind_type token_type;
+
+    /// Symbol kinds.
+    struct symbol_kind
+    {
+      enum symbol_kind_type
+      {
+        YYNTOKENS = 68, ///< Number of tokens.
+        S_YYEMPTY = -2,
+        S_YYEOF = 0,                             // "end of file"
+        S_YYerror = 1,                           // error
+        S_YYUNDEF = 2,                           // "invalid token"
+        S_STARTSHAPE = 3,                        // STARTSHAPE
+        S_CFDG2 = 4,                             // CFDG2
+        S_CFDG3 = 5,                             // CFDG3
+        S_SHAPE = 6,                             // SHAPE
+        S_RULE = 7,                              // RULE
+        S_PATH = 8,                              // PATH
+        S_DEFINE = 9,                            // DEFINE
+        S_BECOMES = 10,                          // BECOMES
+        S_LOOP = 11,                             // LOOP
+        S_FINALLY = 12,                          // FINALLY
+        S_IF = 13,                               // IF
+        S_ELSE = 14,                             // ELSE
+        S_SWITCH = 15,                           // SWITCH
+        S_CASE = 16,                             // CASE
+        S_CLONE = 17,                            // CLONE
+        S_LET = 18,                              // LET
+        S_MODTYPE = 19,                          // MODTYPE
+        S_PARAM = 20,                            // PARAM
+        S_BACKGROUND = 21,                       // BACKGROUND
+        S_BADEOF = 22,                           // BADEOF
+        S_GOODEOF = 23,                          // GOODEOF
+        S_RANGEOP = 24,                          // RANGEOP
+        S_PLUSMINUSOP = 25,                      // PLUSMINUSOP
+        S_USER_STRING = 26,                      // USER_STRING
+        S_USER_INTEGER = 27,                     // USER_INTEGER
+        S_USER_RATIONAL = 28,                    // USER_RATIONAL
+        S_USER_FILENAME = 29,                    // USER_FILENAME
+        S_USER_QSTRING = 30,                     // USER_QSTRING
+        S_USER_ARRAYNAME = 31,                   // USER_ARRAYNAME
+        S_INCLUDE = 32,                          // INCLUDE
+        S_IMPORT = 33,                           // IMPORT
+        S_TILE = 34,                             // TILE
+        S_PARAMETERS = 35,                       // PARAMETERS
+        S_USER_PATHOP = 36,                      // USER_PATHOP
+        S_STROKEWIDTH = 37,                      // STROKEWIDTH
+        S_LE = 38,                               // LE
+        S_LT = 39,                               // LT
+        S_GE = 40,                               // GE
+        S_GT = 41,                               // GT
+        S_EQ = 42,                               // EQ
+        S_NEQ = 43,                              // NEQ
+        S_NOT = 44,                              // NOT
+        S_AND = 45,                              // AND
+        S_OR = 46,                               // OR
+        S_XOR = 47,                              // XOR
+        S_CF_INFINITY = 48,                      // CF_INFINITY
+        S_49_ = 49,                              // ','
+        S_50_ = 50,                              // '-'
+        S_51_ = 51,                              // '+'
+        S_52___ = 52,                            // '_'
+        S_53_ = 53,                              // '*'
+        S_54_ = 54,                              // '/'
+        S_NEG = 55,                              // NEG
+        S_POS = 56,                              // POS
+        S_57_ = 57,                              // '^'
+        S_58_ = 58,                              // '('
+        S_59_ = 59,                              // '['
+        S_60_ = 60,                              // '@'
+        S_61_ = 61,                              // '{'
+        S_62_ = 62,                              // '}'
+        S_63_ = 63,                              // ')'
+        S_64_ = 64,                              // ':'
+        S_65_ = 65,                              // ']'
+        S_66_ = 66,                              // '|'
+        S_67_ = 67,                              // ';'
+        S_YYACCEPT = 68,                         // $accept
+        S_choose = 69,                           // choose
+        S_cfdg2 = 70,                            // cfdg2
+        S_cfdg3 = 71,                            // cfdg3
+        S_statement = 72,                        // statement
+        S_statement_v2 = 73,                     // statement_v2
+        S_v3clues = 74,                          // v3clues
+        S_v2stuff = 75,                          // v2stuff
+        S_inclusion = 76,                        // inclusion
+        S_import = 77,                           // import
+        S_eof = 78,                              // eof
+        S_fileString = 79,                       // fileString
+        S_fileNameSpace = 80,                    // fileNameSpace
+        S_initialization = 81,                   // initialization
+        S_initialization_v2 = 82,                // initialization_v2
+        S_directive_v2 = 83,                     // directive_v2
+        S_directive_string = 84,                 // directive_string
+        S_global_definition = 85,                // global_definition
+        S_function_definition_header = 86,       // function_definition_header
+        S_global_definition_header = 87,         // global_definition_header
+        S_definition_header = 88,                // definition_header
+        S_definition = 89,                       // definition
+        S_shape = 90,                            // shape
+        S_shape_singleton_header = 91,           // shape_singleton_header
+        S_shape_singleton = 92,                  // shape_singleton
+        S_rule_header_v2 = 93,                   // rule_header_v2
+        S_rule_v2 = 94,                          // rule_v2
+        S_rule_header = 95,                      // rule_header
+        S_path_header = 96,                      // path_header
+        S_rule = 97,                             // rule
+        S_path = 98,                             // path
+        S_path_header_v2 = 99,                   // path_header_v2
+        S_path_v2 = 100,                         // path_v2
+        S_parameter = 101,                       // parameter
+        S_buncha_parameters = 102,               // buncha_parameters
+        S_parameter_list = 103,                  // parameter_list
+        S_function_parameter_list = 104,         // function_parameter_list
+        S_parameter_spec = 105,                  // parameter_spec
+        S_buncha_elements = 106,                 // buncha_elements
+        S_buncha_pathOps_v2 = 107,               // buncha_pathOps_v2
+        S_pathOp_simple_v2 = 108,                // pathOp_simple_v2
+        S_element_simple = 109,                  // element_simple
+        S_one_or_more_elements = 110,            // one_or_more_elements
+        S_one_or_more_pathOp_v2 = 111,           // one_or_more_pathOp_v2
+        S_caseBody = 112,                        // caseBody
+        S_caseBody_element = 113,                // caseBody_element
+        S_element = 114,                         // element
+        S_115_1 = 115,                           // $@1
+        S_element_v2clue = 116,                  // element_v2clue
+        S_pathOp_v2 = 117,                       // pathOp_v2
+        S_pathOp_v3clues = 118,                  // pathOp_v3clues
+        S_element_loop = 119,                    // element_loop
+        S_buncha_replacements_v2 = 120,          // buncha_replacements_v2
+        S_one_or_more_replacements_v2 = 121,     // one_or_more_replacements_v2
+        S_replacement_simple_v2 = 122,           // replacement_simple_v2
+        S_replacement_v2 = 123,                  // replacement_v2
+        S_loopHeader_v2 = 124,                   // loopHeader_v2
+        S_125_2 = 125,                           // $@2
+        S_loopHeader = 126,                      // loopHeader
+        S_ifHeader = 127,                        // ifHeader
+        S_ifElseHeader = 128,                    // ifElseHeader
+        S_transHeader = 129,                     // transHeader
+        S_switchHeader = 130,                    // switchHeader
+        S_caseHeader = 131,                      // caseHeader
+        S_modification_v2 = 132,                 // modification_v2
+        S_modification = 133,                    // modification
+        S_buncha_adjustments = 134,              // buncha_adjustments
+        S_adjustment = 135,                      // adjustment
+        S_letHeader = 136,                       // letHeader
+        S_letBody = 137,                         // letBody
+        S_letVariables = 138,                    // letVariables
+        S_letVariable = 139,                     // letVariable
+        S_explist = 140,                         // explist
+        S_arglist = 141,                         // arglist
+        S_exp = 142,                             // exp
+        S_exp2 = 143,                            // exp2
+        S_exp3 = 144,                            // exp3
+        S_expfunc = 145,                         // expfunc
+        S_shapeName = 146                        // shapeName
+      };
+    };
+
+    /// (Internal) symbol kind.
+    typedef symbol_kind::symbol_kind_type symbol_kind_type;
+
+    /// The number of tokens.
+    static const symbol_kind_type YYNTOKENS = symbol_kind::YYNTOKENS;
+
+    /// A complete symbol.
+    ///
+    /// Expects its Base type to provide access to the symbol kind
+    /// via kind ().
+    ///
+    /// Provide access to semantic value and location.
+    template <typename Base>
+    struct basic_symbol : Base
+    {
+      /// Alias to Base.
+      typedef Base super_type;
+
+      /// Default constructor.
+      basic_symbol () YY_NOEXCEPT
+        : value ()
+        , location ()
+      {}
+
+#if 201103L <= YY_CPLUSPLUS
+      /// Move constructor.
+      basic_symbol (basic_symbol&& that)
+        : Base (std::move (that))
+        , value (std::move (that.value))
+        , location (std::move (that.location))
+      {}
+#endif
+
+      /// Copy constructor.
+      basic_symbol (const basic_symbol& that);
+      /// Constructor for valueless symbols.
+      basic_symbol (typename Base::kind_type t,
+                    YY_MOVE_REF (location_type) l);
+
+      /// Constructor for symbols with semantic value.
+      basic_symbol (typename Base::kind_type t,
+                    YY_RVREF (value_type) v,
+                    YY_RVREF (location_type) l);
+
+      /// Destroy the symbol.
+      ~basic_symbol ()
+      {
+        clear ();
+      }
+
+
+
+      /// Destroy contents, and record that is empty.
+      void clear () YY_NOEXCEPT
+      {
+        Base::clear ();
+      }
+
+#if YYDEBUG || 0
+      /// The user-facing name of this symbol.
+      const char *name () const YY_NOEXCEPT
+      {
+        return CfdgParser::symbol_name (this->kind ());
+      }
+#endif // #if YYDEBUG || 0
+
+
+      /// Backward compatibility (Bison 3.6).
+      symbol_kind_type type_get () const YY_NOEXCEPT;
+
+      /// Whether empty.
+      bool empty () const YY_NOEXCEPT;
+
+      /// Destructive move, \a s is emptied into this.
+      void move (basic_symbol& s);
+
+      /// The semantic value.
+      value_type value;
+
+      /// The location.
+      location_type location;
+
+    private:
+#if YY_CPLUSPLUS < 201103L
+      /// Assignment operator.
+      basic_symbol& operator= (const basic_symbol& that);
+#endif
+    };
+
+    /// Type access provider for token (enum) based symbols.
+    struct by_kind
+    {
+      /// The symbol kind as needed by the constructor.
+      typedef token_kind_type kind_type;
+
+      /// Default constructor.
+      by_kind () YY_NOEXCEPT;
+
+#if 201103L <= YY_CPLUSPLUS
+      /// Move constructor.
+      by_kind (by_kind&& that) YY_NOEXCEPT;
+#endif
+
+      /// Copy constructor.
+      by_kind (const by_kind& that) YY_NOEXCEPT;
+
+      /// Constructor from (external) token numbers.
+      by_kind (kind_type t) YY_NOEXCEPT;
+
+
+
+      /// Record that this symbol is empty.
+      void clear () YY_NOEXCEPT;
+
+      /// Steal the symbol kind from \a that.
+      void move (by_kind& that);
+
+      /// The (internal) type number (corresponding to \a type).
+      /// \a empty when empty.
+      symbol_kind_type kind () const YY_NOEXCEPT;
+
+      /// Backward compatibility (Bison 3.6).
+      symbol_kind_type type_get () const YY_NOEXCEPT;
+
+      /// The symbol kind.
+      /// \a S_YYEMPTY when empty.
+      symbol_kind_type kind_;
+    };
+
+    /// Backward compatibility for a private implementation detail (Bison 3.6).
+    typedef by_kind by_type;
+
+    /// "External" symbols: returned by the scanner.
+    struct symbol_type : basic_symbol<by_kind>
+    {};
+
+    /// Build a parser object.
+    CfdgParser (class Builder& driver_yyarg);
+    virtual ~CfdgParser ();
+
+#if 201103L <= YY_CPLUSPLUS
+    /// Non copyable.
+    CfdgParser (const CfdgParser&) = delete;
+    /// Non copyable.
+    CfdgParser& operator= (const CfdgParser&) = delete;
+#endif
+
+    /// Parse.  An alias for parse ().
+    /// \returns  0 iff parsing succeeded.
+    int operator() ();
+
+    /// Parse.
+    /// \returns  0 iff parsing succeeded.
+    virtual int parse ();
+
+#if YYDEBUG
+    /// The current debugging stream.
+    std::ostream& debug_stream () const YY_ATTRIBUTE_PURE;
+    /// Set the current debugging stream.
+    void set_debug_stream (std::ostream &);
+
+    /// Type for debugging levels.
+    typedef int debug_level_type;
+    /// The current debugging level.
+    debug_level_type debug_level () const YY_ATTRIBUTE_PURE;
+    /// Set the current debugging level.
+    void set_debug_level (debug_level_type l);
+#endif
+
+    /// Report a syntax error.
+    /// \param loc    where the syntax error is found.
+    /// \param msg    a description of the syntax error.
+    virtual void error (const location_type& loc, const std::string& msg);
+
+    /// Report a syntax error.
+    void error (const syntax_error& err);
+
+#if YYDEBUG || 0
+    /// The user-facing name of the symbol whose (internal) number is
+    /// YYSYMBOL.  No bounds checking.
+    static const char *symbol_name (symbol_kind_type yysymbol);
+#endif // #if YYDEBUG || 0
+
+
+
+
+  private:
+#if YY_CPLUSPLUS < 201103L
+    /// Non copyable.
+    CfdgParser (const CfdgParser&);
+    /// Non copyable.
+    CfdgParser& operator= (const CfdgParser&);
+#endif
+
+
+    /// Stored state numbers (used for stacks).
+    typedef short state_type;
+
+    /// Compute post-reduction state.
+    /// \param yystate   the current state
+    /// \param yysym     the nonterminal to push on the stack
+    static state_type yy_lr_goto_state_ (state_type yystate, int yysym);
+
+    /// Whether the given \c yypact_ value indicates a defaulted state.
+    /// \param yyvalue   the value to check
+    static bool yy_pact_value_is_default_ (int yyvalue) YY_NOEXCEPT;
+
+    /// Whether the given \c yytable_ value indicates a syntax error.
+    /// \param yyvalue   the value to check
+    static bool yy_table_value_is_error_ (int yyvalue) YY_NOEXCEPT;
+
+    static const short yypact_ninf_;
+    static const signed char yytable_ninf_;
+
+    /// Convert a scanner token kind \a t to a symbol kind.
+    /// In theory \a t should be a token_kind_type, but character literals
+    /// are valid, yet not members of the token_kind_type enum.
+    static symbol_kind_type yytranslate_ (int t) YY_NOEXCEPT;
+
+#if YYDEBUG || 0
+    /// For a symbol, its name in clear.
+    static const char* const yytname_[];
+#endif // #if YYDEBUG || 0
+
+
+    // Tables.
+    // YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+    // STATE-NUM.
+    static const short yypact_[];
+
+    // YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+    // Performed when YYTABLE does not specify something else to do.  Zero
+    // means the default is an error.
+    static const unsigned char yydefact_[];
+
+    // YYPGOTO[NTERM-NUM].
+    static const short yypgoto_[];
+
+    // YYDEFGOTO[NTERM-NUM].
+    static const short yydefgoto_[];
+
+    // YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+    // positive, shift that token.  If negative, reduce the rule whose
+    // number is the opposite.  If YYTABLE_NINF, syntax error.
+    static const short yytable_[];
+
+    static const short yycheck_[];
+
+    // YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+    // state STATE-NUM.
+    static const unsigned char yystos_[];
+
+    // YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.
+    static const unsigned char yyr1_[];
+
+    // YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.
+    static const signed char yyr2_[];
+
+
+#if YYDEBUG
+    // YYRLINE[YYN] -- Source line where rule number YYN was defined.
+    static const short yyrline_[];
+    /// Report on the debug stream that the rule \a r is going to be reduced.
+    virtual void yy_reduce_print_ (int r) const;
+    /// Print the state stack on the debug stream.
+    virtual void yy_stack_print_ () const;
+
+    /// Debugging level.
+    int yydebug_;
+    /// Debug stream.
+    std::ostream* yycdebug_;
+
+    /// \brief Display a symbol kind, value and location.
+    /// \param yyo    The output stream.
+    /// \param yysym  The symbol.
+    template <typename Base>
+    void yy_print_ (std::ostream& yyo, const basic_symbol<Base>& yysym) const;
+#endif
+
+    /// \brief Reclaim the memory associated to a symbol.
+    /// \param yymsg     Why this token is reclaimed.
+    ///                  If null, print nothing.
+    /// \param yysym     The symbol.
+    template <typename Base>
+    void yy_destroy_ (const char* yymsg, basic_symbol<Base>& yysym) const;
+
+  private:
+    /// Type access provider for state based symbols.
+    struct by_state
+    {
+      /// Default constructor.
+      by_state () YY_NOEXCEPT;
+
+      /// The symbol kind as needed by the constructor.
+      typedef state_type kind_type;
+
+      /// Constructor.
+      by_state (kind_type s) YY_NOEXCEPT;
+
+      /// Copy constructor.
+      by_state (const by_state& that) YY_NOEXCEPT;
+
+      /// Record that this symbol is empty.
+      void clear () YY_NOEXCEPT;
+
+      /// Steal the symbol kind from \a that.
+      void move (by_state& that);
+
+      /// The symbol kind (corresponding to \a state).
+      /// \a symbol_kind::S_YYEMPTY when empty.
+      symbol_kind_type kind () const YY_NOEXCEPT;
+
+      /// The state number used to denote an empty symbol.
+      /// We use the initial state, as it does not have a value.
+      enum { empty_state = 0 };
+
+      /// The state.
+      /// \a empty when empty.
+      state_type state;
+    };
+
+    /// "Internal" symbol: element of the stack.
+    struct stack_symbol_type : basic_symbol<by_state>
+    {
+      /// Superclass.
+      typedef basic_symbol<by_state> super_type;
+      /// Construct an empty symbol.
+      stack_symbol_type ();
+      /// Move or copy construction.
+      stack_symbol_type (YY_RVREF (stack_symbol_type) that);
+      /// Steal the contents from \a sym to build this.
+      stack_symbol_type (state_type s, YY_MOVE_REF (symbol_type) sym);
+#if YY_CPLUSPLUS < 201103L
+      /// Assignment, needed by push_back by some old implementations.
+      /// Moves the contents of that.
+      stack_symbol_type& operator= (stack_symbol_type& that);
+
+      /// Assignment, needed by push_back by other implementations.
+      /// Needed by some other old implementations.
+      stack_symbol_type& operator= (const stack_symbol_type& that);
+#endif
+    };
+
+    /// A stack with random access from its top.
+    template <typename T, typename S = std::vector<T> >
+    class stack
+    {
+    public:
+      // Hide our reversed order.
+      typedef typename S::iterator iterator;
+      typedef typename S::const_iterator const_iterator;
+      typedef typename S::size_type size_type;
+      typedef typename std::ptrdiff_t index_type;
+
+      stack (size_type n = 200) YY_NOEXCEPT
+        : seq_ (n)
+      {}
+
+#if 201103L <= YY_CPLUSPLUS
+      /// Non copyable.
+      stack (const stack&) = delete;
+      /// Non copyable.
+      stack& operator= (const stack&) = delete;
+#endif
+
+      /// Random access.
+      ///
+      /// Index 0 returns the topmost element.
+      const T&
+      operator[] (index_type i) const
+      {
+        return seq_[size_type (size () - 1 - i)];
+      }
+
+      /// Random access.
+      ///
+      /// Index 0 returns the topmost element.
+      T&
+      operator[] (index_type i)
+      {
+        return seq_[size_type (size () - 1 - i)];
+      }
+
+      /// Steal the contents of \a t.
+      ///
+      /// Close to move-semantics.
+      void
+      push (YY_MOVE_REF (T) t)
+      {
+        seq_.push_back (T ());
+        operator[] (0).move (t);
+      }
+
+      /// Pop elements from the stack.
+      void
+      pop (std::ptrdiff_t n = 1) YY_NOEXCEPT
+      {
+        for (; 0 < n; --n)
+          seq_.pop_back ();
+      }
+
+      /// Pop all elements from the stack.
+      void
+      clear () YY_NOEXCEPT
+      {
+        seq_.clear ();
+      }
+
+      /// Number of elements on the stack.
+      index_type
+      size () const YY_NOEXCEPT
+      {
+        return index_type (seq_.size ());
+      }
+
+      /// Iterator on top of the stack (going downwards).
+      const_iterator
+      begin () const YY_NOEXCEPT
+      {
+        return seq_.begin ();
+      }
+
+      /// Bottom of the stack.
+      const_iterator
+      end () const YY_NOEXCEPT
+      {
+        return seq_.end ();
+      }
+
+      /// Present a slice of the top of a stack.
+      class slice
+      {
+      public:
+        slice (const stack& stack, index_type range) YY_NOEXCEPT
+          : stack_ (stack)
+          , range_ (range)
+        {}
+
+        const T&
+        operator[] (index_type i) const
+        {
+          return stack_[range_ - i];
+        }
+
+      private:
+        const stack& stack_;
+        index_type range_;
+      };
+
+    private:
+#if YY_CPLUSPLUS < 201103L
+      /// Non copyable.
+      stack (const stack&);
+      /// Non copyable.
+      stack& operator= (const stack&);
+#endif
+      /// The wrapped container.
+      S seq_;
+    };
+
+
+    /// Stack type.
+    typedef stack<stack_symbol_type> stack_type;
+
+    /// The stack.
+    stack_type yystack_;
+
+    /// Push a new state on the stack.
+    /// \param m    a debug message to display
+    ///             if null, no trace is output.
+    /// \param sym  the symbol
+    /// \warning the contents of \a s.value is stolen.
+    void yypush_ (const char* m, YY_MOVE_REF (stack_symbol_type) sym);
+
+    /// Push a new look ahead token on the state on the stack.
+    /// \param m    a debug message to display
+    ///             if null, no trace is output.
+    /// \param s    the state
+    /// \param sym  the symbol (for its value and location).
+    /// \warning the contents of \a sym.value is stolen.
+    void yypush_ (const char* m, state_type s, YY_MOVE_REF (symbol_type) sym);
+
+    /// Pop \a n symbols from the stack.
+    void yypop_ (int n = 1) YY_NOEXCEPT;
+
+    /// Constants.
+    enum
+    {
+      yylast_ = 722,     ///< Last index in yytable_.
+      yynnts_ = 79,  ///< Number of nonterminal symbols.
+      yyfinal_ = 6 ///< Termination state number.
+    };
+
+
+    // User arguments.
+    class Builder& driver;
+
+  };
+
+
+} // yy
+#line 994 "objs/cfdg.tab.hpp"
+
+
+// "%code provides" blocks.
+#line 180 "src-common/cfdg.ypp"
+
+#include "scanner.h"
+#include "math.h"
+#include "builder.h"
+#include <cassert>
+
+#undef yylex
+#define yylex driver.lexer->lex
+
+#line 1008 "objs/cfdg.tab.hpp"
+
+
+#endif // !YY_YY_OBJS_CFDG_TAB_HPP_INCLUDED
@@ -0,0 +1,145 @@
+#!/bin/bash
+#
+# Benchmark harness: renders a fixed set of designs, variations and sizes with
+# tracing enabled and collects expansion and drawing throughput, peak RSS,
+# temp file bytes and PNG encode time into a JSON file. The results are
+# compared against a stored baseline and regressions beyond the threshold
+# are reported.
+#
+#   ./runbench.sh        run and compare against the baseline
+#   ./runbench.sh -u     run and store the results as the new baseline
+#
+# BENCH_RUNS sets the number of runs per case (the best run is kept) and
+# BENCH_THRESHOLD the allowed regression in percent.
+
+DESIGNS="demo1 octopi snowflake alphabet ziggy"
+VARIATIONS="ABC XYZ"
+SIZES="500 2000"
+
+RUNS=${BENCH_RUNS:-3}
+THRESHOLD=${BENCH_THRESHOLD:-10}
+BASELINE=${BENCH_BASELINE:-bench-baseline.json}
+OUTPUT_DIR=output
+RESULTS=$OUTPUT_DIR/bench-results.json
+TRACE=$OUTPUT_DIR/bench-trace.json
+
+update=false
+if [ "$1" = "-u" ] ; then update=true ; fi
+
+mkdir -p $OUTPUT_DIR
+
+# Reduce a trace file to: shapes expand_us draw_us encode_us rss_kib temp_bytes
+summarize() {
+    awk '
+    function field(line, key,   s) {
+        s = line
+        if (!sub(".*\"" key "\":", "", s)) return 0
+        sub("[,}].*", "", s)
+        return s + 0
+    }
+    /"name":"expand"/       { expand += field($0, "dur") }
+    /"name":"final output"/ { draw += field($0, "dur") }
+    /"name":"encode"/       { encode += field($0, "dur") }
+    /"name":"shapes"/       { shapes = field($0, "finished") }
+    /"name":"peak RSS"/     { rss = field($0, "KiB") }
+    /"name":"temp bytes"/   { temp = field($0, "written") }
+    END { printf "%d %.0f %.0f %.0f %d %d\n", shapes, expand, draw, encode, rss, temp }
+    ' "$1"
+}
+
+echo "[" > $RESULTS
+first=true
+for design in $DESIGNS ; do
+    for var in $VARIATIONS ; do
+        for size in $SIZES ; do
+            name="$design-$var-$size"
+            echo -n "$name "
+            best=""
+            for ((run = 0; run < RUNS; ++run)) ; do
+                if ! ./cfdg -q -v $var -s $size -j $TRACE input/$design.cfdg $OUTPUT_DIR/bench.png ; then
+                    echo '          FAIL'
+                    exit 1
+                fi
+                best="$best$(summarize $TRACE)
+"
+            done
+            line=$(echo -n "$best" | awk -v name="$name" '
+            function rate(n, us) { return us > 0 ? n * 1000000.0 / us : 0 }
+            {
+                e = rate($1, $2); d = rate($1, $3)
+                if (NR == 1 || e > xps) xps = e
+                if (NR == 1 || d > dps) dps = d
+                if (NR == 1 || $4 < enc) enc = $4
+                if (NR == 1 || $5 < rss) rss = $5
+                if (NR == 1 || $6 < tmp) tmp = $6
+                shapes = $1
+            }
+            END {
+                printf "{\"case\":\"%s\",\"shapes\":%d,\"expand_shapes_per_sec\":%.0f,", name, shapes, xps
+                printf "\"draw_shapes_per_sec\":%.0f,\"peak_rss_kib\":%d,\"temp_bytes\":%d,", dps, rss, tmp
+                printf "\"encode_ms\":%.3f}", enc / 1000.0
+            }')
+            $first || echo "," >> $RESULTS
+            echo -n "$line" >> $RESULTS
+            first=false
+            echo '   done'
+        done
+    done
+done
+echo "" >> $RESULTS
+echo "]" >> $RESULTS
+
+if $update ; then
+    cp $RESULTS $BASELINE
+    echo "Baseline stored in $BASELINE"
+    exit 0
+fi
+
+if [ ! -f $BASELINE ] ; then
+    echo "No baseline found, run '$0 -u' to create $BASELINE"
+    exit 0
+fi
+
+# Compare each case against the baseline. Throughput must not drop and
+# memory, temp bytes and encode time must not grow by more than THRESHOLD%
+# (plus a little slack for timer and allocator noise on tiny values).
+awk -v threshold=$THRESHOLD '
+function field(line, key,   s) {
+    s = line
+    if (!sub(".*\"" key "\":", "", s)) return ""
+    sub("[,}].*", "", s)
+    gsub("\"", "", s)
+    return s
+}
+function check(metric, higherIsBetter, slack,   b, n, limit) {
+    b = base[name, metric] + 0; n = field($0, metric) + 0
+    if (b == 0) return
+    if (higherIsBetter) {
+        limit = b * (1 - threshold / 100.0)
+        if (n < limit) { printf "REGRESSION %s %s: %g -> %g\n", name, metric, b, n; ++bad }
+    } else {
+        limit = b * (1 + threshold / 100.0) + slack
+        if (n > limit) { printf "REGRESSION %s %s: %g -> %g\n", name, metric, b, n; ++bad }
+    }
+}
+FNR == NR {
+    if ($0 ~ /"case"/) {
+        name = field($0, "case")
+        split("expand_shapes_per_sec draw_shapes_per_sec peak_rss_kib temp_bytes encode_ms", keys, " ")
+        for (k in keys) base[name, keys[k]] = field($0, keys[k])
+    }
+    next
+}
+/"case"/ {
+    name = field($0, "case")
+    check("expand_shapes_per_sec", 1, 0)
+    check("draw_shapes_per_sec", 1, 0)
+    check("peak_rss_kib", 0, 1024)
+    check("temp_bytes", 0, 0)
+    check("encode_ms", 0, 1)
+}
+END {
+    if (bad) { printf "%d regressions against baseline\n", bad; exit 1 }
+    print "No regressions against baseline"
+}
+' $BASELINE $RESULTS
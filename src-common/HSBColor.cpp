@@ -86,6 +86,53 @@ void HSBColor::getRGBA(agg::rgba& c) const
     }
 }
 
+void HSBColor::GetRGBA(const HSBColor* hsb, agg::rgba* c, std::size_t count)
+{
+    // Colors are converted in blocks that are transposed into separate
+    // component arrays, so that the compiler can vectorize the conversion.
+    // Hues in [0,360) are converted without branches, with results that are
+    // identical to getRGBA(). The rare hues outside of that range are then
+    // done the slow way.
+    const std::size_t Block = 64;
+    double hex[Block], rem[Block], bri[Block], sat[Block];
+    double r[Block], g[Block], bl[Block];
+    
+    for (std::size_t start = 0; start < count; start += Block) {
+        std::size_t n = count - start < Block ? count - start : Block;
+        const HSBColor* in = hsb + start;
+        agg::rgba* out = c + start;
+        
+        for (std::size_t i = 0; i < n; ++i) {
+            double hue = in[i].h / 60.0;
+            hex[i] = floor(hue);
+            rem[i] = hue - hex[i];
+            bri[i] = in[i].b;
+            sat[i] = in[i].s;
+        }
+        
+        for (std::size_t i = 0; i < n; ++i) {
+            double b = bri[i], s = sat[i], x = hex[i];
+            double p = b * (1 - s);
+            double q = b * (1 - (s * rem[i]));
+            double t = b * (1 - (s * (1 - rem[i])));
+            r[i]  = (x == 0.0 || x == 5.0) ? b : x == 1.0 ? q : x == 4.0 ? t : p;
+            g[i]  = (x == 1.0 || x == 2.0) ? b : x == 0.0 ? t : x == 3.0 ? q : p;
+            bl[i] = (x == 3.0 || x == 4.0) ? b : x == 2.0 ? t : x == 5.0 ? q : p;
+        }
+        
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i].r = r[i];
+            out[i].g = g[i];
+            out[i].b = bl[i];
+            out[i].a = in[i].a;
+        }
+        
+        for (std::size_t i = 0; i < n; ++i)
+            if (!(hex[i] >= 0.0 && hex[i] <= 5.0))
+                in[i].getRGBA(out[i]);
+    }
+}
+
 static inline double myfmin(double x, double y) { return x < y ? x : y; }
 static inline double myfmax(double x, double y) { return x > y ? x : y; }
 
@@ -36,6 +36,7 @@ namespace agg {
 #define EQUALITY_THRESHOLD  0.00001
 
 #include <math.h>
+#include <cstddef>
 
 struct HSBColor
 {
@@ -68,6 +69,9 @@ struct HSBColor
                        const HSBColor& adj, const HSBColor& adjTarg, int assign);
 
     void getRGBA(agg::rgba& c) const;
+    static void GetRGBA(const HSBColor* hsb, agg::rgba* c, std::size_t count);
+        // Same as getRGBA() on each of count colors. The hextant is picked
+        // with selects instead of a switch so the loop can be vectorized.
     
     bool operator!=(const HSBColor& hsb) const {
         return h != hsb.h || s != hsb.s || b != hsb.b || a != hsb.s;
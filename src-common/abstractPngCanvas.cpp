@@ -25,20 +25,55 @@
 #include "abstractPngCanvas.h"
 #include "tiledCanvas.h"
 #include "makeCFfilename.h"
+#include "traceLog.h"
 #include <string>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
 const char* prettyInt(unsigned long);
 
+namespace {
+    // Un-premultiplied 8-bit color, indexed by alpha * 256 + color. Same
+    // result as agg::rgba8::demultiply(), without the divisions.
+    const unsigned char*
+    demultiplyTable()
+    {
+        static const vector<unsigned char> table = []() {
+            vector<unsigned char> t(256 * 256, 0);
+            for (unsigned a = 1; a < 256; ++a)
+                for (unsigned c = 0; c < 256; ++c)
+                    t[a * 256 + c] = static_cast<unsigned char>(min(255u, c * 255 / a));
+            return t;
+        }();
+        return table.data();
+    }
+
+    inline void
+    storeBigEndian(unsigned char* dst, uint16_t v)
+    {
+        dst[0] = static_cast<unsigned char>(v >> 8);
+        dst[1] = static_cast<unsigned char>(v);
+    }
+}
+
 abstractPngCanvas::abstractPngCanvas(const char* outfilename, bool quiet, int width, int height, 
                                      aggCanvas::PixelFormat pixfmt, bool crop, int frameCount,
-                                     int variation, bool wallpaper, Renderer *r, int mx, int my)
+                                     int variation, bool wallpaper, Renderer *r, int mx, int my,
+                                     size_t bandBytes)
 : aggCanvas(pixfmt), mOutputFileName(outfilename), mFrameCount(frameCount), 
   mCurrentFrame(0), mVariation(variation), mPixelFormat(pixfmt),
   mCrop(crop), mQuiet(quiet), mWallpaper(wallpaper), mRenderer(r), mFullWidth(width), 
-  mFullHeight(height), mOriginX(0), mOriginY(0)
+  mFullHeight(height), mOriginX(0), mOriginY(0), mBandRows(0), mBandCount(1),
+  mNextBand(0), mOutputOpen(false), mAtomicOutput(false)
 {
     if (wallpaper) {
         mWidth = r->m_width;
@@ -66,12 +101,31 @@ abstractPngCanvas::abstractPngCanvas(const char* outfilename, bool quiet, int wi
 #ifdef _WIN32
     mStride += ((-mStride) & 3);
 #endif
-    mData.reset(new unsigned char[mStride * mFullHeight]);
-	attach(mData.get() + mOriginY * mStride + mOriginX * bpp, mWidth, mHeight, mStride);
+    
+    // Banding only works for a single tile
+    if (bandBytes && !wallpaper && mx == 1 && my == 1) {
+        size_t rows = max<size_t>(bandBytes / mStride, 1);
+        if (rows < static_cast<size_t>(mFullHeight)) {
+            mBandRows = static_cast<int>(rows);
+            mBandCount = (mFullHeight + mBandRows - 1) / mBandRows;
+        }
+    }
+    
+    if (mBandRows) {
+        mData.reset(new unsigned char[static_cast<size_t>(mStride) * mBandRows]);
+        attach(mData.get(), mWidth, mBandRows, mStride);
+        mHeight = height;
+    } else {
+        mData.reset(new unsigned char[static_cast<size_t>(mStride) * mFullHeight]);
+        attach(mData.get() + mOriginY * mStride + mOriginX * bpp, mWidth, mHeight, mStride);
+    }
 
     if (quiet) return;
     cout << prettyInt(static_cast<unsigned long>(mFullWidth)) << "w x " <<
-            prettyInt(static_cast<unsigned long>(mFullHeight)) << "h pixel image." << endl;
+            prettyInt(static_cast<unsigned long>(mFullHeight)) << "h pixel image";
+    if (mBandRows)
+        cout << " in " << prettyInt(static_cast<unsigned long>(mBandCount)) << " bands";
+    cout << "." << endl;
     cout << "Generating..." << endl;
 }
 
@@ -84,6 +138,7 @@ abstractPngCanvas::start(bool clear, const agg::rgba &bk, int width, int height)
         cout << endl << "Rendering..." << endl;
     
     aggCanvas::start(clear, bk, width, height);
+    mNextBand = 0;
 }
 
 void
@@ -91,6 +146,19 @@ abstractPngCanvas::end()
 {
     aggCanvas::end();
     
+    if (mBandRows) {
+        // The bands that weren't drawn, if the render was stopped, go out
+        // empty so that the image is complete
+        while (mNextBand < mBandCount) {
+            startBand(mNextBand);
+            endBand(mNextBand);
+        }
+        if (mOutputOpen)
+            closeOutput();
+        mOutputOpen = false;
+        return;
+    }
+    
     if (mRenderer && mRenderer->m_tiledCanvas) {
         tileList points = mRenderer->m_tiledCanvas->getTesselation(mFullWidth, mFullHeight,
                                                                    mOriginX, mOriginY, true);
@@ -104,13 +172,123 @@ abstractPngCanvas::end()
         
     }
     
+    TraceLog::Scope trace("encode", "output");
+    if (openOutput()) {
+        int srcx = mCrop ? cropX() : 0;
+        int srcy = mCrop ? cropY() : 0;
+        outputRows(mData.get() + static_cast<size_t>(srcy) * mStride +
+                   srcx * BytesPerPixel.at(mPixelFormat),
+                   mCrop ? cropHeight() : mFullHeight);
+        closeOutput();
+    }
+}
+
+bool
+abstractPngCanvas::openOutput()
+{
     string name = makeCFfilename(mOutputFileName, mCurrentFrame, mFrameCount,
                                  mVariation);
+    int frame = mFrameCount ? mCurrentFrame++ : -1;
+    int width = mCrop ? cropWidth() : mFullWidth;
+    int height = mCrop ? cropHeight() : mFullHeight;
     
-    if (mFrameCount) {
-        output(name.c_str(), mCurrentFrame++);
-    } else {
-        output(name.c_str());
+    if (frame == -1 && !mQuiet) {
+        cerr << endl << "Writing "
+             << prettyInt(static_cast<unsigned long>(width)) << "w x "
+             << prettyInt(static_cast<unsigned long>(height)) << "h pixel image..." << endl;
+    }
+    
+    mReplaceName.clear();
+    if (mAtomicOutput && !name.empty()) {
+        mReplaceName = name;
+        name.append(".tmp");
+    }
+    
+    return beginOutput(name.c_str(), frame, width, height);
+}
+
+void
+abstractPngCanvas::closeOutput()
+{
+    bool written = endOutput();
+    if (mReplaceName.empty())
+        return;
+    
+    string temp = mReplaceName + ".tmp";
+    if (written) {
+#ifdef _WIN32
+        // rename() does not replace files here
+        remove(mReplaceName.c_str());
+#endif
+        written = rename(temp.c_str(), mReplaceName.c_str()) == 0;
+        if (!written)
+            cerr << "\nCouldn't replace " << mReplaceName << endl;
+    }
+    if (!written)
+        remove(temp.c_str());
+}
+
+int
+abstractPngCanvas::bands()
+{
+    return mBandCount;
+}
+
+// Bands count down from the top of the image while canvas y counts up from
+// the bottom. A couple of rows either way allow for anti-aliasing and for the
+// size adjustment of tiny primitives.
+void
+abstractPngCanvas::bandRange(double y1, double y2, int& first, int& last)
+{
+    first = 0;
+    last = mBandCount - 1;
+    if (!mBandRows || !(y1 <= y2))
+        return;
+    
+    double top = mFullHeight - 1 - std::floor(y2 + cropY() + 2.0);
+    double bottom = mFullHeight - 1 - std::floor(y1 + cropY() - 2.0);
+    if (bottom < 0.0 || top >= mFullHeight) {
+        first = 1;
+        last = 0;
+        return;
+    }
+    if (top > 0.0)
+        first = static_cast<int>(top) / mBandRows;
+    if (bottom < mFullHeight - 1)
+        last = static_cast<int>(bottom) / mBandRows;
+}
+
+void
+abstractPngCanvas::startBand(int band)
+{
+    int top = band * mBandRows;
+    int rows = min(mBandRows, mFullHeight - top);
+    attachBand(mData.get(), rows, mStride, mFullHeight - top - rows);
+}
+
+// Each band goes to the output once it's drawn, the first one beginning it
+void
+abstractPngCanvas::endBand(int band)
+{
+    if (band != mNextBand)
+        return;
+    ++mNextBand;
+    
+    TraceLog::Scope trace("encode", "output");
+    if (band == 0)
+        mOutputOpen = openOutput();
+    if (!mOutputOpen)
+        return;
+    
+    int height = mCrop ? cropHeight() : mFullHeight;
+    int srcy = mCrop ? cropY() : 0;
+    int top = band * mBandRows;
+    int from = max(top, srcy);
+    int to = min(min(top + mBandRows, mFullHeight), srcy + height);
+    if (from < to) {
+        int srcx = mCrop ? cropX() : 0;
+        outputRows(mData.get() + (from - top) * mStride + srcx * BytesPerPixel.at(mPixelFormat),
+                   to - from);
     }
 }
 
@@ -129,3 +307,91 @@ abstractPngCanvas::copyImageUnscaled(int destx, int desty)
         }
     }
 }
+
+// Opaque and fully transparent pixels are handled four (or two) at a time
+// with SSE2, the rest through a table or agg's demultiply.
+void
+abstractPngCanvas::ConvertRow(PixelFormat fmt, const unsigned char* src,
+                              unsigned char* dst, int width)
+{
+    int bytes = width * BytesPerPixel.at(fmt);
+    int c = 0;
+    switch (fmt) {
+        case RGBA8_Blend: {
+            const unsigned char* table = demultiplyTable();
+            auto convert = [=](int c) {
+                const unsigned char* alpha = table + src[c + 3] * 256;
+                dst[c + 0] = alpha[src[c + 0]];
+                dst[c + 1] = alpha[src[c + 1]];
+                dst[c + 2] = alpha[src[c + 2]];
+                dst[c + 3] = src[c + 3];
+            };
+#ifdef __SSE2__
+            const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+            for (; c + 16 <= bytes; c += 16) {
+                __m128i pix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + c));
+                __m128i alpha = _mm_and_si128(pix, opaque);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) == 0xffff) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + c), pix);
+                } else if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, _mm_setzero_si128())) == 0xffff) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + c), _mm_setzero_si128());
+                } else {
+                    for (int p = c; p < c + 16; p += 4)
+                        convert(p);
+                }
+            }
+#endif
+            for (; c < bytes; c += 4)
+                convert(c);
+            break;
+        }
+        case RGBA16_Blend: {
+            const uint16_t* src16 = reinterpret_cast<const uint16_t*>(src);
+            auto convert = [=](int c) {
+                int i = c >> 1;
+                agg::rgba16 pix(src16[i + 0], src16[i + 1], src16[i + 2], src16[i + 3]);
+                pix.demultiply();
+                storeBigEndian(dst + c + 0, pix.r);
+                storeBigEndian(dst + c + 2, pix.g);
+                storeBigEndian(dst + c + 4, pix.b);
+                storeBigEndian(dst + c + 6, pix.a);
+            };
+#ifdef __SSE2__
+            const __m128i opaque = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+            for (; c + 16 <= bytes; c += 16) {
+                __m128i pix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + c));
+                __m128i alpha = _mm_and_si128(pix, opaque);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(alpha, opaque)) == 0xffff) {
+                    pix = _mm_or_si128(_mm_slli_epi16(pix, 8), _mm_srli_epi16(pix, 8));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + c), pix);
+                } else if (_mm_movemask_epi8(_mm_cmpeq_epi16(alpha, _mm_setzero_si128())) == 0xffff) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + c), _mm_setzero_si128());
+                } else {
+                    convert(c);
+                    convert(c + 8);
+                }
+            }
+#endif
+            for (; c < bytes; c += 8)
+                convert(c);
+            break;
+        }
+        case RGB16_Blend:
+        case Gray16_Blend: {
+#ifdef __SSE2__
+            for (; c + 16 <= bytes; c += 16) {
+                __m128i pix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + c));
+                pix = _mm_or_si128(_mm_slli_epi16(pix, 8), _mm_srli_epi16(pix, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + c), pix);
+            }
+#endif
+            const uint16_t* src16 = reinterpret_cast<const uint16_t*>(src);
+            for (; c < bytes; c += 2)
+                storeBigEndian(dst + c, src16[c >> 1]);
+            break;
+        }
+        default:
+            memcpy(dst, src, bytes);
+            break;
+    }
+}
@@ -26,16 +26,37 @@
 #define INCLUDE_ABSTRACTPNGCANVAS_H
 
 #include "aggCanvas.h"
+#include <cstddef>
+#include <string>
 
 class abstractPngCanvas : public aggCanvas {
 public:
     abstractPngCanvas(const char* outfilename, bool quiet, int width, int height, 
                       PixelFormat pixfmt, bool crop, int frameCount,
-                      int variation, bool wallpaper, Renderer *r, int mx, int my);
+                      int variation, bool wallpaper, Renderer *r, int mx, int my,
+                      std::size_t bandBytes = 0);
+        // If bandBytes is given then the image is drawn and output in bands
+        // of at most that many bytes, instead of all at once
     ~abstractPngCanvas() override;
     void start(bool , const agg::rgba& , int , int ) override;
     void end() override;
     
+    void setAtomicOutput(bool atomic) { mAtomicOutput = atomic; }
+        // The image is written to a temp file next to it, which then
+        // replaces it, so that a reader never sees a partly written image
+    
+    int bands() override;
+    void bandRange(double y1, double y2, int& first, int& last) override;
+    void startBand(int band) override;
+    void endBand(int band) override;
+    
+    static void ConvertRow(PixelFormat fmt, const unsigned char* src,
+                           unsigned char* dst, int width);
+        // Converts a row of canvas pixels to PNG samples: non-premultiplied
+        // alpha as per PNG spec and 16-bit samples in network byte order. This
+        // is done in a separate array instead of in-situ because for
+        // animations the main buffer might be drawn into again.
+    
 protected:
     const char* mOutputFileName;
     int mFrameCount;
@@ -55,8 +76,28 @@ protected:
     int mOriginX;
     int mOriginY;
     
+    int mBandRows;      // rows in a band, or 0 if not banded
+    int mBandCount;
+    int mNextBand;      // the next band to output
+    
     void copyImageUnscaled(int x, int y);
-    virtual void output(const char * outfilename, int frame = -1) = 0;
+    
+    // The output of an image goes through these: beginOutput() with its
+    // size, then outputRows() with the rows in order, top first, each
+    // mStride bytes apart, then endOutput(). A canvas that fails to begin
+    // returns false and doesn't get the rest. endOutput() returns false if
+    // the image could not be written.
+    virtual bool beginOutput(const char* outfilename, int frame, int width, int height) = 0;
+    virtual void outputRows(const unsigned char* rows, int count) = 0;
+    virtual bool endOutput() = 0;
+    
+private:
+    bool mOutputOpen;
+    bool mAtomicOutput;
+    std::string mReplaceName;   // the image the temp file replaces
+    
+    bool openOutput();
+    void closeOutput();
 };
 
 
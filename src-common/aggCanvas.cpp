@@ -44,27 +44,31 @@
 #include "ast.h"
 #include "CmdInfo.h"
 #include "pathIterator.h"
+#include "spanBlend.h"
 #include <set>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
 #include <cassert>
 
 #ifdef _WIN32
-typedef agg::pixfmt_bgra64_pre  color64_pixel_fmt;
-typedef agg::pixfmt_bgr48_pre   color48_pixel_fmt;
-typedef agg::pixfmt_bgra32_pre  color32_pixel_fmt;
-typedef agg::pixfmt_bgr24_pre   color24_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_bgra64_pre> color64_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_bgr48_pre>  color48_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_bgra32_pre> color32_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_bgr24_pre>  color24_pixel_fmt;
 #else
-typedef agg::pixfmt_rgba64_pre  color64_pixel_fmt;
-typedef agg::pixfmt_rgb48_pre   color48_pixel_fmt;
-typedef agg::pixfmt_rgba32_pre  color32_pixel_fmt;
-typedef agg::pixfmt_rgb24_pre   color24_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_rgba64_pre> color64_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_rgb48_pre>  color48_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_rgba32_pre> color32_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_rgb24_pre>  color24_pixel_fmt;
 #endif
 
-typedef agg::pixfmt_argb32_pre  ff_pixel_fmt;
-typedef agg::pixfmt_rgb24_pre   ff24_pixel_fmt;
-typedef agg::pixfmt_rgba32_pre  qt_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_argb32_pre> ff_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_rgb24_pre>  ff24_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_rgba32_pre> qt_pixel_fmt;
 
-typedef agg::pixfmt_gray8_pre  gray_pixel_fmt;
-typedef agg::pixfmt_gray16_pre gray16_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_gray8_pre>  gray_pixel_fmt;
+typedef spanBlendPixfmt<agg::pixfmt_gray16_pre> gray16_pixel_fmt;
 
 #ifndef M_PI
 #define M_PI        3.14159265358979323846
@@ -77,6 +81,23 @@ typedef agg::pixfmt_gray16_pre gray16_pixel_fmt;
 #define ADJ_SQUARE_SIZE     0.80
 #define ADJ_TRIANGLE_SIZE   0.90
 
+// Primitives at most SPRITE_MAX_SIZE pixels across, under a similarity
+// transform, are drawn from cached coverage sprites. Sprites are indexed by
+// size in 1/SPRITE_SIZE_STEPS pixel steps, rotation in SPRITE_ROTATION_STEPS
+// steps over the shape's symmetry period, and position in 1/SPRITE_SUBPIXELS
+// pixel steps. The cache is direct mapped with SPRITE_SLOTS slots, each
+// holding a coverage box up to SPRITE_BOX pixels square.
+#define SPRITE_MAX_SIZE         4.0
+#define SPRITE_SIZE_STEPS       32
+#define SPRITE_ROTATION_STEPS   64
+#define SPRITE_SUBPIXELS        16
+#define SPRITE_BOX              8
+#define SPRITE_SLOTS            16384
+
+// While drawing under, the canvas is divided into tiles of OCCLUSION_TILE
+// pixels square that are marked once they are completely opaque.
+#define OCCLUSION_TILE          16
+
 const std::map<aggCanvas::PixelFormat, int> aggCanvas::BytesPerPixel = {
 	{UnknownPixelFormat, 4},
 	{ Gray8_Blend, 1 },
@@ -169,12 +190,36 @@ class aggCanvas::impl {
         
         std::set<agg::int64u> pixelSet;
         
+        agg::rgba           background;
+        std::vector<bool>   opaqueTiles;
+        aggCanvas::PixelFormat pixelFormat;
+        
+        // Premultiplied red, green, blue and alpha of the splats over each
+        // pixel, allocated by the first splat
+        std::vector<float>  splats;
+        
+        enum SpriteShape { CircleSprite, SquareSprite, TriangleSprite };
+        
+        // Anti-aliased coverage of a tiny primitive as the rasterizer produced
+        // it. The box's top left corner is at (x, y) relative to the pixel
+        // holding the primitive's center and each row is covered from
+        // start[row] for len[row] pixels.
+        struct Sprite {
+            std::uint32_t   key = 0;
+            int             x, y, rows;
+            agg::int8u      start[SPRITE_BOX];
+            agg::int8u      len[SPRITE_BOX];
+            agg::int8u      covers[SPRITE_BOX][SPRITE_BOX];
+        };
+        std::vector<Sprite>             sprites;
+        agg::rasterizer_scanline_aa<>   spriteRasterizer;
+        
         impl(aggCanvas* canvas)
             : buffer(), mCanvas(canvas), unitSquare(primShape::square),
               shapeSquare(unitSquare, unitTrans), 
               shapeEllipse(unitEllipse, unitTrans), unitTriangle(primShape::triangle),
               shapeTriangle(unitTriangle, unitTrans), 
-              cropWidth(0), cropHeight(0)
+              cropWidth(0), cropHeight(0), pixelFormat(UnknownPixelFormat)
         {
 //            rasterizer.gamma(agg::gamma_power(1.0));
         }
@@ -184,6 +229,16 @@ class aggCanvas::impl {
         virtual void clear(const agg::rgba& bk) = 0;
         virtual void fill(RGBA8 bk) = 0;
         virtual void draw(RGBA8 c, agg::filling_rule_e fr = agg::fill_non_zero) = 0;
+        virtual void blend(RGBA8 c, int x, int y, const Sprite& sprite) = 0;
+        virtual void under(bool on) = 0;
+        virtual bool occluded(int x1, int y1, int x2, int y2) = 0;
+        virtual void flushSplats() = 0;
+        virtual void reframe(const agg::trans_affine& tr) = 0;
+        
+        void countColor(RGBA8 col);
+        bool drawSprite(RGBA8 c, const agg::trans_affine& tr, SpriteShape shape);
+        bool makeSprite(Sprite& sprite, SpriteShape shape, unsigned size,
+                        unsigned rotation, int subX, int subY);
         
         virtual bool colorCount256() = 0;
         
@@ -201,6 +256,8 @@ template <class pixel_fmt> class aggPixelPainter : public aggCanvas::impl {
         renderer_base           rendBase;
         renderer_solid          rendSolid;
         
+        std::vector<typename pixel_fmt::value_type> coverage;
+        
         aggPixelPainter(aggCanvas* canvas)
         : aggCanvas::impl(canvas), pixFmt(buffer), 
           rendBase(pixFmt), rendSolid(rendBase)
@@ -215,6 +272,11 @@ template <class pixel_fmt> class aggPixelPainter : public aggCanvas::impl {
         void clear(const agg::rgba& bk);
         void fill(RGBA8 bk);
         void draw(RGBA8 c, agg::filling_rule_e fr = agg::fill_non_zero);
+        void blend(RGBA8 c, int x, int y, const Sprite& sprite);
+        void under(bool on);
+        bool occluded(int x1, int y1, int x2, int y2);
+        void flushSplats();
+        void reframe(const agg::trans_affine& tr);
 
         bool colorCount256();
         
@@ -255,6 +317,160 @@ aggPixelPainter<pixel_fmt>::draw(RGBA8 col, agg::filling_rule_e fr)
 {
     typedef typename pixel_fmt::color_type color_type;
     typedef agg::ColorConverter<RGBA8, color_type> Converter_type;
+    countColor(col);
+    
+    color_type c = Converter_type::f(col);
+    rendSolid.color(c.premultiply());
+    rasterizer.filling_rule(fr);
+    agg::render_scanlines(rasterizer, scanline, rendSolid);
+    rasterizer.reset();
+}
+
+template <class pixel_fmt>
+void
+aggPixelPainter<pixel_fmt>::blend(RGBA8 col, int x, int y, const Sprite& sprite)
+{
+    typedef typename pixel_fmt::color_type color_type;
+    typedef agg::ColorConverter<RGBA8, color_type> Converter_type;
+    color_type c = Converter_type::f(col);
+    c.premultiply();
+    x += sprite.x;
+    y += sprite.y;
+    for (int row = 0; row < sprite.rows; ++row)
+        if (sprite.len[row])
+            rendBase.blend_solid_hspan(x + sprite.start[row], y + row, sprite.len[row], c,
+                                       sprite.covers[row] + sprite.start[row]);
+}
+
+template <class pixel_fmt>
+void
+aggPixelPainter<pixel_fmt>::under(bool on)
+{
+    typedef typename pixel_fmt::color_type color_type;
+    unsigned width = pixFmt.width();
+    unsigned height = pixFmt.height();
+    if (on) {
+        rendBase.clear(color_type::no_color());
+        coverage.assign(width * height, 0);
+        opaqueTiles.assign(((width + OCCLUSION_TILE - 1) / OCCLUSION_TILE) *
+                           ((height + OCCLUSION_TILE - 1) / OCCLUSION_TILE), false);
+        pixFmt.under(coverage.data());
+    } else {
+        agg::rgba bk_pre = background;
+        bk_pre.premultiply();
+        rendBase.fill(color_type(bk_pre));
+        pixFmt.under(nullptr);
+        coverage.clear();
+        coverage.shrink_to_fit();
+        opaqueTiles.clear();
+    }
+}
+
+// Whether the pixels from (x1, y1) up to (x2, y2) are all opaque. The tiles
+// that get checked completely are remembered, coverage only ever grows.
+template <class pixel_fmt>
+bool
+aggPixelPainter<pixel_fmt>::occluded(int x1, int y1, int x2, int y2)
+{
+    typedef typename pixel_fmt::value_type value_type;
+    const value_type opaque = pixel_fmt::color_type::base_mask;
+    int width = static_cast<int>(pixFmt.width());
+    int height = static_cast<int>(pixFmt.height());
+    int across = (width + OCCLUSION_TILE - 1) / OCCLUSION_TILE;
+    
+    for (int ty = y1 / OCCLUSION_TILE; ty <= (y2 - 1) / OCCLUSION_TILE; ++ty) {
+        int top = std::max(y1, ty * OCCLUSION_TILE);
+        int bottom = std::min(y2, (ty + 1) * OCCLUSION_TILE);
+        for (int tx = x1 / OCCLUSION_TILE; tx <= (x2 - 1) / OCCLUSION_TILE; ++tx) {
+            if (opaqueTiles[ty * across + tx])
+                continue;
+            int left = std::max(x1, tx * OCCLUSION_TILE);
+            int right = std::min(x2, (tx + 1) * OCCLUSION_TILE);
+            for (int y = top; y < bottom; ++y) {
+                const value_type* c = coverage.data() + y * width;
+                for (int x = left; x < right; ++x)
+                    if (c[x] != opaque)
+                        return false;
+            }
+            if (left == tx * OCCLUSION_TILE && right == std::min(width, left + OCCLUSION_TILE) &&
+                top == ty * OCCLUSION_TILE && bottom == std::min(height, top + OCCLUSION_TILE))
+                opaqueTiles[ty * across + tx] = true;
+        }
+    }
+    return true;
+}
+
+template <class pixel_fmt>
+void
+aggPixelPainter<pixel_fmt>::flushSplats()
+{
+    typedef typename pixel_fmt::color_type color_type;
+    int width = static_cast<int>(pixFmt.width());
+    int height = static_cast<int>(pixFmt.height());
+    const float* acc = splats.data();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x, acc += 4) {
+            if (acc[3] <= 0.0f)
+                continue;
+            // Back to straight color, agg's conversion rounds it the same
+            // way as shape colors
+            agg::rgba c(acc[0] / acc[3], acc[1] / acc[3], acc[2] / acc[3],
+                        std::min(acc[3], 1.0f));
+            color_type cc(c);
+            rendBase.blend_pixel(x, y, cc.premultiply(), agg::cover_full);
+        }
+    }
+    splats.clear();
+    splats.shrink_to_fit();
+}
+
+// Moves the image by a transform that shrinks it, each pixel getting the
+// average of the old pixels under it. Pixels with nothing under them get
+// the background.
+template <class pixel_fmt>
+void
+aggPixelPainter<pixel_fmt>::reframe(const agg::trans_affine& tr)
+{
+    typedef typename pixel_fmt::color_type color_type;
+    int width = static_cast<int>(pixFmt.width());
+    int height = static_cast<int>(pixFmt.height());
+    std::vector<color_type> old;
+    old.reserve(static_cast<std::size_t>(width) * height);
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            old.push_back(pixFmt.pixel(x, y));
+    clear(background);
+    
+    agg::trans_affine inv = tr;
+    inv.invert();
+    double half = 0.5 / tr.scale();     // old pixels across a new one, halved
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double ox = x + 0.5, oy = y + 0.5;
+            inv.transform(&ox, &oy);
+            int x1 = std::max(static_cast<int>(floor(ox - half + 0.5)), 0);
+            int x2 = std::min(static_cast<int>(floor(ox + half + 0.5)), width);
+            int y1 = std::max(static_cast<int>(floor(oy - half + 0.5)), 0);
+            int y2 = std::min(static_cast<int>(floor(oy + half + 0.5)), height);
+            if (x1 >= x2 || y1 >= y2)
+                continue;
+            agg::rgba sum(0.0, 0.0, 0.0, 0.0);
+            for (int sy = y1; sy < y2; ++sy) {
+                for (int sx = x1; sx < x2; ++sx) {
+                    agg::rgba32 c = old[static_cast<std::size_t>(sy) * width + sx];
+                    sum.r += c.r; sum.g += c.g; sum.b += c.b; sum.a += c.a;
+                }
+            }
+            double n = static_cast<double>((x2 - x1) * (y2 - y1));
+            pixFmt.copy_pixel(x, y, color_type(agg::rgba(sum.r / n, sum.g / n,
+                                                         sum.b / n, sum.a / n)));
+        }
+    }
+}
+
+void
+aggCanvas::impl::countColor(RGBA8 col)
+{
     if (pixelSet.size() < PNG8Limit) {
         agg::int64u pixel = 
             static_cast<agg::int64u>(col.r) << 48 |
@@ -263,12 +479,125 @@ aggPixelPainter<pixel_fmt>::draw(RGBA8 col, agg::filling_rule_e fr)
             static_cast<agg::int64u>(col.a);
         pixelSet.insert(pixel);
     }
+}
+
+// Draws a primitive whose transform has already been size adjusted and
+// offset from a cached coverage sprite, rather than rasterizing it. Returns
+// false if the primitive is too large or its transform is not a similarity.
+bool
+aggCanvas::impl::drawSprite(RGBA8 c, const agg::trans_affine& tr, SpriteShape shape)
+{
+    double det = tr.determinant();
+    double size = sqrt(fabs(det));
+    if (!(size <= SPRITE_MAX_SIZE) || size * SPRITE_SIZE_STEPS < 0.5)
+        return false;
     
-    color_type c = Converter_type::f(col);
-    rendSolid.color(c.premultiply());
-    rasterizer.filling_rule(fr);
-    agg::render_scanlines(rasterizer, scanline, rendSolid);
-    rasterizer.reset();
+    bool flipped = det < 0.0;
+    double tolerance = 1e-3 * size;
+    if (flipped ? fabs(tr.sx + tr.sy) + fabs(tr.shx - tr.shy) > tolerance
+                : fabs(tr.sx - tr.sy) + fabs(tr.shx + tr.shy) > tolerance)
+        return false;
+    if (!(fabs(tr.tx) < 1e6 && fabs(tr.ty) < 1e6))
+        return false;
+    
+    long qx = lround(tr.tx * SPRITE_SUBPIXELS);
+    long qy = lround(tr.ty * SPRITE_SUBPIXELS);
+    int x = static_cast<int>(std::floor(static_cast<double>(qx) / SPRITE_SUBPIXELS));
+    int y = static_cast<int>(std::floor(static_cast<double>(qy) / SPRITE_SUBPIXELS));
+    int subX = static_cast<int>(qx - static_cast<long>(x) * SPRITE_SUBPIXELS);
+    int subY = static_cast<int>(qy - static_cast<long>(y) * SPRITE_SUBPIXELS);
+    unsigned sizeStep = static_cast<unsigned>(size * SPRITE_SIZE_STEPS + 0.5);
+    
+    // A reflection of a square or a triangle is the same as a rotation by
+    // half a turn, and circles don't rotate at all.
+    unsigned rotation = 0;
+    if (shape != CircleSprite) {
+        double period = shape == SquareSprite ? M_PI / 2.0 : 2.0 * M_PI / 3.0;
+        double theta = atan2(tr.shy, tr.sx) + (flipped ? M_PI : 0.0);
+        long r = lround(theta / period * SPRITE_ROTATION_STEPS) % SPRITE_ROTATION_STEPS;
+        rotation = static_cast<unsigned>(r < 0 ? r + SPRITE_ROTATION_STEPS : r);
+    }
+    
+    // Bit 31 marks a key as used, so empty slots never match
+    std::uint32_t key = 1u << 31 | static_cast<std::uint32_t>(shape) | sizeStep << 2 |
+                        rotation << 10 | subX << 16 | subY << 20;
+    if (sprites.empty())
+        sprites.resize(SPRITE_SLOTS);
+    Sprite& sprite = sprites[(key * 2654435761u) >> 18 & (SPRITE_SLOTS - 1)];
+    if (sprite.key != key && !makeSprite(sprite, shape, sizeStep, rotation, subX, subY))
+        return false;
+    sprite.key = key;
+    
+    countColor(c);
+    blend(c, x, y, sprite);
+    return true;
+}
+
+// Rasterizes a primitive into a sprite. Returns false, leaving the sprite
+// empty, if the coverage doesn't fit in the sprite box.
+bool
+aggCanvas::impl::makeSprite(Sprite& sprite, SpriteShape shape, unsigned size,
+                            unsigned rotation, int subX, int subY)
+{
+    double scale = static_cast<double>(size) / SPRITE_SIZE_STEPS;
+    double period = shape == SquareSprite ? M_PI / 2.0 : 2.0 * M_PI / 3.0;
+    agg::trans_affine tr = agg::trans_affine_scaling(scale);
+    tr *= agg::trans_affine_rotation(rotation * period / SPRITE_ROTATION_STEPS);
+    tr *= agg::trans_affine_translation(static_cast<double>(subX) / SPRITE_SUBPIXELS,
+                                        static_cast<double>(subY) / SPRITE_SUBPIXELS);
+    
+    sprite.key = 0;
+    spriteRasterizer.reset();
+    switch (shape) {
+        case CircleSprite:
+            shapeEllipse.transformer(tr);
+            unitEllipse.init(0.0, 0.0, 0.5, 0.5, int(scale / 2.0) + 8);
+            spriteRasterizer.add_path(shapeEllipse);
+            break;
+        case SquareSprite:
+            shapeSquare.transformer(tr);
+            spriteRasterizer.add_path(shapeSquare);
+            break;
+        case TriangleSprite:
+            shapeTriangle.transformer(tr);
+            spriteRasterizer.add_path(shapeTriangle);
+            break;
+    }
+    
+    sprite.rows = 0;
+    if (!spriteRasterizer.rewind_scanlines())
+        return true;
+    sprite.x = spriteRasterizer.min_x();
+    sprite.y = spriteRasterizer.min_y();
+    sprite.rows = spriteRasterizer.max_y() - sprite.y + 1;
+    if (spriteRasterizer.max_x() - sprite.x >= SPRITE_BOX || sprite.rows > SPRITE_BOX) {
+        sprite.rows = 0;
+        return false;
+    }
+    for (int row = 0; row < sprite.rows; ++row)
+        sprite.len[row] = 0;
+    
+    scanline.reset(spriteRasterizer.min_x(), spriteRasterizer.max_x());
+    while (spriteRasterizer.sweep_scanline(scanline)) {
+        int row = scanline.y() - sprite.y;
+        unsigned spans = scanline.num_spans();
+        agg::scanline_p8::const_iterator span = scanline.begin();
+        int first = span->x - sprite.x, last = first;
+        for (;;) {
+            int x = span->x - sprite.x;
+            int len = span->len < 0 ? -span->len : span->len;
+            for (int i = last; i < x; ++i)
+                sprite.covers[row][i] = 0;
+            for (int i = 0; i < len; ++i)
+                sprite.covers[row][x + i] = span->len < 0 ? *span->covers : span->covers[i];
+            last = x + len;
+            if (--spans == 0) break;
+            ++span;
+        }
+        sprite.start[row] = static_cast<agg::int8u>(first);
+        sprite.len[row] = static_cast<agg::int8u>(last - first);
+    }
+    return true;
 }
 
 template <class  pixel_fmt>
@@ -341,6 +670,8 @@ aggCanvas::aggCanvas(PixelFormat pixfmt) : Canvas(0, 0) {
         case QT_Blend:      m.reset(new aggPixelPainter<qt_pixel_fmt>(this)); break;
         default: break;
     }
+    if (m)
+        m->pixelFormat = pixfmt;
 }
 
 aggCanvas::~aggCanvas() = default;
@@ -357,6 +688,7 @@ aggCanvas::start(bool clear, const agg::rgba& bk, int width, int height)
         m->offsetY = (mHeight - height) / 2;
         agg::trans_affine_translation off(m->offsetX, m->offsetY);
         m->offset = off;
+        m->background = bk;
         m->clear(bk);
     }
 }
@@ -370,6 +702,8 @@ aggCanvas::circle(RGBA8 c, agg::trans_affine tr)
 {
     double size = adjustCircleSize(tr) / 2.0;
     tr *= m->offset;
+    if (m->drawSprite(c, tr, impl::CircleSprite))
+        return;
     
     m->shapeEllipse.transformer(tr);
     m->unitEllipse.init(0.0, 0.0, 0.5, 0.5, int(size)+8);
@@ -383,6 +717,8 @@ aggCanvas::square(RGBA8 c, agg::trans_affine tr)
 {
     adjustSquareSize(tr);
     tr *= m->offset;
+    if (m->drawSprite(c, tr, impl::SquareSprite))
+        return;
     
     m->shapeSquare.transformer(tr);
     
@@ -395,6 +731,8 @@ aggCanvas::triangle(RGBA8 c, agg::trans_affine tr)
 {
     adjustTriangleSize(tr);
     tr *= m->offset;
+    if (m->drawSprite(c, tr, impl::TriangleSprite))
+        return;
     
     m->shapeTriangle.transformer(tr);
  
@@ -420,6 +758,90 @@ aggCanvas::path(RGBA8 c, agg::trans_affine tr, const AST::CommandInfo& attr)
     m->draw(c, rule);
 }
 
+bool
+aggCanvas::drawUnder(bool under)
+{
+    m->under(under);
+    return true;
+}
+
+bool
+aggCanvas::occluded(double x1, double y1, double x2, double y2)
+{
+    if (m->opaqueTiles.empty())
+        return false;
+    
+    // Allow a pixel around the rectangle for anti-aliasing and for the size
+    // adjustment of primitives
+    x1 = std::max(std::floor(x1 + m->offsetX) - 1.0, 0.0);
+    y1 = std::max(std::floor(y1 + m->offsetY) - 1.0, 0.0);
+    x2 = std::min(std::ceil(x2 + m->offsetX) + 1.0, static_cast<double>(mWidth));
+    y2 = std::min(std::ceil(y2 + m->offsetY) + 1.0, static_cast<double>(mHeight));
+    if (!(x1 < x2 && y1 < y2))
+        return true;    // entirely off the canvas
+    return m->occluded(static_cast<int>(x1), static_cast<int>(y1),
+                       static_cast<int>(x2), static_cast<int>(y2));
+}
+
+// Splats are boxes at least a pixel wide, spread over the pixels they
+// overlap and composited over the splats before them in floating point, so
+// that many tiny contributions to a pixel add up.
+bool
+aggCanvas::splat(RGBA8 c, double x, double y, double area, double coverage)
+{
+    double alpha = area * coverage * c.a / static_cast<double>(RGBA8::base_mask);
+    if (!(alpha > 0.0) || !std::isfinite(x) || !std::isfinite(y))
+        return true;
+    double half = std::max(0.5, std::sqrt(area) / 2.0);
+    double x1 = std::max(x + m->offsetX - half, 0.0);
+    double y1 = std::max(y + m->offsetY - half, 0.0);
+    double x2 = std::min(x + m->offsetX + half, static_cast<double>(mWidth));
+    double y2 = std::min(y + m->offsetY + half, static_cast<double>(mHeight));
+    if (!(x1 < x2 && y1 < y2))
+        return true;
+    
+    if (m->splats.empty())
+        m->splats.assign(static_cast<size_t>(mWidth) * mHeight * 4, 0.0f);
+    m->countColor(c);
+    
+    double density = alpha / (4.0 * half * half);
+    float r = static_cast<float>(c.r) / RGBA8::base_mask;
+    float g = static_cast<float>(c.g) / RGBA8::base_mask;
+    float b = static_cast<float>(c.b) / RGBA8::base_mask;
+    for (int py = static_cast<int>(y1); py < y2; ++py) {
+        double oy = std::min(y2, py + 1.0) - std::max(y1, static_cast<double>(py));
+        float* acc = m->splats.data() + (static_cast<size_t>(py) * mWidth +
+                                         static_cast<size_t>(x1)) * 4;
+        for (int px = static_cast<int>(x1); px < x2; ++px, acc += 4) {
+            double ox = std::min(x2, px + 1.0) - std::max(x1, static_cast<double>(px));
+            float w = static_cast<float>(std::min(density * ox * oy, 1.0));
+            acc[0] = r * w + acc[0] * (1.0f - w);
+            acc[1] = g * w + acc[1] * (1.0f - w);
+            acc[2] = b * w + acc[2] * (1.0f - w);
+            acc[3] = w + acc[3] * (1.0f - w);
+        }
+    }
+    return true;
+}
+
+bool
+aggCanvas::reframe(const agg::trans_affine& tr)
+{
+    agg::trans_affine t = m->offset;
+    t.invert();
+    t *= tr;
+    t *= m->offset;
+    m->reframe(t);
+    return true;
+}
+
+void
+aggCanvas::flushSplats()
+{
+    if (!m->splats.empty())
+        m->flushSplats();
+}
+
 void
 aggCanvas::attach(void* data, unsigned width, unsigned height, int stride, bool invert)
 {
@@ -433,6 +855,14 @@ aggCanvas::attach(void* data, unsigned width, unsigned height, int stride, bool
     m->reset();
 }
 
+void
+aggCanvas::attachBand(void* data, unsigned rows, int stride, int bottom)
+{
+    m->buffer.attach(reinterpret_cast<agg::int8u*>(data), mWidth, rows, -stride);
+    m->offset = agg::trans_affine_translation(m->offsetX, m->offsetY - bottom);
+    m->reset();
+    m->clear(m->background);
+}
 
 void
 aggCanvas::copy(void* data, unsigned width, unsigned height,
@@ -441,6 +871,41 @@ aggCanvas::copy(void* data, unsigned width, unsigned height,
     m->copy(data, width, height, stride, format);
 }
 
+namespace {
+    // A canvas for drawing an animation frame on another thread, with a
+    // pixel buffer of its own
+    class frameCanvas : public aggCanvas {
+    public:
+        frameCanvas(PixelFormat pixfmt, int width, int height)
+        : aggCanvas(pixfmt)
+        {
+            int stride = width * BytesPerPixel.at(pixfmt);
+            mData.reset(new agg::int8u[static_cast<std::size_t>(stride) * height]);
+            attach(mData.get(), width, height, stride);
+        }
+    private:
+        std::unique_ptr<agg::int8u[]> mData;
+    };
+}
+
+std::unique_ptr<Canvas>
+aggCanvas::makeFrameCanvas()
+{
+    if (!m || !BytesPerPixel.count(m->pixelFormat))
+        return nullptr;
+    return std::unique_ptr<Canvas>(new frameCanvas(m->pixelFormat, mWidth, mHeight));
+}
+
+void
+aggCanvas::outputFrame(Canvas& frame)
+{
+    aggCanvas& f = static_cast<aggCanvas&>(frame);
+    start(true, f.m->background, f.m->cropWidth, f.m->cropHeight);
+    m->buffer.copy_from(f.m->buffer);
+    m->pixelSet.insert(f.m->pixelSet.begin(), f.m->pixelSet.end());
+    end();
+}
+
 bool    aggCanvas::colorCount256()  { return m->colorCount256(); }
 int     aggCanvas::cropX()          { return m->offsetX; }
 int     aggCanvas::cropY()          { return m->offsetY; }
@@ -59,6 +59,13 @@ class aggCanvas : public Canvas {
         void triangle(RGBA8 c, agg::trans_affine tr) override;
         void fill(RGBA8 c) override;
         void path(RGBA8 c, agg::trans_affine tr, const AST::CommandInfo& attr) override;
+        bool drawUnder(bool under) override;
+        bool occluded(double x1, double y1, double x2, double y2) override;
+        bool splat(RGBA8 c, double x, double y, double area, double coverage) override;
+        void flushSplats() override;
+        bool reframe(const agg::trans_affine& tr) override;
+        std::unique_ptr<Canvas> makeFrameCanvas() override;
+        void outputFrame(Canvas& frame) override;
         
         bool colorCount256();
             // return whether the aggCanvas can fit in byte pixels
@@ -72,6 +79,9 @@ class aggCanvas : public Canvas {
     
         void attach(void* data, unsigned width, unsigned height, int stride, bool invert = true);
             // data is int8u grayscale pixels or int32u pixels
+        void attachBand(void* data, unsigned rows, int stride, int bottom);
+            // draw into the rows of the canvas from bottom up to bottom + rows,
+            // held in data, after clearing them to the background
         
         void copy(void* data, unsigned width, unsigned height,
                   int stride, PixelFormat format);
@@ -207,7 +207,7 @@ namespace AST {
                 // copy the parameters with the correct shape type.
                 StackRule* ret = StackRule::alloc(parent, rti);
                 ret->mRuleName = shapeType;
-                return ret;
+                return StackRule::Intern(ret, rti);
             }
         case SimpleParentArgs:
             assert(parent);
@@ -217,7 +217,7 @@ namespace AST {
         case DynamicArgs: {
             StackRule* ret = StackRule::alloc(shapeType, argSize, typeSignature);
             ret->evalArgs(rti, arguments.get(), parent);
-            return ret;
+            return StackRule::Intern(ret, rti);
         }
         case ShapeArgs:
             return arguments->evalArgs(rti, parent);
@@ -0,0 +1,530 @@
+// bench-components.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// Microbenchmarks of the data structures and kernels on the hot path of
+// expansion and rendering. All inputs are generated from fixed seeds so
+// every run does the same work.
+
+#include "test.h"
+
+#include "shape.h"
+#include "chunk_vector.h"
+#include "Rand64.h"
+#include "xorshift64star.h"
+#include "HSBColor.h"
+#include "bounds.h"
+#include "primShape.h"
+#include "pathIterator.h"
+#include "CmdInfo.h"
+#include "aggCanvas.h"
+#include "spanBlend.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_rendering_buffer.h"
+#include "agg_color_rgba.h"
+#include "shapeSTL.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace {
+    const unsigned long ShapeCount = 1 << 16;
+    
+    HSBColor
+    randomColor(Rand64& r)
+    {
+        return HSBColor(r.getDouble() * 360.0, r.getDouble(), r.getDouble(),
+                        r.getDouble());
+    }
+    
+    Modification
+    randomModification(Rand64& r)
+    {
+        Modification m;
+        m.m_transform.rotate(r.getDouble() * 2.0 * MY_PI);
+        m.m_transform.scale(0.5 + r.getDouble());
+        m.m_transform.translate(r.getDouble() * 10.0 - 5.0, r.getDouble() * 10.0 - 5.0);
+        m.m_Z.tz = r.getDouble() - 0.5;
+        m.m_Color = HSBColor(r.getDouble() * 60.0 - 30.0, r.getDouble() * 0.2 - 0.1,
+                             r.getDouble() * 0.2 - 0.1, r.getDouble() * 0.2 - 0.1);
+        m.mRand64Seed.seed(r());
+        return m;
+    }
+    
+    std::vector<agg::trans_affine>
+    randomTransforms(unsigned long count)
+    {
+        Rand64 r(6);
+        std::vector<agg::trans_affine> transforms;
+        for (unsigned long i = 0; i < count; ++i)
+            transforms.push_back(randomModification(r).m_transform);
+        return transforms;
+    }
+    
+    // A closed outline of four cubic curves and a line
+    void
+    curvedPath(agg::path_storage& path)
+    {
+        path.move_to(0.5, 0.0);
+        path.curve4(0.5, 0.3, 0.3, 0.5, 0.0, 0.5);
+        path.curve4(-0.3, 0.5, -0.5, 0.3, -0.5, 0.0);
+        path.curve4(-0.5, -0.6, -0.2, -0.5, 0.0, -0.4);
+        path.line_to(0.2, -0.5);
+        path.curve4(0.4, -0.5, 0.5, -0.3, 0.5, 0.0);
+        path.end_poly(agg::path_flags_close);
+    }
+    
+    template <class BoundsFunction>
+    void
+    sumBounds(const std::vector<agg::trans_affine>& transforms, BoundsFunction bounds)
+    {
+        Bounds total;
+        double totalArea = 0.0;
+        for (const agg::trans_affine& tr: transforms) {
+            agg::point_d cent;
+            double area;
+            total.merge(bounds(tr, &cent, &area));
+            totalArea += area;
+        }
+        Test::keep(total);
+        Test::keep(totalArea);
+    }
+    
+    // An RGBA canvas drawing into its own buffer
+    class BenchCanvas : public aggCanvas {
+    public:
+        static const int Size = 1024;
+        
+        BenchCanvas()
+        : aggCanvas(RGBA8_Blend), mPixels(Size * Size * 4)
+        {
+            attach(mPixels.data(), Size, Size, Size * 4);
+            start(true, agg::rgba(1.0, 1.0, 1.0, 1.0), Size, Size);
+        }
+    private:
+        std::vector<agg::int8u> mPixels;
+    };
+    
+    // Transforms for primitives of the given pixel size scattered over the
+    // canvas. Stretched ones are not similarities, so they skip the sprites.
+    std::vector<agg::trans_affine>
+    canvasTransforms(unsigned long count, double minSize, double maxSize, bool stretch)
+    {
+        Rand64 r(7);
+        std::vector<agg::trans_affine> transforms;
+        for (unsigned long i = 0; i < count; ++i) {
+            double size = minSize + r.getDouble() * (maxSize - minSize);
+            agg::trans_affine tr = agg::trans_affine_scaling(size, stretch ? size * 0.7 : size);
+            tr *= agg::trans_affine_rotation(r.getDouble() * 2.0 * MY_PI);
+            tr *= agg::trans_affine_translation(r.getDouble() * BenchCanvas::Size,
+                                                r.getDouble() * BenchCanvas::Size);
+            transforms.push_back(tr);
+        }
+        return transforms;
+    }
+    
+    template <class Draw>
+    void
+    drawTransforms(const std::vector<agg::trans_affine>& transforms, Draw draw)
+    {
+        BenchCanvas canvas;
+        RGBA8 color(0x4000, 0x8000, 0xc000, 0xffff);
+        for (const agg::trans_affine& tr: transforms)
+            draw(canvas, color, tr);
+        Test::keep(canvas.colorCount256());
+    }
+    
+    // Blends a translucent color into one row with random covers, the way
+    // the scanline renderer does for anti-aliased edges
+    template <class PixFmt>
+    void
+    blendSpans(Test::benchmark& bench, unsigned long count)
+    {
+        const unsigned Width = 1024, Span = 256;
+        std::vector<agg::int8u> pixels(Width * PixFmt::pix_width, 0x80);
+        std::vector<agg::int8u> covers(Span);
+        Rand64 r(8);
+        for (agg::int8u& c: covers)
+            c = static_cast<agg::int8u>(r.getInt(0, 255));
+        agg::rendering_buffer buffer(pixels.data(), Width, 1, Width * PixFmt::pix_width);
+        PixFmt pixFmt(buffer);
+        typename PixFmt::color_type color(agg::rgba(0.2, 0.4, 0.6, 0.8));
+        color.premultiply();
+        bench.startTimer();
+        for (unsigned long i = 0; i < count; ++i)
+            pixFmt.blend_solid_hspan(static_cast<int>(i % (Width - Span)), 0, Span, color,
+                                     covers.data());
+        Test::keep(pixels[0]);
+    }
+    
+    Bounds
+    randomBounds(Rand64& r)
+    {
+        Bounds b;
+        b.merge(r.getDouble() * 100.0, r.getDouble() * 100.0);
+        b.merge(r.getDouble() * 100.0, r.getDouble() * 100.0);
+        return b;
+    }
+    
+    FinishedShape
+    randomFinishedShape(Rand64& r, int order)
+    {
+        Shape s;
+        s.mShapeType = static_cast<int>(r.getInt(0, 3));
+        s.mWorldState = randomModification(r);
+        s.mAreaCache = s.mWorldState.area();
+        return FinishedShape(s, order, randomBounds(r), false);
+    }
+    
+    typedef chunk_vector<FinishedShape, 10> ShapeVector;
+    
+    void
+    fillShapes(ShapeVector& shapes, unsigned long count)
+    {
+        Rand64 r(1);
+        shapes.clear();
+        for (unsigned long i = 0; i < count; ++i)
+            shapes.push_back(randomFinishedShape(r, static_cast<int>(i)));
+    }
+}
+
+// chunk_vector
+
+BENCH(chunk_vector, push_back, ShapeCount) {
+    FinishedShape proto;
+    ShapeVector shapes;
+    for (unsigned long i = 0; i < iterations; ++i) {
+        proto.mOrder = static_cast<int>(i);
+        shapes.push_back(proto);
+    }
+    Test::keep(shapes.size());
+}
+
+BENCH(chunk_vector, iterate, ShapeCount) {
+    ShapeVector shapes;
+    fillShapes(shapes, iterations);
+    startTimer();
+    double total = 0.0;
+    for (const FinishedShape& s: shapes)
+        total += std::fabs(s.mTransform.determinant());
+    Test::keep(total);
+}
+
+BENCH(chunk_vector, sort, ShapeCount) {
+    ShapeVector shapes;
+    fillShapes(shapes, iterations);
+    startTimer();
+    std::sort(shapes.begin(), shapes.end());
+    Test::keep(shapes.front());
+}
+
+BENCH(chunk_vector, sortLayers, ShapeCount) {
+    ShapeVector shapes;
+    fillShapes(shapes, iterations);
+    int i = 0;
+    for (FinishedShape& s: shapes)
+        s.mZ.tz = static_cast<double>(i++ & 3);
+    startTimer();
+    SortFinishedShapes(shapes);
+    Test::keep(shapes.front());
+}
+
+// Random numbers
+
+BENCH(XORshift64star, next, 1 << 24) {
+    XORshift64star gen;
+    XORshift64star::result_type x = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        x ^= gen();
+    Test::keep(x);
+}
+
+BENCH(Rand64, getDouble, 1 << 24) {
+    Rand64 r;
+    double x = 0.0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        x += r.getDouble();
+    Test::keep(x);
+}
+
+BENCH(Rand64, getInt, 1 << 22) {
+    Rand64 r;
+    int64_t x = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        x += r.getInt(-100, 100);
+    Test::keep(x);
+}
+
+BENCH(Rand64, getNormal, 1 << 20) {
+    Rand64 r;
+    double x = 0.0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        x += r.getNormal(0.0, 1.0);
+    Test::keep(x);
+}
+
+BENCH(Rand64, getPoisson, 1 << 20) {
+    Rand64 r;
+    int64_t x = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        x += r.getPoisson(4.0);
+    Test::keep(x);
+}
+
+BENCH(Rand64, getBinomial, 1 << 20) {
+    Rand64 r;
+    int64_t x = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        x += r.getBinomial(20, 0.3);
+    Test::keep(x);
+}
+
+// Color
+
+BENCH(HSBColor, getRGBA, ShapeCount) {
+    Rand64 r(2);
+    std::vector<HSBColor> colors;
+    for (unsigned long i = 0; i < iterations; ++i)
+        colors.push_back(randomColor(r));
+    startTimer();
+    agg::rgba c, total(0.0, 0.0, 0.0, 0.0);
+    for (const HSBColor& hsb: colors) {
+        hsb.getRGBA(c);
+        total.r += c.r; total.g += c.g; total.b += c.b; total.a += c.a;
+    }
+    Test::keep(total);
+}
+
+BENCH(HSBColor, getRGBAbatch, ShapeCount) {
+    Rand64 r(2);
+    std::vector<HSBColor> colors;
+    for (unsigned long i = 0; i < iterations; ++i)
+        colors.push_back(randomColor(r));
+    std::vector<agg::rgba> rgba(colors.size());
+    startTimer();
+    HSBColor::GetRGBA(colors.data(), rgba.data(), colors.size());
+    agg::rgba total(0.0, 0.0, 0.0, 0.0);
+    for (const agg::rgba& c: rgba) {
+        total.r += c.r; total.g += c.g; total.b += c.b; total.a += c.a;
+    }
+    Test::keep(total);
+}
+
+BENCH(HSBColor, Adjust, ShapeCount) {
+    Rand64 r(3);
+    std::vector<HSBColor> adjustments;
+    for (unsigned long i = 0; i < iterations; ++i)
+        adjustments.push_back(HSBColor(r.getDouble() * 60.0 - 30.0,
+                                       r.getDouble() * 0.2 - 0.1,
+                                       r.getDouble() * 0.2 - 0.1,
+                                       r.getDouble() * 0.2 - 0.1));
+    HSBColor target(180.0, 0.5, 0.5, 1.0);
+    startTimer();
+    HSBColor color(0.0, 0.5, 0.5, 1.0), colorTarget;
+    for (unsigned long i = 0; i < iterations; ++i)
+        HSBColor::Adjust(color, colorTarget, adjustments[i], target,
+                         i & 1 ? HSBColor::HSBATarget : 0);
+    Test::keep(color);
+}
+
+// Geometry
+
+BENCH(Modification, multiply, ShapeCount) {
+    Rand64 r(4);
+    std::vector<Modification> mods;
+    for (unsigned long i = 0; i < iterations; ++i)
+        mods.push_back(randomModification(r));
+    startTimer();
+    Modification world;
+    for (const Modification& m: mods) {
+        world *= m;
+        // Keep the transform from collapsing to zero or overflowing
+        world.m_transform.scale(1.0 / std::sqrt(world.area()));
+    }
+    Test::keep(world);
+}
+
+BENCH(Bounds, merge, ShapeCount) {
+    Rand64 r(5);
+    std::vector<Bounds> bounds;
+    for (unsigned long i = 0; i < iterations; ++i)
+        bounds.push_back(randomBounds(r));
+    startTimer();
+    Bounds total;
+    for (const Bounds& b: bounds)
+        total.merge(b);
+    Test::keep(total);
+}
+
+BENCH(Bounds, circle, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = randomTransforms(iterations);
+    startTimer();
+    sumBounds(transforms, [](const agg::trans_affine& tr, agg::point_d* cent, double* area) {
+        return Bounds(tr, primShape::circle, cent, area);
+    });
+}
+
+BENCH(Bounds, curvedFill, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = randomTransforms(iterations);
+    agg::path_storage path;
+    curvedPath(path);
+    AST::CommandInfo attr(&path);
+    pathIterator helper;
+    startTimer();
+    sumBounds(transforms, [&](const agg::trans_affine& tr, agg::point_d* cent, double* area) {
+        return Bounds(tr, helper, 100.0, attr, cent, area);
+    });
+}
+
+BENCH(Bounds, curvedStroke, ShapeCount / 4) {
+    std::vector<agg::trans_affine> transforms = randomTransforms(iterations);
+    agg::path_storage path;
+    curvedPath(path);
+    AST::CommandInfo attr(&path);
+    attr.mFlags = AST::CF_MITER_JOIN + AST::CF_BUTT_CAP;
+    pathIterator helper;
+    startTimer();
+    sumBounds(transforms, [&](const agg::trans_affine& tr, agg::point_d* cent, double* area) {
+        return Bounds(tr, helper, 100.0, attr, cent, area);
+    });
+}
+
+BENCH(Bounds, curvedStrokeCached, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = randomTransforms(iterations);
+    agg::path_storage path;
+    curvedPath(path);
+    AST::CommandInfo attr(&path);
+    attr.mFlags = AST::CF_MITER_JOIN + AST::CF_BUTT_CAP;
+    attr.mPathUID = AST::CommandInfo::PathUIDDefault - 1;   // any UID enables caching
+    pathIterator helper;
+    startTimer();
+    sumBounds(transforms, [&](const agg::trans_affine& tr, agg::point_d* cent, double* area) {
+        return Bounds(tr, helper, 100.0, attr, cent, area);
+    });
+}
+
+// Drawing
+
+BENCH(aggCanvas, dot, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = canvasTransforms(iterations, 2.0, 2.0, false);
+    startTimer();
+    drawTransforms(transforms, [](aggCanvas& c, RGBA8 color, const agg::trans_affine& tr) {
+        c.circle(color, tr);
+    });
+}
+
+BENCH(aggCanvas, tinyCircle, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = canvasTransforms(iterations, 1.0, 3.0, false);
+    startTimer();
+    drawTransforms(transforms, [](aggCanvas& c, RGBA8 color, const agg::trans_affine& tr) {
+        c.circle(color, tr);
+    });
+}
+
+BENCH(aggCanvas, tinySquare, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = canvasTransforms(iterations, 1.0, 3.0, false);
+    startTimer();
+    drawTransforms(transforms, [](aggCanvas& c, RGBA8 color, const agg::trans_affine& tr) {
+        c.square(color, tr);
+    });
+}
+
+BENCH(aggCanvas, tinyEllipse, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = canvasTransforms(iterations, 1.0, 3.0, true);
+    startTimer();
+    drawTransforms(transforms, [](aggCanvas& c, RGBA8 color, const agg::trans_affine& tr) {
+        c.circle(color, tr);
+    });
+}
+
+// Squares drawn back to front, skipping the hidden ones
+BENCH(aggCanvas, underSquare, ShapeCount / 4) {
+    std::vector<agg::trans_affine> transforms = canvasTransforms(iterations, 10.0, 40.0, false);
+    BenchCanvas canvas;
+    RGBA8 color(0x4000, 0x8000, 0xc000, 0xffff);
+    startTimer();
+    canvas.drawUnder(true);
+    for (const agg::trans_affine& tr: transforms)
+        if (!canvas.occluded(tr.tx - 30.0, tr.ty - 30.0, tr.tx + 30.0, tr.ty + 30.0))
+            canvas.square(color, tr);
+    canvas.drawUnder(false);
+    Test::keep(canvas.colorCount256());
+}
+
+// Occlusion tests of 40 pixel squares once the canvas is opaque
+BENCH(aggCanvas, occluded, ShapeCount) {
+    std::vector<agg::trans_affine> transforms = canvasTransforms(iterations, 40.0, 40.0, false);
+    BenchCanvas canvas;
+    canvas.drawUnder(true);
+    canvas.fill(RGBA8(0x4000, 0x8000, 0xc000, 0xffff));
+    unsigned long hidden = 0;
+    startTimer();
+    for (const agg::trans_affine& tr: transforms)
+        hidden += canvas.occluded(tr.tx - 20.0, tr.ty - 20.0, tr.tx + 20.0, tr.ty + 20.0);
+    Test::keep(hidden);
+}
+
+BENCH(blend, aggRGBA32, ShapeCount / 4) {
+    blendSpans<agg::pixfmt_rgba32_pre>(*this, iterations);
+}
+
+BENCH(blend, spanRGBA32, ShapeCount / 4) {
+    blendSpans<spanBlendPixfmt<agg::pixfmt_rgba32_pre>>(*this, iterations);
+}
+
+BENCH(blend, aggRGBA64, ShapeCount / 4) {
+    blendSpans<agg::pixfmt_rgba64_pre>(*this, iterations);
+}
+
+BENCH(blend, spanRGBA64, ShapeCount / 4) {
+    blendSpans<spanBlendPixfmt<agg::pixfmt_rgba64_pre>>(*this, iterations);
+}
+
+// Temp file serialization
+
+BENCH(FinishedShape, write, ShapeCount) {
+    ShapeVector shapes;
+    fillShapes(shapes, iterations);
+    std::ostringstream os;
+    startTimer();
+    for (const FinishedShape& s: shapes)
+        os << s;
+    Test::keep(os.tellp());
+}
+
+BENCH(FinishedShape, read, ShapeCount) {
+    ShapeVector shapes;
+    fillShapes(shapes, iterations);
+    std::stringstream ss;
+    for (const FinishedShape& s: shapes)
+        ss << s;
+    startTimer();
+    FinishedShape s;
+    double total = 0.0;
+    for (unsigned long i = 0; i < iterations; ++i) {
+        ss >> s;
+        total += std::fabs(s.mTransform.determinant());
+    }
+    Test::keep(total);
+}
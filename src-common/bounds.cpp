@@ -48,6 +48,27 @@ Bounds::Bounds(const agg::trans_affine& trans, pathIterator& helper, double scal
     }
 }
 
+// Primitive shapes are polygons, so their transformed bounds are the bounds of
+// the transformed vertices and their area and centroid transform directly.
+Bounds::Bounds(const agg::trans_affine& trans, const primShape& shape,
+               agg::point_d* cent, double* area)
+: Bounds()
+{
+    for (unsigned i = 0, n = shape.total_vertices(); i < n; ++i) {
+        double x, y;
+        if (agg::is_vertex(shape.vertex(i, &x, &y))) {
+            trans.transform(&x, &y);
+            merge(x, y);
+        }
+    }
+    if (cent) {
+        *cent = shape.mCentroid;
+        trans.transform(&cent->x, &cent->y);
+    }
+    if (area)
+        *area = shape.mArea * fabs(trans.determinant());
+}
+
 Bounds
 Bounds::interpolate(const Bounds& other, double alpha) const
 {
@@ -187,3 +208,11 @@ Bounds::update(const agg::trans_affine& trns, pathIterator& helper, double scale
     merge(b);
 }
 
+void
+Bounds::update(const agg::trans_affine& trns, const primShape& shape,
+               agg::point_d* cent, double* area)
+{
+    Bounds b(trns, shape, cent, area);
+    merge(b);
+}
+
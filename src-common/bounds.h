@@ -47,15 +47,22 @@ namespace AST {
     struct CommandInfo; 
 }
 class pathIterator; 
+class primShape;
 
 class Bounds {
     public:
-        Bounds() : mMin_X(std::numeric_limits<double>::infinity()) {}
+        Bounds() : mMin_X(std::numeric_limits<double>::infinity()),
+                   mMin_Y(std::numeric_limits<double>::infinity()),
+                   mMax_X(-std::numeric_limits<double>::infinity()),
+                   mMax_Y(-std::numeric_limits<double>::infinity()) {}
 
         Bounds(const agg::trans_affine& trans, pathIterator& helper, 
                double scale, const AST::CommandInfo& attr,
                agg::point_d* cent = nullptr, double* area = nullptr);
                 // set bounds to be the bounds of this shape, transformed
+        Bounds(const agg::trans_affine& trans, const primShape& shape,
+               agg::point_d* cent = nullptr, double* area = nullptr);
+                // closed-form bounds of a primitive shape, transformed
 
         bool valid() const { return myfinite(mMin_X) && myfinite(mMax_X) &&
                                     myfinite(mMin_Y) && myfinite(mMax_Y); }
@@ -128,6 +135,8 @@ class Bounds {
         void update(const agg::trans_affine& trns, pathIterator& helper, 
                     double scale, const AST::CommandInfo& attr,
                     agg::point_d* cent = nullptr, double* area = nullptr);
+        void update(const agg::trans_affine& trns, const primShape& shape,
+                    agg::point_d* cent = nullptr, double* area = nullptr);
     
         double  mMin_X, mMin_Y, mMax_X, mMax_Y;
 };
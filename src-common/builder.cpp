@@ -210,7 +210,7 @@ Builder::IncludeFile(const std::string& fname)
 {
     std::string path =
         m_CFDG->system()->relativeFilePath(*m_currentPath, fname.c_str());
-    std::unique_ptr<std::istream> input(m_CFDG->system()->openFileForRead(path));
+    std::unique_ptr<std::istream> input(m_CFDG->openSource(path));
     if (!input || !input->good()) {
         m_CFDG->system()->error();
         mErrorOccured = true;
@@ -834,6 +834,6 @@ Builder::timeWise()
 void
 Builder::storeParams(const StackRule* p)
 {
-    p->mRefCount = StackRule::MaxRefCount;
+    p->setRefCount(StackRule::MaxRefCount);
     m_CFDG->mLongLivedParams.push_back(p);
 }
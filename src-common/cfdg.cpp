@@ -41,6 +41,7 @@
 #include "cfdg.tab.hpp"
 #include <limits>
 #include "tiledCanvas.h"
+#include "traceLog.h"
 #include <fstream>
 
 using namespace std;
@@ -49,7 +50,7 @@ using namespace std;
 yy::location CfdgError::Default;
 double Renderer::Infinity = numeric_limits<double>::infinity();      // Ignore the gcc warning
 bool Renderer::AbortEverything = false;
-unsigned Renderer::ParamCount = 0;
+std::atomic<unsigned> Renderer::ParamCount(0);
 const CfgArray<std::string> CFDG::ParamNames = {
     "CF::AllowOverlap",
     "CF::Alpha",
@@ -154,6 +155,7 @@ CFDG::~CFDG() = default;
 CFDG*
 CFDG::ParseFile(const char* fname, AbstractSystem* system, int variation)
 {
+    TraceLog::Scope trace("parse", "parse");
     cfdgi_ptr pCfdg;
     for (int version = 2; version <= 3; ++version) {
         if (!pCfdg)
@@ -167,7 +169,7 @@ CFDG::ParseFile(const char* fname, AbstractSystem* system, int variation)
                                           yy::CfdgParser::token::CFDG3;
         
         yy::CfdgParser parser(b);
-        std::unique_ptr<istream> input(system->openFileForRead(fname));
+        std::unique_ptr<istream> input(b.m_CFDG->openSource(fname));
         if (!input || !input->good()) {
             system->error();
             system->message("Couldn't open rules file %s", fname);
@@ -34,6 +34,7 @@
 #include <string>
 #include <time.h>
 #include <vector>
+#include <atomic>
 #include "agg_trans_affine.h"
 #include "agg_color_rgba.h"
 #include "agg_path_storage.h"
@@ -143,6 +144,44 @@ class Canvas {
         virtual void triangle(RGBA8 , agg::trans_affine ) = 0;
         virtual void fill(RGBA8) = 0;
         virtual void path(RGBA8 , agg::trans_affine, const AST::CommandInfo& ) = 0;
+    
+        // Occlusion culling: between drawUnder(true) and drawUnder(false)
+        // shapes come in reverse order and are composited under what is
+        // already drawn, and the background goes under all of them at the
+        // end. Canvases that can't draw under return false. occluded()
+        // tells whether a rectangle in pixels is already completely opaque.
+        virtual bool drawUnder(bool ) { return false; }
+        virtual bool occluded(double , double , double , double ) { return false; }
+    
+        // Level of detail: splat() accumulates a shape too small to draw as a
+        // spot of area pixels, coverage of which is covered, in a layer that
+        // flushSplats() blends over the canvas. Canvases that can't splat
+        // return false.
+        virtual bool splat(RGBA8 , double , double , double , double ) { return false; }
+        virtual void flushSplats() {}
+    
+        // Previews: reframe() moves what is drawn so far by the transform, in
+        // pixels, when the frame of a preview grows. Canvases that can't
+        // return false.
+        virtual bool reframe(const agg::trans_affine& ) { return false; }
+    
+        // Parallel animation: makeFrameCanvas() makes a canvas of the same
+        // size and format that a frame can be drawn into on another thread
+        // and outputFrame() outputs such a frame in place of start() and
+        // end(). Canvases that can't return null.
+        virtual std::unique_ptr<Canvas> makeFrameCanvas() { return nullptr; }
+        virtual void outputFrame(Canvas& ) {}
+    
+        // Banded output: a canvas too big to hold in memory is drawn one
+        // horizontal band at a time, between start() and end(). bands() is
+        // the number of bands, bandRange() sets the first and last band that
+        // pixel rows y1 to y2 fall in (first > last if none), and the shapes
+        // of each band in turn are drawn between startBand() and endBand().
+        virtual int bands() { return 1; }
+        virtual void bandRange(double , double , int& first, int& last)
+        { first = 0; last = 0; }
+        virtual void startBand(int ) {}
+        virtual void endBand(int ) {}
 
         Canvas(int width, int height) 
         : mWidth(width), mHeight(height), mError(false) {}
@@ -194,6 +233,14 @@ class Renderer {
         virtual ~Renderer();
         
         virtual void setMaxShapes(int n) = 0;        
+        virtual void setOcclusionCulling(bool cull) = 0;
+            // draw opaque designs back to front, skipping hidden shapes
+        virtual void setLevelOfDetail(bool splat) = 0;
+            // splat shapes and rules below the minimum size instead of
+            // dropping them
+        virtual void setPreview(Canvas* preview, double interval) = 0;
+            // draw finished shapes into preview while expanding and output
+            // it every interval seconds
         virtual void resetBounds() = 0;
         virtual void resetSize(int x, int y) = 0;
 
@@ -211,7 +258,7 @@ class Renderer {
     
         static double Infinity;
         static bool   AbortEverything;
-        static unsigned ParamCount;
+        static std::atomic<unsigned> ParamCount;   // shapes are read and written on spill threads
     protected:
         Renderer(int w, int h);
 };
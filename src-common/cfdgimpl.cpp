@@ -37,7 +37,10 @@
 #include "astreplacement.h"
 #include <limits>
 #include <cstring>
+#include <sstream>
+#include <memory>
 #include "agg_trans_affine_time.h"
+#include "traceLog.h"
 
 #ifdef _WIN32
 #pragma warning( disable : 4800 4189 )
@@ -194,6 +197,22 @@ CFDGImpl::getColor(const HSBColor& hsb)
     }
 }
 
+void
+CFDGImpl::getColors(const HSBColor* hsb, RGBA8* colors, std::size_t count)
+{
+    const std::size_t BatchSize = 64;
+    agg::rgba c[BatchSize];
+    while (count) {
+        std::size_t n = count < BatchSize ? count : BatchSize;
+        HSBColor::GetRGBA(hsb, c, n);
+        for (std::size_t i = 0; i < n; ++i)
+            colors[i] = uses16bitColor ? RGBA8(c[i]) : RGBA8(agg::rgba8(c[i]));
+        hsb += n;
+        colors += n;
+        count -= n;
+    }
+}
+
 bool
 CFDGImpl::isTiled(agg::trans_affine* tr, double* x, double* y) const
 {
@@ -428,9 +447,14 @@ CFDGImpl::rulesLoaded()
     sort(mRules.begin(), mRules.end(), ASTrule::compareLT);
     
     Builder::CurrentBuilder->mLocalStackDepth = 0;
-    mCFDGcontents.compile(CompilePhase::TypeCheck);
-    if (!Builder::CurrentBuilder->mErrorOccured)
+    {
+        TraceLog::Scope trace("type check", "compile");
+        mCFDGcontents.compile(CompilePhase::TypeCheck);
+    }
+    if (!Builder::CurrentBuilder->mErrorOccured) {
+        TraceLog::Scope trace("simplify", "compile");
         mCFDGcontents.compile(CompilePhase::Simplify);
+    }
     
     // Wait until done and then update these members
     double value;
@@ -577,6 +601,19 @@ CFDGImpl::resetCachedPaths()
         rule->mCachedPath.reset();
 }
 
+std::istream*
+CFDGImpl::openSource(const std::string& path)
+{
+    std::unique_ptr<std::istream> input(m_system->openFileForRead(path));
+    if (!input || !input->good())
+        return nullptr;
+    std::ostringstream text;
+    text << input->rdbuf();
+    std::string& source = mSources[path];
+    source = text.str();
+    return new std::istringstream(source, std::ios::binary);
+}
+
 AST::ASTdefine*
 CFDGImpl::declareFunction(int nameIndex, AST::ASTdefine* def)
 {
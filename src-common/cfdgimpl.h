@@ -132,6 +132,7 @@ private:
         const Shape& getInitialShape(RendererAST* r);
     
         RGBA8 getColor(const HSBColor& hsb);
+        void getColors(const HSBColor* hsb, RGBA8* colors, std::size_t count);
         
         bool addRule(AST::ASTrule* r);
         void rulesLoaded();
@@ -151,6 +152,9 @@ private:
         int getShapeParamSize(int shapetype);
         int reportStackDepth(int size = 0); 
         void resetCachedPaths();
+        std::istream* openSource(const std::string& path);
+            // Opens a rules file and keeps its text in mSources. Returns
+            // null if it can't be read.
 
         AST::ASTdefine* declareFunction(int nameIndex, AST::ASTdefine* def);
         AST::ASTdefine* findFunction(int nameIndex);
@@ -163,6 +167,8 @@ private:
         std::deque<const StackRule*> mLongLivedParams;
     
         std::list<std::string> fileNames;
+        std::map<std::string, std::string> mSources;
+            // the text of the rules files, to parse the design again from
 };
 
 typedef std::unique_ptr<CFDGImpl> cfdgi_ptr;
@@ -430,7 +430,7 @@ public:
         size_t tempend = _end;
         _Alloc tempalloc = _valAlloc;
         _start = with._start;
-        _end = with._size;
+        _end = with._end;
         _valAlloc = with._valAlloc;
         with._start = tempstart;
         with._end = tempend;
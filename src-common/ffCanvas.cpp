@@ -26,6 +26,12 @@
 
 #include "ffCanvas.h"
 #include <cassert>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -41,6 +47,8 @@ public:
     ~Impl();
     
     void addFrame();
+        // Queues a copy of the canvas for the encoder thread, waiting for
+        // room in the queue if necessary
     
     int             mWidth;
     int             mHeight;
@@ -52,6 +60,22 @@ public:
     AVFormatContext *mOutputCtx;
     AVFrame         *mFrame;
     
+    // Frames are encoded on a thread of their own while the next frame is
+    // drawn. The canvas is copied because an animation frame can be drawn
+    // over the previous one.
+    static const int QueuedFrames = 2;
+    typedef std::unique_ptr<char[]> FrameBuffer;
+    std::vector<FrameBuffer>    mFree;
+    std::deque<FrameBuffer>     mQueue;
+    std::thread                 mEncoder;
+    std::mutex                  mMutex;
+    std::condition_variable     mCond;
+    bool                        mDone;
+    const char*                 mEncodeError;
+    
+    void encode();
+    const char* encodeFrame(char* bits);
+    
     static const uint32_t
                     dummyPalette[256];
     
@@ -63,7 +87,7 @@ const uint32_t ffCanvas::Impl::dummyPalette[256] = { 0 };
 ffCanvas::Impl::Impl(const char* name, PixelFormat fmt, int width, int height, int stride,
                      char* bits, int fps)
 : mWidth(width), mHeight(height), mStride(stride), mBuffer(bits), mFrameRate(fps),
-  mError(NULL), mOutputCtx(NULL), mFrame(NULL)
+  mError(NULL), mOutputCtx(NULL), mFrame(NULL), mDone(false), mEncodeError(NULL)
 {
     avcodec_register_all();
     av_register_all();
@@ -101,6 +125,9 @@ ffCanvas::Impl::Impl(const char* name, PixelFormat fmt, int width, int height, i
     codecCtx->time_base.den = fps;
     codecCtx->gop_size = 10; /* emit one intra frame every ten frames */
     codecCtx->flags |= CODEC_FLAG_GLOBAL_HEADER;
+    /* let the encoder use threads of its own if it can */
+    codecCtx->thread_count = static_cast<int>(std::thread::hardware_concurrency());
+    codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
     
     switch (fmt) {
         case aggCanvas::Gray8_Blend:
@@ -144,10 +171,25 @@ ffCanvas::Impl::Impl(const char* name, PixelFormat fmt, int width, int height, i
         mError = "failed to write video file header";
         return;
     }
+    
+    for (int i = 0; i < QueuedFrames; ++i)
+        mFree.emplace_back(new char[stride * height]);
+    mEncoder = std::thread(&Impl::encode, this);
 }
 
 ffCanvas::Impl::~Impl()
 {
+    if (mEncoder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDone = true;
+        }
+        mCond.notify_all();
+        mEncoder.join();
+        if (!mError)
+            mError = mEncodeError;
+    }
+    
     if (!mError) {
         AVStream* stream = mOutputCtx->streams[0];
         AVPacket pkt;
@@ -189,21 +231,66 @@ ffCanvas::Impl::~Impl()
 
 void
 ffCanvas::Impl::addFrame()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCond.wait(lock, [this]() { return !mFree.empty() || mEncodeError; });
+    if (mEncodeError) {
+        mError = mEncodeError;
+        return;
+    }
+    FrameBuffer frame = std::move(mFree.back());
+    mFree.pop_back();
+    lock.unlock();
+    
+    std::memcpy(frame.get(), mBuffer.get(), mStride * mHeight);
+    
+    lock.lock();
+    mQueue.push_back(std::move(frame));
+    mCond.notify_all();
+}
+
+// The encoder thread: encodes the queued frames in order until the canvas is
+// done with and the queue is empty
+void
+ffCanvas::Impl::encode()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mCond.wait(lock, [this]() { return !mQueue.empty() || mDone; });
+        if (mQueue.empty())
+            return;
+        FrameBuffer frame = std::move(mQueue.front());
+        mQueue.pop_front();
+        bool failed = mEncodeError != NULL;
+        lock.unlock();
+        
+        const char* error = failed ? NULL : encodeFrame(frame.get());
+        
+        lock.lock();
+        if (error)
+            mEncodeError = error;
+        mFree.push_back(std::move(frame));
+        mCond.notify_all();
+    }
+}
+
+const char*
+ffCanvas::Impl::encodeFrame(char* bits)
 {
     AVStream* stream = mOutputCtx->streams[0];
     AVPacket pkt;
     int got_output;
     
+    mFrame->data[0] = (uint8_t*)bits;
+    
     av_init_packet(&pkt);
     pkt.data = NULL;    // packet data will be allocated by the encoder
     pkt.size = 0;
     
     int ret = avcodec_encode_video2(stream->codec, &pkt, mFrame, &got_output);
     
-    if (ret < 0) {
-        mError = "video encoding failed";
-        return;
-    }
+    if (ret < 0)
+        return "video encoding failed";
     
     if (got_output) {
         pkt.stream_index = stream->index;
@@ -211,12 +298,12 @@ ffCanvas::Impl::addFrame()
         if (stream->codec->coded_frame->key_frame)
             pkt.flags |= AV_PKT_FLAG_KEY;
         if (av_write_frame(mOutputCtx, &pkt) < 0) {
-            mError = "video frame write error";
             av_free_packet(&pkt);
-            return;
+            return "video frame write error";
         }
         //av_free_packet(&pkt);
     }
+    return NULL;
 }
 
 static aggCanvas::PixelFormat
@@ -27,18 +27,267 @@
 #include "ast.h"
 #include "CmdInfo.h"
 #include "primShape.h"
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
 
 static primShape dummy;
 
+namespace {
+    // Flattened paths are cached at approximation scales rounded up to the
+    // next quarter octave, so a cached path is never coarser than requested.
+    const int ScaleBucketsPerOctave = 4;
+    const int CuspFlag = 1 << 30;
+    const std::size_t MaxCachedVertices = 1 << 20;
+    
+    struct FlatKeyHash {
+        std::size_t operator()(const pathIterator::FlatKey& k) const
+        {
+            std::size_t h = std::hash<AST::UIDdatatype>()(k.mPathUID);
+            h = h * 31 + k.mIndex;
+            h = h * 31 + static_cast<std::size_t>(k.mScaleBucket);
+            h = h * 31 + static_cast<std::size_t>(k.mFlags);
+            h = h * 31 + std::hash<double>()(k.mStrokeWidth);
+            return h * 31 + std::hash<double>()(k.mMiterLimit);
+        }
+    };
+    
+    // Flattened paths shared by every pathIterator. Path UIDs are never
+    // reused, so entries never go stale; the cache is simply emptied when it
+    // grows too large. Flattening happens under the lock because it iterates
+    // the shared path storage.
+    class FlatCache {
+    public:
+        std::shared_ptr<const pathIterator::FlatPath>
+        get(const pathIterator::FlatKey& key, agg::path_storage& path)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mPaths.find(key);
+            if (it != mPaths.end())
+                return it->second;
+            std::shared_ptr<const pathIterator::FlatPath> flatPath = flatten(key, path);
+            if (flatPath->size() > MaxCachedVertices / 16)
+                return flatPath;
+            if (mVertices + flatPath->size() > MaxCachedVertices) {
+                mPaths.clear();
+                mVertices = 0;
+            }
+            mPaths.emplace(key, flatPath);
+            mVertices += flatPath->size();
+            return flatPath;
+        }
+    private:
+        std::mutex mMutex;
+        std::unordered_map<pathIterator::FlatKey,
+                           std::shared_ptr<const pathIterator::FlatPath>,
+                           FlatKeyHash> mPaths;
+        std::size_t mVertices = 0;
+        
+        static std::shared_ptr<const pathIterator::FlatPath>
+        flatten(const pathIterator::FlatKey& key, agg::path_storage& path)
+        {
+            double approx = std::exp2(static_cast<double>(key.mScaleBucket) /
+                                      ScaleBucketsPerOctave);
+            auto flatPath = std::make_shared<pathIterator::FlatPath>();
+            pathIterator::CurvedPath curved(path);
+            curved.approximation_scale(approx);
+            if (key.mFlags & AST::CF_FILL) {
+                append(*flatPath, curved, key.mIndex);
+            } else {
+                curved.angle_tolerance(key.mFlags & CuspFlag ? 0.2 : 0.0);
+                pathIterator::CurvedStroked stroked(curved);
+                stroked.width(key.mStrokeWidth);
+                stroked.line_join(static_cast<agg::line_join_e>(key.mFlags & 7));
+                stroked.line_cap(static_cast<agg::line_cap_e>((key.mFlags >> 4) & 7));
+                stroked.miter_limit(key.mMiterLimit);
+                stroked.inner_join(agg::inner_round);
+                stroked.approximation_scale(approx);
+                append(*flatPath, stroked, key.mIndex);
+            }
+            return flatPath;
+        }
+        
+        template <class VertexSource>
+        static void
+        append(pathIterator::FlatPath& flatPath, VertexSource& source, unsigned index)
+        {
+            double x, y;
+            unsigned cmd;
+            source.rewind(index);
+            while (!agg::is_stop(cmd = source.vertex(&x, &y)))
+                flatPath.emplace_back(x, y, cmd);
+        }
+    };
+    
+    FlatCache TheFlatCache;
+    
+    // Stroking after a transform gives the same outline as stroking before it
+    // only when the transform is a similarity
+    bool
+    isSimilarity(const agg::trans_affine& tr, double scale)
+    {
+        double tolerance = 1e-9 * scale;
+        return (fabs(tr.sx - tr.sy) + fabs(tr.shx + tr.shy) <= tolerance) ||
+               (fabs(tr.sx + tr.sy) + fabs(tr.shx - tr.shy) <= tolerance);
+    }
+    
+    // Five point Gauss-Legendre quadrature on [0,1], which is exact for
+    // polynomials of degree 9 or less
+    const double GaussNodes[5] = {
+        0.5 - 0.5 * 0.9061798459386640, 0.5 - 0.5 * 0.5384693101056831, 0.5,
+        0.5 + 0.5 * 0.5384693101056831, 0.5 + 0.5 * 0.9061798459386640
+    };
+    const double GaussWeights[5] = {
+        0.5 * 0.2369268850561891, 0.5 * 0.4786286704993665, 0.5 * 0.5688888888888889,
+        0.5 * 0.4786286704993665, 0.5 * 0.2369268850561891
+    };
+    
+    // Area and centroid of an outline, accumulated segment by segment using
+    // Green's theorem. Line segments are done like agg::conv_centroid does
+    // them, curves are integrated exactly instead of being flattened.
+    struct OutlineMoments {
+        double area2 = 0.0;             // twice the signed area
+        double mx = 0.0, my = 0.0;      // 3 * area2 / 2 * centroid
+        
+        void line(const agg::point_d& p, const agg::point_d& q)
+        {
+            double term = q.y * p.x - q.x * p.y;
+            area2 += term;
+            mx += 0.5 * (q.x + p.x) * term;
+            my += 0.5 * (q.y + p.y) * term;
+        }
+        
+        // Bezier curve with control points c[0..degree]
+        void curve(const agg::point_d* c, int degree)
+        {
+            for (int i = 0; i < 5; ++i) {
+                double t = GaussNodes[i], u = 1.0 - t;
+                agg::point_d p, d;
+                if (degree == 2) {
+                    p.x = u * u * c[0].x + 2 * u * t * c[1].x + t * t * c[2].x;
+                    p.y = u * u * c[0].y + 2 * u * t * c[1].y + t * t * c[2].y;
+                    d.x = 2 * (u * (c[1].x - c[0].x) + t * (c[2].x - c[1].x));
+                    d.y = 2 * (u * (c[1].y - c[0].y) + t * (c[2].y - c[1].y));
+                } else {
+                    p.x = u * u * u * c[0].x + 3 * u * u * t * c[1].x +
+                          3 * u * t * t * c[2].x + t * t * t * c[3].x;
+                    p.y = u * u * u * c[0].y + 3 * u * u * t * c[1].y +
+                          3 * u * t * t * c[2].y + t * t * t * c[3].y;
+                    d.x = 3 * (u * u * (c[1].x - c[0].x) + 2 * u * t * (c[2].x - c[1].x) +
+                               t * t * (c[3].x - c[2].x));
+                    d.y = 3 * (u * u * (c[1].y - c[0].y) + 2 * u * t * (c[2].y - c[1].y) +
+                               t * t * (c[3].y - c[2].y));
+                }
+                double term = GaussWeights[i] * (p.x * d.y - p.y * d.x);
+                area2 += term;
+                mx += p.x * term;
+                my += p.y * term;
+            }
+        }
+    };
+    
+    agg::point_d
+    CurvePoint(const agg::point_d* c, int degree, double t)
+    {
+        double u = 1.0 - t;
+        if (degree == 2)
+            return agg::point_d(u * u * c[0].x + 2 * u * t * c[1].x + t * t * c[2].x,
+                                u * u * c[0].y + 2 * u * t * c[1].y + t * t * c[2].y);
+        return agg::point_d(u * u * u * c[0].x + 3 * u * u * t * c[1].x +
+                            3 * u * t * t * c[2].x + t * t * t * c[3].x,
+                            u * u * u * c[0].y + 3 * u * u * t * c[1].y +
+                            3 * u * t * t * c[2].y + t * t * t * c[3].y);
+    }
+    
+    // Parameters in (0,1) where one coordinate of a Bezier curve with control
+    // values v[0..degree] has a zero derivative, returns how many
+    int
+    CurveExtrema(const double* v, int degree, double* ts)
+    {
+        int n = 0;
+        auto add = [&](double t) { if (t > 0.0 && t < 1.0) ts[n++] = t; };
+        if (degree == 2) {
+            // B'(t)/2 = (1 - t)(v1 - v0) + t(v2 - v1)
+            double denom = v[0] - 2 * v[1] + v[2];
+            if (denom != 0.0)
+                add((v[0] - v[1]) / denom);
+            return n;
+        }
+        // B'(t)/3 = a t^2 + b t + c
+        double d0 = v[1] - v[0], d1 = v[2] - v[1], d2 = v[3] - v[2];
+        double a = d0 - 2 * d1 + d2, b = 2 * (d1 - d0), c = d0;
+        if (fabs(a) < 1e-12 * (fabs(b) + fabs(c))) {
+            if (b != 0.0)
+                add(-c / b);
+            return n;
+        }
+        double disc = b * b - 4 * a * c;
+        if (disc < 0.0)
+            return n;
+        // the numerically stable form of the quadratic formula
+        double q = -0.5 * (b + (b < 0.0 ? -sqrt(disc) : sqrt(disc)));
+        add(q / a);
+        if (q != 0.0)
+            add(c / q);
+        return n;
+    }
+}
+
 pathIterator::pathIterator() 
 : curved(dummy), 
   curvedStroked(curved), curvedStrokedTrans(curvedStroked, unitTrans),
   curvedTrans(curved, unitTrans), curvedTransStroked(curvedTrans),
   curvedTransCentroid(curvedTrans), 
   curvedStrokedTransCentroid(curvedStrokedTrans),
-  curvedTransStrokedCentroid(curvedTransStroked)
+  curvedTransStrokedCentroid(curvedTransStroked),
+  flatTrans(flat, unitTrans), flatTransCentroid(flatTrans)
 { }
 
+// Points the flat vertex source at the cached flattening of the path command
+// under this transform. Returns false if the command can't be cached: paths
+// without a UID and constant width strokes under non-similar transforms.
+bool
+pathIterator::applyFlat(const AST::CommandInfo& attr,
+                        const agg::trans_affine& tr,
+                        double accuracy)
+{
+    AST::UIDdatatype uid = attr.mPathUID.load();
+    if (uid == 0 || uid == AST::CommandInfo::PathUIDDefault)
+        return false;
+    
+    double scale = sqrt(fabs(tr.determinant()));
+    double approx = accuracy * scale;
+    if (!(approx > 0.0) || !std::isfinite(approx))
+        return false;
+    
+    bool fill = attr.mFlags & AST::CF_FILL;
+    if (!fill && (attr.mFlags & AST::CF_ISO_WIDTH) && !isSimilarity(tr, scale))
+        return false;
+    
+    FlatKey key;
+    key.mPathUID = uid;
+    key.mIndex = attr.mIndex;
+    key.mScaleBucket = static_cast<int>(std::ceil(std::log2(approx) * ScaleBucketsPerOctave));
+    if (fill) {
+        key.mFlags = AST::CF_FILL;
+        key.mStrokeWidth = key.mMiterLimit = 0.0;
+    } else {
+        key.mFlags = attr.mFlags & (AST::CF_JOIN_MASK | AST::CF_CAP_MASK);
+        if (attr.mStrokeWidth * scale > 1.0)
+            key.mFlags |= CuspFlag;
+        key.mStrokeWidth = attr.mStrokeWidth;
+        key.mMiterLimit = attr.mMiterLimit;
+    }
+    
+    if (!mFlatPath || !(key == mFlatKey)) {
+        mFlatPath = TheFlatCache.get(key, *attr.mPath);
+        mFlatKey = key;
+    }
+    flat.attach(*mFlatPath);
+    flatTrans.transformer(tr);
+    return true;
+}
+
 void
 pathIterator::apply(const AST::CommandInfo& attr, 
                     const agg::trans_affine& tr, 
@@ -99,6 +348,11 @@ pathIterator::addPath<agg::rasterizer_scanline_aa<> >(agg::rasterizer_scanline_a
                                                       const agg::trans_affine& tr,
                                                       const AST::CommandInfo& attr)
 {
+    if (applyFlat(attr, tr, 1.0)) {
+        ras.add_path(flatTrans);
+        return;
+    }
+    
     apply(attr, tr, 1.0);
     
     if (attr.mFlags & AST::CF_FILL) {
@@ -112,6 +366,95 @@ pathIterator::addPath<agg::rasterizer_scanline_aa<> >(agg::rasterizer_scanline_a
     }
 }
 
+// Fills are bounded exactly: by their end points and by the points where a
+// curve turns in x or y. Their area is integrated exactly. Nothing is
+// flattened.
+bool
+pathIterator::fillBoundingRect(const agg::trans_affine& tr,
+                               const AST::CommandInfo& attr,
+                               double& minx, double& miny,
+                               double& maxx, double& maxy,
+                               agg::point_d* cent, double* area)
+{
+    agg::path_storage& path = *attr.mPath;
+    OutlineMoments moments;
+    agg::point_d c[4], start(0.0, 0.0), last(0.0, 0.0), sum(0.0, 0.0);
+    unsigned count = 0;
+    bool first = true;
+    auto include = [&](const agg::point_d& p) {
+        if (p.x < minx) minx = p.x;
+        if (p.y < miny) miny = p.y;
+        if (p.x > maxx) maxx = p.x;
+        if (p.y > maxy) maxy = p.y;
+    };
+    
+    path.rewind(attr.mIndex);
+    for (;;) {
+        unsigned cmd = path.vertex(&c[1].x, &c[1].y);
+        if (agg::is_stop(cmd))
+            break;
+        if (agg::is_end_poly(cmd)) {
+            if (!first)
+                moments.line(last, start);
+            first = true;
+            continue;
+        }
+        if (!agg::is_vertex(cmd))
+            continue;
+        
+        int points = 1;
+        if (agg::is_curve3(cmd) && !first) points = 2;
+        if (agg::is_curve4(cmd) && !first) points = 3;
+        for (int i = 2; i <= points; ++i)
+            path.vertex(&c[i].x, &c[i].y);
+        for (int i = 1; i <= points; ++i) {
+            tr.transform(&c[i].x, &c[i].y);
+            sum.x += c[i].x;
+            sum.y += c[i].y;
+        }
+        if (count == 0) {
+            minx = maxx = c[points].x;
+            miny = maxy = c[points].y;
+        } else {
+            include(c[points]);
+        }
+        count += points;
+        
+        if (first) {
+            start = last = c[1];
+            first = false;
+            continue;
+        }
+        c[0] = last;
+        if (points == 1) {
+            moments.line(last, c[1]);
+        } else {
+            // a transformed curve is the curve of the transformed points
+            double v[4], ts[2];
+            for (int axis = 0; axis < 2; ++axis) {
+                for (int i = 0; i <= points; ++i)
+                    v[i] = axis ? c[i].y : c[i].x;
+                for (int n = CurveExtrema(v, points, ts); n--; )
+                    include(CurvePoint(c, points, ts[n]));
+            }
+            moments.curve(c, points);
+        }
+        last = c[points];
+    }
+    
+    if (cent) {
+        if (fabs(moments.area2) < 2e-34) {
+            cent->x = count ? sum.x / count : 0.0;
+            cent->y = count ? sum.y / count : 0.0;
+        } else {
+            cent->x = moments.mx / (1.5 * moments.area2);
+            cent->y = moments.my / (1.5 * moments.area2);
+        }
+    }
+    if (area) *area = fabs(0.5 * moments.area2);
+    return count > 0;
+}
+
 bool
 pathIterator::boundingRect(const agg::trans_affine& tr, 
                            const AST::CommandInfo& attr,
@@ -119,24 +462,28 @@ pathIterator::boundingRect(const agg::trans_affine& tr,
                            double& maxx, double& maxy,
                            double scale, agg::point_d* cent, double* area)
 {
-    apply(attr, tr, scale * 0.1);
+    if (attr.mFlags & AST::CF_FILL)
+        return fillBoundingRect(tr, attr, minx, miny, maxx, maxy, cent, area);
     
     bool ret;
     
-    if (attr.mFlags & AST::CF_FILL) {
-        ret = agg::bounding_rect_single(curvedTransCentroid, attr.mIndex, &minx, &miny, &maxx, &maxy);
-        if (cent) *cent = curvedTransCentroid.m_centroid;
-        if (area) *area = curvedTransCentroid.m_area;
+    if (applyFlat(attr, tr, scale * 0.1)) {
+        ret = agg::bounding_rect_single(flatTransCentroid, 0, &minx, &miny, &maxx, &maxy);
+        if (cent) *cent = flatTransCentroid.m_centroid;
+        if (area) *area = flatTransCentroid.m_area;
+        return ret;
+    }
+    
+    apply(attr, tr, scale * 0.1);
+    
+    if (attr.mFlags & AST::CF_ISO_WIDTH) {
+        ret = agg::bounding_rect_single(curvedTransStrokedCentroid, attr.mIndex, &minx, &miny, &maxx, &maxy);
+        if (cent) *cent = curvedTransStrokedCentroid.m_centroid;
+        if (area) *area = curvedTransStrokedCentroid.m_area;
     } else {
-        if (attr.mFlags & AST::CF_ISO_WIDTH) {
-            ret = agg::bounding_rect_single(curvedTransStrokedCentroid, attr.mIndex, &minx, &miny, &maxx, &maxy);
-            if (cent) *cent = curvedTransStrokedCentroid.m_centroid;
-            if (area) *area = curvedTransStrokedCentroid.m_area;
-        } else {
-            ret = agg::bounding_rect_single(curvedStrokedTransCentroid, attr.mIndex, &minx, &miny, &maxx, &maxy);
-            if (cent) *cent = curvedStrokedTransCentroid.m_centroid;
-            if (area) *area = curvedStrokedTransCentroid.m_area;
-        }
+        ret = agg::bounding_rect_single(curvedStrokedTransCentroid, attr.mIndex, &minx, &miny, &maxx, &maxy);
+        if (cent) *cent = curvedStrokedTransCentroid.m_centroid;
+        if (area) *area = curvedStrokedTransCentroid.m_area;
     }
     return ret;
 }
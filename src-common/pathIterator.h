@@ -33,6 +33,9 @@
 #include "agg_trans_affine.h"
 #include "agg_path_storage.h"
 #include "agg_conv_centroid.h"
+#include "ast.h"
+#include <memory>
+#include <vector>
 
 namespace AST {
     struct CommandInfo;
@@ -40,6 +43,49 @@ namespace AST {
 
 class pathIterator {
 public:
+    // A path command flattened, and for strokes outlined, in path coordinates.
+    // These are cached and shared between drawing and bounds computation.
+    typedef std::vector<agg::vertex_d>  FlatPath;
+    
+    struct FlatKey {
+        AST::UIDdatatype    mPathUID;
+        unsigned            mIndex;
+        int                 mScaleBucket;
+        int                 mFlags;
+        double              mStrokeWidth;
+        double              mMiterLimit;
+        
+        bool operator==(const FlatKey& o) const
+        {
+            return mPathUID == o.mPathUID && mIndex == o.mIndex &&
+                   mScaleBucket == o.mScaleBucket && mFlags == o.mFlags &&
+                   mStrokeWidth == o.mStrokeWidth && mMiterLimit == o.mMiterLimit;
+        }
+    };
+    
+    class FlatSource {
+    public:
+        FlatSource() : mPath(nullptr), mPos(0) {}
+        void attach(const FlatPath& path) { mPath = &path; }
+        void rewind(unsigned) { mPos = 0; }
+        unsigned vertex(double* x, double* y)
+        {
+            if (mPos >= mPath->size())
+                return agg::path_cmd_stop;
+            const agg::vertex_d& v = (*mPath)[mPos++];
+            *x = v.x;
+            *y = v.y;
+            return v.cmd;
+        }
+    private:
+        const FlatPath* mPath;
+        std::size_t     mPos;
+    };
+    
+    typedef agg::conv_transform<FlatSource, const agg::trans_affine>
+                                                    FlatTrans;
+    typedef agg::conv_centroid<FlatTrans>           FlatTransCentroid;
+    
     typedef agg::conv_curve<agg::path_storage>      CurvedPath;
     typedef agg::conv_stroke<CurvedPath>            CurvedStroked;
     typedef agg::conv_transform<CurvedStroked, const agg::trans_affine>
@@ -62,6 +108,10 @@ public:
     CurvedTransCentroid         curvedTransCentroid;
     CurvedStrokedTransCentroid  curvedStrokedTransCentroid;
     CurvedTransStrokedCentroid  curvedTransStrokedCentroid;
+    
+    FlatSource          flat;
+    FlatTrans           flatTrans;
+    FlatTransCentroid   flatTransCentroid;
 
     pathIterator();
     ~pathIterator() = default;
@@ -74,6 +124,15 @@ public:
     bool boundingRect(const agg::trans_affine& tr, const AST::CommandInfo& attr,
                       double& minx, double& miny, double& maxx, double& maxy,
                       double scale, agg::point_d* cent = nullptr, double* area = nullptr);
+private:
+    FlatKey                         mFlatKey;
+    std::shared_ptr<const FlatPath> mFlatPath;
+    
+    bool applyFlat(const AST::CommandInfo& attr, const agg::trans_affine& tr,
+                   double accuracy);
+    bool fillBoundingRect(const agg::trans_affine& tr, const AST::CommandInfo& attr,
+                          double& minx, double& miny, double& maxx, double& maxy,
+                          agg::point_d* cent, double* area);
 };
 
 #endif
@@ -29,6 +29,7 @@
 #include <initializer_list>
 #include <utility>
 #include <cassert>
+#include <cmath>
 
 class primShape : public agg::path_storage
 {
@@ -43,8 +44,24 @@ public:
         for (++p; p != l.end(); ++p)
             line_to(p->first, p->second);
         end_poly(agg::path_flags_close);
+        
+        // Area and centroid of the polygon, for closed-form bounds
+        double area2 = 0.0, cx = 0.0, cy = 0.0;
+        auto prev = l.end() - 1;
+        for (auto q = l.begin(); q != l.end(); prev = q++) {
+            double term = prev->first * q->second - q->first * prev->second;
+            area2 += term;
+            cx += (prev->first + q->first) * term;
+            cy += (prev->second + q->second) * term;
+        }
+        mArea = fabs(area2 * 0.5);
+        mCentroid.x = cx / (3.0 * area2);
+        mCentroid.y = cy / (3.0 * area2);
     }
-    primShape() = default;
+    primShape() : mArea(0.0) { }
+    
+    double mArea;                   // area of the untransformed shape
+    agg::point_d mCentroid;         // centroid of the untransformed shape
     
     static const primShape circle;
     static const primShape square;
@@ -0,0 +1,178 @@
+// readAhead.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+#include "readAhead.h"
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace {
+    // The I/O threads are started on first use and run until exit
+    class IOPool {
+    public:
+        typedef std::function<void()> job_t;
+        
+        static IOPool& Get()
+        {
+            static IOPool pool;
+            return pool;
+        }
+        
+        void submit(job_t&& job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mJobs.push_back(std::move(job));
+                if (mThreads.size() < ReadAheadStream::IOThreads &&
+                    mThreads.size() <= mBusy)
+                {
+                    mThreads.emplace_back(&IOPool::run, this);
+                }
+            }
+            mCond.notify_one();
+        }
+        
+        ~IOPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+            }
+            mCond.notify_all();
+            for (std::thread& t: mThreads)
+                t.join();
+        }
+    private:
+        IOPool() : mBusy(0), mStop(false) { }
+        
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            for (;;) {
+                mCond.wait(lock, [this]{ return mStop || !mJobs.empty(); });
+                if (mJobs.empty())
+                    return;
+                job_t job = std::move(mJobs.front());
+                mJobs.pop_front();
+                ++mBusy;
+                lock.unlock();
+                job();
+                lock.lock();
+                --mBusy;
+            }
+        }
+        
+        std::mutex                  mMutex;
+        std::condition_variable     mCond;
+        std::deque<job_t>           mJobs;
+        std::vector<std::thread>    mThreads;
+        std::size_t                 mBusy;
+        bool                        mStop;
+    };
+}
+
+// Double-buffered: the get area is the current chunk while the next chunk
+// is filled from the source by an I/O thread.
+class ReadAheadStream::Buffer : public std::streambuf {
+public:
+    explicit Buffer(std::istream* source)
+    : mSource(source), mCurrent(ChunkSize), mNext(ChunkSize),
+      mNextCount(0), mPending(false), mAtEnd(false)
+    {
+        schedule();
+    }
+    
+    ~Buffer() override
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [this]{ return !mPending; });
+    }
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+        
+        std::size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDone.wait(lock, [this]{ return !mPending; });
+            count = mNextCount;
+            mNextCount = 0;
+        }
+        if (count == 0)
+            return traits_type::eof();
+        mCurrent.swap(mNext);
+        setg(mCurrent.data(), mCurrent.data(), mCurrent.data() + count);
+        if (!mAtEnd)
+            schedule();
+        return traits_type::to_int_type(*gptr());
+    }
+private:
+    void schedule()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPending = true;
+        }
+        IOPool::Get().submit([this]{ fill(); });
+    }
+    
+    void fill()
+    {
+        std::size_t count = 0;
+        if (mSource && *mSource) {
+            mSource->read(mNext.data(), static_cast<std::streamsize>(mNext.size()));
+            count = static_cast<std::size_t>(mSource->gcount());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mNextCount = count;
+            mAtEnd = count < mNext.size();
+            mPending = false;
+        }
+        mDone.notify_all();
+    }
+    
+    std::unique_ptr<std::istream>   mSource;
+    std::vector<char>               mCurrent;
+    std::vector<char>               mNext;
+    std::size_t                     mNextCount;
+    std::mutex                      mMutex;
+    std::condition_variable         mDone;
+    bool                            mPending;
+    bool                            mAtEnd;
+};
+
+ReadAheadStream::ReadAheadStream(std::istream* source)
+: std::istream(nullptr), mBuffer(new Buffer(source))
+{
+    rdbuf(mBuffer.get());
+}
+
+ReadAheadStream::~ReadAheadStream() = default;
@@ -0,0 +1,53 @@
+// readAhead.h
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// An input stream that reads the stream it wraps ahead of the consumer.
+// Reads are done in large chunks on a small shared pool of I/O threads, so
+// that while one chunk is being consumed the next one is already being
+// read. Used for the temp files that are merged, where the merge would
+// otherwise wait on the disk for each file in turn.
+
+#ifndef INCLUDE_READAHEAD_H
+#define INCLUDE_READAHEAD_H
+
+#include <istream>
+#include <memory>
+
+class ReadAheadStream : public std::istream {
+public:
+    explicit ReadAheadStream(std::istream* source);
+        // takes ownership of source
+    ~ReadAheadStream() override;
+    
+    static const std::size_t ChunkSize = 256 * 1024;
+    static const unsigned    IOThreads = 4;
+private:
+    class Buffer;
+    std::unique_ptr<Buffer> mBuffer;
+    
+    ReadAheadStream(const ReadAheadStream&) = delete;
+    ReadAheadStream& operator=(const ReadAheadStream&) = delete;
+};
+
+#endif // INCLUDE_READAHEAD_H
@@ -31,10 +31,18 @@
 
 #include <iterator>
 #include <string>
+#include <sstream>
 #include <algorithm>
 #include <stack>
 #include <cassert>
 #include <functional>
+#include <climits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
 
 #ifdef _WIN32
 #include <float.h>
@@ -50,6 +58,7 @@
 #include "astreplacement.h"
 #include "CmdInfo.h"
 #include "tiledCanvas.h"
+#include "traceLog.h"
 
 using namespace std;
 using namespace AST;
@@ -58,19 +67,24 @@ using namespace AST;
 unsigned int RendererImpl::MoveFinishedAt = 0;     // when this many, move to file
 unsigned int RendererImpl::MoveUnfinishedAt = 0;   // when this many, move to files
 unsigned int RendererImpl::MaxMergeFiles = 0;      // maximum number of files to merge at once
+unsigned int RendererImpl::MergeFilesAt = 0;       // when this many, merge in the background
 
 const double SHAPE_BORDER = 1.0; // multiplier of shape size when calculating bounding box
 const double FIXED_BORDER = 8.0; // fixed extra border, in pixels
+const double SPLAT_AREA = 1.0;   // shapes smaller than this, in pixels, are splatted
+const double CIRCLE_BOUNDS = 1.0823922002923940;  // 1 / cos(pi/8), octagon to circle
 
 RendererImpl::RendererImpl(CFDGImpl* cfdg,
                             int width, int height, double minSize,
                             int variation, double border)
     : RendererAST(width, height), m_cfdg(cfdg), m_canvas(nullptr), mColorConflict(false), 
-      m_maxShapes(500000000), mVariation(variation), m_border(border), 
+      m_maxShapes(500000000), mOcclusionCulling(false), mPathCommand(0), mDrawCommand(-1),
+      mLevelOfDetail(false), mSplatCellSize(0.0), mSplatCount(0),
+      mPreview(nullptr), mPreviewInterval(0.0), mPreviewDrawn(0), mIndexedFrame(0),
+      mAccumulateFrames(false),
+      mVariation(variation), m_border(border), 
       mScaleArea(0.0), mScale(0.0), m_currScale(0.0), m_currArea(0.0), 
-      m_minSize(minSize), mFrameTimeBounds(1.0, -Renderer::Infinity, Renderer::Infinity),
-      circleCopy(primShape::circle), squareCopy(primShape::square), triangleCopy(primShape::triangle),
-      shapeMap{}
+      m_minSize(minSize), mFrameTimeBounds(1.0, -Renderer::Infinity, Renderer::Infinity)
 {
     if (MoveFinishedAt == 0) {
 #ifndef DEBUG_SIZES
@@ -78,18 +92,20 @@ RendererImpl::RendererImpl(CFDGImpl* cfdg,
         if (mem == 0) {
             MoveFinishedAt = MoveUnfinishedAt = 2000000;
         } else {
-            MoveFinishedAt = MoveUnfinishedAt = static_cast<unsigned int>(mem / (sizeof(FinishedShape) * 4));
+            MoveFinishedAt = static_cast<unsigned int>(mem / (sizeof(FinishedShape) * 4));
+            MoveUnfinishedAt = static_cast<unsigned int>(mem / (sizeof(Shape) * 4));
         }
         MaxMergeFiles      =      200; // maximum number of files to merge at once
+        MergeFilesAt       =       16; // when this many, merge in the background
 #else
         MoveFinishedAt     =    1000; // when this many, move to file
         MoveUnfinishedAt   =     200; // when this many, move to files
         MaxMergeFiles      =       4; // maximum number of files to merge at once
+        MergeFilesAt       =       3; // when this many, merge in the background
 #endif
     }
     
     mCFstack.reserve(8000);
-    shapeMap = { { CommandInfo(&circleCopy), CommandInfo(&squareCopy), CommandInfo(&triangleCopy)} };
 
     m_cfdg->hasParameter(CFG::FrameTime, mCurrentTime, nullptr);
     m_cfdg->hasParameter(CFG::Frame, mCurrentFrame, nullptr);
@@ -121,6 +137,7 @@ RendererImpl::init()
     
     mFinishedFileCount = 0;
     mUnfinishedFileCount = 0;
+    mPendingColors.clear();
     
     mFixedBorderX = mFixedBorderY = 0.0;
     mShapeBorder = 1.0;
@@ -216,9 +233,11 @@ class Stopped { };
 void
 RendererImpl::cleanup()
 {
-    // delete temp files before checking for abort
+    // stop the spill threads and delete temp files before checking for abort
+    mSpillWriter.abort();
+    mBackgroundMerge.abort();
     m_finishedFiles.clear();
-    m_unfinishedFiles.clear();
+    mSpilledExpansions.clear();
 
     try {
         std::function <void (const Shape& s)> releaseParam([](const Shape& s) {
@@ -227,7 +246,12 @@ RendererImpl::cleanup()
             s.releaseParams();
         });
         for_each(mUnfinishedShapes.begin(), mUnfinishedShapes.end(), releaseParam);
-        for_each(mFinishedShapes.begin(), mFinishedShapes.end(), releaseParam);
+        for_each(mSplatQueue.begin(), mSplatQueue.end(), releaseParam);
+        for (const FinishedShape& s: mFinishedShapes) {
+            if (Renderer::AbortEverything)
+                throw Stopped();
+            s.releaseParams();
+        }
     } catch (Stopped&) {
         return;
     } catch (exception& e) {
@@ -236,6 +260,12 @@ RendererImpl::cleanup()
     }
     mUnfinishedShapes.clear();
     mFinishedShapes.clear();
+    mPendingColors.clear();
+    mSplatQueue.clear();
+    mSplatLayers.clear();
+    mSplatCellSize = 0.0;
+    mSplatCount = 0;
+    mPreviewDrawn = 0;
     
     unwindStack(0, m_cfdg->mCFDGcontents.mParameters);
     
@@ -249,6 +279,25 @@ RendererImpl::setMaxShapes(int n)
     m_maxShapes = n ? n : 400000000;
 }
 
+void
+RendererImpl::setOcclusionCulling(bool cull)
+{
+    mOcclusionCulling = cull;
+}
+
+void
+RendererImpl::setLevelOfDetail(bool splat)
+{
+    mLevelOfDetail = splat;
+}
+
+void
+RendererImpl::setPreview(Canvas* preview, double interval)
+{
+    mPreview = preview;
+    mPreviewInterval = std::chrono::duration<double>(interval);
+}
+
 void
 RendererImpl::resetBounds()
 {
@@ -293,6 +342,14 @@ RendererImpl::run(Canvas * canvas, bool partialDraw)
         outputPrep(canvas);
     
     int reportAt = 250;
+    unsigned expansions = 0;
+    TraceLog::Span expandTrace("expand", "expand");
+
+    if (mPreview) {
+        mPreviewFrame.invalidate();
+        mPreviewAt = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(mPreviewInterval);
+    }
 
     Shape initShape = m_cfdg->getInitialShape(this);
     initShape.mWorldState.mRand64Seed = mCurrentSeed;
@@ -315,14 +372,22 @@ RendererImpl::run(Canvas * canvas, bool partialDraw)
         if (requestStop) break;
         if (requestFinishUp) break;
         
-        if (mUnfinishedShapes.empty()) break;
+        if (mUnfinishedShapes.empty() && mSplatQueue.empty()) break;
         if ((m_stats.shapeCount + m_stats.toDoCount) > m_maxShapes)
             break;
 
-        // Get the largest unfinished shape
-        Shape s = mUnfinishedShapes.front();
-        pop_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end());
-        mUnfinishedShapes.pop_back();
+        Shape s;
+        if (!mSplatQueue.empty()) {
+            // Rules too small to matter for the order of expansion go
+            // depth first, which keeps the queue short
+            s = std::move(mSplatQueue.back());
+            mSplatQueue.pop_back();
+        } else {
+            // Get the largest unfinished shape
+            s = mUnfinishedShapes.front();
+            pop_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end());
+            mUnfinishedShapes.pop_back();
+        }
         m_stats.toDoCount--;
         
         try {
@@ -339,6 +404,17 @@ RendererImpl::run(Canvas * canvas, bool partialDraw)
             break;
         }
         
+        ++expansions;
+        if (mPreview && (expansions & 0xfff) == 0 &&
+            std::chrono::steady_clock::now() >= mPreviewAt)
+            outputPreview();
+        
+        if (TraceLog::Enabled && (expansions & 0xffff) == 0) {
+            expandTrace.next("expansions", 65536.0);
+            TraceLog::Counter("shapes", "finished", m_stats.shapeCount);
+            TraceLog::Counter("expansions", "to do", m_stats.toDoCount);
+        }
+        
         if (requestUpdate || (m_stats.shapeCount > reportAt)) {
             if (partialDraw)
               outputPartial();
@@ -346,6 +422,10 @@ RendererImpl::run(Canvas * canvas, bool partialDraw)
             reportAt = 2 * m_stats.shapeCount;
         }
     }
+    expandTrace.next("expansions", expansions & 0xffff);
+    TraceLog::Counter("shapes", "finished", m_stats.shapeCount);
+    if (mSplatCount)
+        TraceLog::Counter("shapes", "splatted", mSplatCount);
     
     if (!m_cfdg->usesTime && !m_timed) 
         mTimeBounds.load_from(1.0, 0.0, mTotalArea);
@@ -423,10 +503,10 @@ OutputBounds::apply(const FinishedShape& s)
     if (mScale == 0.0) {
         // If we don't know the approximate scale yet then just
         // make an educated guess.
-        mScale = (mWidth + mHeight) / sqrt(fabs(s.mWorldState.m_transform.determinant()));
+        mScale = (mWidth + mHeight) / sqrt(fabs(s.mTransform.determinant()));
     }
     
-    agg::trans_affine_time frameTime(s.mWorldState.m_time);
+    agg::trans_affine_time frameTime(s.mTime);
     frameTime.translate(-mTimeBounds.tbegin);
     frameTime.scale(mFrameScale);
     int begin = (frameTime.tbegin < mFrames) ? static_cast<int>(floor(frameTime.tbegin)) : (mFrames - 1);
@@ -511,6 +591,7 @@ RendererImpl::animate(Canvas* canvas, int frames, bool zoom)
     
     const bool ftime = m_cfdg->usesFrameTime;
     zoom = zoom && !ftime;
+    int shapes = m_stats.shapeCount;
     if (ftime)
         cleanup();
 
@@ -527,20 +608,26 @@ RendererImpl::animate(Canvas* canvas, int frames, bool zoom)
     double frameInc = (mTimeBounds.tend - mTimeBounds.tbegin) / frames;
     
     OutputBounds outputBounds(frames, mTimeBounds, curr_width, curr_height, *this);
-    if (zoom) {
-        system()->message("Computing zoom");
+    if (!ftime) {
+        if (zoom)
+            system()->message("Computing zoom");
 
         try {
-            forEachShape(true, [&](const FinishedShape& s) {
-                outputBounds.apply(s);
+            indexFrames(frames, [&](const FinishedShape& s) {
+                if (zoom)
+                    outputBounds.apply(s);
             });
             //outputBounds.finalAccumulate();
-            outputBounds.backwardFilter(10.0);
+            if (zoom)
+                outputBounds.backwardFilter(10.0);
             //outputBounds.smooth(3);
+            mAccumulateFrames = !zoom && mFrameIndex.accumulates();
         } catch (Stopped&) {
+            mFrameIndex.clear();
             m_stats.animating = false;
             return;
         } catch (exception& e) {
+            mFrameIndex.clear();
             system()->catastrophicError(e.what());
             return;
         }
@@ -551,9 +638,14 @@ RendererImpl::animate(Canvas* canvas, int frames, bool zoom)
     mFrameTimeBounds.tend = mTimeBounds.tbegin;
     
     Bounds saveBounds = mBounds;
+    
+    bool parallel = ftime ? expandFramesInParallel(frames, shapes)
+                          : animateInParallel(frames, outputBounds, zoom);
 
-    for (int frameCount = 1; frameCount <= frames; ++frameCount)
+    for (int frameCount = 1; !parallel && frameCount <= frames; ++frameCount)
     {
+        TraceLog::Scope trace("frame", "animate");
+        trace.arg("frame", frameCount);
         system()->message("Generating frame %d of %d", frameCount, frames);
         
         if (zoom) mBounds = outputBounds.frameBounds(frameCount - 1);
@@ -577,7 +669,9 @@ RendererImpl::animate(Canvas* canvas, int frames, bool zoom)
             run(canvas, false);
             m_canvas = canvas;
         } else {
+            mIndexedFrame = frameCount;
             outputFinal();
+            mIndexedFrame = 0;
             outputStats();
         }
         
@@ -587,6 +681,8 @@ RendererImpl::animate(Canvas* canvas, int frames, bool zoom)
         if (requestStop || requestFinishUp) break;
     }
 
+    mFrameIndex.clear();
+    mAccumulateFrames = false;
     mBounds = saveBounds;
     m_stats.animating = false;
     outputStats();
@@ -616,8 +712,12 @@ RendererImpl::processShape(const Shape& s)
         // only add it if it's big enough (or if there are no finished shapes yet)
         if (!mBounds.valid() || (area * mScaleArea >= m_minArea)) {
             m_stats.toDoCount++;
-            mUnfinishedShapes.push_back(s);
-            push_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end());
+            if (splatting() && mBounds.valid() && area * mScaleArea < SPLAT_AREA) {
+                mSplatQueue.push_back(s);
+            } else {
+                mUnfinishedShapes.push_back(s);
+                push_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end());
+            }
         } else {
             s.releaseParams();
         }
@@ -667,10 +767,13 @@ RendererImpl::processPrimShapeSiblings(const Shape& s, const ASTrule* path)
         if (path) {
             mOpsOnly = false;
             path->traversePath(s, this);
-        } else {
-            CommandInfo* attr = nullptr;
-            if (s.mShapeType < 3) attr = &(shapeMap[s.mShapeType]);
-            processPathCommand(s, attr);
+        } else if (primShape::isPrimShape(s.mShapeType)) {
+            // Primitive shapes have closed-form bounds, area and centroid
+            double area = 0.0;
+            agg::point_d cent(0.0, 0.0);
+            mPathBounds.update(s.mWorldState.m_transform,
+                               *primShape::shapeMap[s.mShapeType], &cent, &area);
+            addPathArea(cent, area);
         }
         mTotalArea += mCurrentArea;
         if (!m_tiled && !m_sized) {
@@ -686,41 +789,81 @@ RendererImpl::processPrimShapeSiblings(const Shape& s, const ASTrule* path)
     } else {
         mCurrentArea = 1.0;
     }
-    FinishedShape fs(s, m_stats.shapeCount, mPathBounds);
-    fs.mWorldState.m_Z.sz = mCurrentArea;
+    // Splatted primitives were counted above, so the shape limit covers them
+    if (!path && s.mShapeType != primShape::fillType && splatting() &&
+        mCurrentArea * mScaleArea < SPLAT_AREA && s.mWorldState.isFinite())
+    {
+        splatPrimitive(s);
+        return;
+    }
+    FinishedShape fs(s, m_stats.shapeCount, mPathBounds, path != nullptr);
+    fs.mZ.sz = mCurrentArea;
     if (!m_cfdg->usesTime) {
-        fs.mWorldState.m_time.tbegin = mTotalArea;
-        fs.mWorldState.m_time.tend = Renderer::Infinity;
+        fs.mTime.tbegin = mTotalArea;
+        fs.mTime.tend = Renderer::Infinity;
     }
-    if (fs.mWorldState.m_time.tbegin < mTimeBounds.tbegin &&
-        isfinite(fs.mWorldState.m_time.tbegin) && !m_timed)
+    if (fs.mTime.tbegin < mTimeBounds.tbegin &&
+        isfinite(fs.mTime.tbegin) && !m_timed)
     {
-        mTimeBounds.tbegin = fs.mWorldState.m_time.tbegin;
+        mTimeBounds.tbegin = fs.mTime.tbegin;
     }
-    if (fs.mWorldState.m_time.tbegin > mTimeBounds.tend &&
-        isfinite(fs.mWorldState.m_time.tbegin) && !m_timed)
+    if (fs.mTime.tbegin > mTimeBounds.tend &&
+        isfinite(fs.mTime.tbegin) && !m_timed)
     {
-        mTimeBounds.tend = fs.mWorldState.m_time.tbegin;
+        mTimeBounds.tend = fs.mTime.tbegin;
     }
-    if (fs.mWorldState.m_time.tend > mTimeBounds.tend &&
-        isfinite(fs.mWorldState.m_time.tend) && !m_timed)
+    if (fs.mTime.tend > mTimeBounds.tend &&
+        isfinite(fs.mTime.tend) && !m_timed)
     {
-        mTimeBounds.tend = fs.mWorldState.m_time.tend;
+        mTimeBounds.tend = fs.mTime.tend;
     }
-    if (fs.mWorldState.m_time.tend < mTimeBounds.tbegin &&
-        isfinite(fs.mWorldState.m_time.tend) && !m_timed)
+    if (fs.mTime.tend < mTimeBounds.tbegin &&
+        isfinite(fs.mTime.tend) && !m_timed)
     {
-        mTimeBounds.tbegin = fs.mWorldState.m_time.tend;
+        mTimeBounds.tbegin = fs.mTime.tend;
     }
-    if (!fs.mWorldState.isFinite()) {
+    if (!s.mWorldState.isFinite()) {
         requestStop = true;
         system()->error();
         system()->message("A shape got too big.");
         return;
     }
     mFinishedShapes.push_back(fs);
-    if (fs.mParameters)
-        fs.mParameters->retain(this);
+    mPendingColors.push_back(s.mWorldState.m_Color);
+    if (mPendingColors.size() == ColorBatch)
+        colorFinishedShapes();
+    // Only paths need their parameters when they are drawn
+    if (path && s.mParameters)
+        s.mParameters->retain(this);
+}
+
+// Accumulates a primitive smaller than a pixel into the cell of the splat
+// grid that holds its center. The grid is in world coordinates, with cells a
+// pixel across at the scale when the first primitive is splatted. The scale
+// only shrinks as the design grows, so cells never get larger than a pixel.
+void
+RendererImpl::splatPrimitive(const Shape& s)
+{
+    if (mSplatCellSize == 0.0)
+        mSplatCellSize = 1.0 / mScale;
+    
+    const agg::trans_affine& tr = s.mWorldState.m_transform;
+    double x = floor(tr.tx / mSplatCellSize);
+    double y = floor(tr.ty / mSplatCellSize);
+    if (!(fabs(x) < INT_MAX && fabs(y) < INT_MAX))
+        return;
+    std::uint64_t key = static_cast<std::uint64_t>(static_cast<std::uint32_t>(static_cast<int>(x))) << 32 |
+                        static_cast<std::uint32_t>(static_cast<int>(y));
+    
+    RGBA8 color = m_cfdg->getColor(s.mWorldState.m_Color);
+    double coverage = mCurrentArea / (mSplatCellSize * mSplatCellSize);
+    float w = static_cast<float>(std::min(coverage, 1.0) * color.a / RGBA8::base_mask);
+    SplatCell& cell = mSplatLayers[s.mWorldState.m_Z.tz][key];
+    cell.r = w * color.r / RGBA8::base_mask + cell.r * (1.0f - w);
+    cell.g = w * color.g / RGBA8::base_mask + cell.g * (1.0f - w);
+    cell.b = w * color.b / RGBA8::base_mask + cell.b * (1.0f - w);
+    cell.a = w + cell.a * (1.0f - w);
+    ++mSplatCount;
 }
 
 void
@@ -752,136 +895,104 @@ RendererImpl::fileIfNecessary()
 {
     if (mFinishedShapes.size() > MoveFinishedAt)
         moveFinishedToFile();
+    mergeInBackground();
 
+    // Expand strictly largest first: bring back the largest spilled shapes
+    // as soon as they are larger than the largest in memory
     if (mUnfinishedShapes.size() > MoveUnfinishedAt)
-        moveUnfinishedToTwoFiles();
-    else if (mUnfinishedShapes.empty())
+        moveUnfinishedToFile();
+    else if (!mSpilledExpansions.empty() && (mUnfinishedShapes.empty() ||
+             mUnfinishedShapes.front().area() < mSpilledExpansions.maxArea()))
         getUnfinishedFromFile();
 }
 
 void
-RendererImpl::moveUnfinishedToTwoFiles()
+RendererImpl::moveUnfinishedToFile()
 {
-    m_unfinishedFiles.emplace_back(system(), AbstractSystem::ExpensionTemp,
-                                   "expansion", ++mUnfinishedFileCount);
-    unique_ptr<ostream> f1(m_unfinishedFiles.back().forWrite());
-    int num1 = m_unfinishedFiles.back().number();
-
-    m_unfinishedFiles.emplace_back(system(), AbstractSystem::ExpensionTemp,
-                                   "expansion", ++mUnfinishedFileCount);
-    unique_ptr<ostream> f2(m_unfinishedFiles.back().forWrite());
-    int num2 = m_unfinishedFiles.back().number();
+    TraceLog::Scope trace("moveUnfinishedToFile", "spill");
+    trace.arg("shapes", mUnfinishedShapes.size());
     
-    system()->message("Writing %s temp files %d & %d",
-                      m_unfinishedFiles.back().type().c_str(), num1, num2);
-
+    // Keep the largest third in memory and write the rest as a run sorted
+    // largest first. Everything in memory is at least as large as anything
+    // that was spilled.
     size_t count = mUnfinishedShapes.size() / 3;
-
-    UnfinishedContainer::iterator usi = mUnfinishedShapes.begin(),
-                                  use = mUnfinishedShapes.end();
-    usi += count;
-    
-	if (f1->good() && f2->good()) {
-        AbstractSystem::Stats outStats = m_stats;
-        outStats.outputCount = static_cast<int>(count);
-        outStats.outputDone = 0;
-        *f1 << outStats.outputCount;
-        *f2 << outStats.outputCount;
-        outStats.outputCount = static_cast<int>(count * 2);
-        outStats.showProgress = true;
-		// Split the bottom 2/3 of the heap between the two files
-		while (usi != use) {
-			usi->write(*((m_unfinishedInFilesCount & 1) ? f1 : f2));
-			++usi;
-			++m_unfinishedInFilesCount;
-            ++outStats.outputDone;
-            if (requestUpdate) {
-                system()->stats(outStats);
-                requestUpdate = false;
-            }
-            if (requestStop || requestFinishUp)
-                return;
-		}
-	} else {
-		system()->message("Cannot open temporary file for expansions");
-        requestStop = true;
-        return;
-	}
-
-    // Remove the written shapes, heap property remains intact
+    auto first = mUnfinishedShapes.begin();
+    auto mid = first + count;
+    auto last = mUnfinishedShapes.end();
+    auto largerArea = [](const Shape& a, const Shape& b) { return b < a; };
+    nth_element(first, mid, last, largerArea);
+    sort(mid, last, largerArea);
+    
+    // Segments of an eighth of the in-memory limit let the reads below fill
+    // most of the limit without going over it
+    AbstractSystem::Stats outStats = m_stats;
+    outStats.outputCount = static_cast<int>(last - mid);
+    auto written = last;
+    bool ok = mSpilledExpansions.write(mid, written,
+                                       TempFile(system(), AbstractSystem::ExpensionTemp,
+                                                "expansion", ++mUnfinishedFileCount),
+                                       max(MoveUnfinishedAt / 8, 1u), spillProgress(outStats));
+
+    // Remove the written shapes, their parameters were released by the write
     static const Shape neverActuallyUsed;
-    mUnfinishedShapes.resize(count, neverActuallyUsed);
-    assert(is_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end()));
+    if (written != last) {
+        // Stopped part way, the heap is not needed any more
+        auto end = move(written, last, mid);
+        mUnfinishedShapes.resize(end - first, neverActuallyUsed);
+    } else {
+        mUnfinishedShapes.resize(count, neverActuallyUsed);
+        fixupHeap();
+    }
+    
+    if (!ok) {
+        system()->message("Cannot write temporary file for expansions");
+        requestStop = true;
+    }
 }
 
 void
 RendererImpl::getUnfinishedFromFile()
 {
-    if (m_unfinishedFiles.empty()) return;
-    
-    TempFile t(std::move(m_unfinishedFiles.front()));
-    m_unfinishedFiles.pop_front();
-    
-    unique_ptr<istream> f(t.forRead());
-
-    if (f->good()) {
-        AbstractSystem::Stats outStats = m_stats;
-        *f >> outStats.outputCount;
-        outStats.outputDone = 0;
-        outStats.showProgress = true;
-        istream_iterator<Shape> it(*f);
-        istream_iterator<Shape> eit;
-        back_insert_iterator< UnfinishedContainer > sendto(mUnfinishedShapes);
-        while (it != eit) {
-            *sendto = *it;
-            ++it;
-            ++outStats.outputDone;
-            if (requestUpdate) {
-                system()->stats(outStats);
-                requestUpdate = false;
-            }
-            if (requestStop || requestFinishUp)
-                return;
-        }
-	} else {
-		system()->message("Cannot open temporary file for expansions");
+    TraceLog::Scope trace("getUnfinishedFromFile", "spill");
+    // Fill up to the spill limit, so the shapes read back are not spilled
+    // again straight away
+    size_t limit = MoveUnfinishedAt - mUnfinishedShapes.size();
+    AbstractSystem::Stats outStats = m_stats;
+    outStats.outputCount = static_cast<int>(min(mSpilledExpansions.size(), limit));
+    if (!mSpilledExpansions.readLargest(mUnfinishedShapes, limit,
+                                        spillProgress(outStats)))
+    {
+        system()->message("Cannot read temporary file for expansions");
         requestStop = true;
         return;
     }
-    system()->message("Resorting expansions");
-    fixupHeap();
+    trace.arg("shapes", mUnfinishedShapes.size());
+    if (!requestStop && !requestFinishUp)
+        fixupHeap();
 }
 
-void
-RendererImpl::fixupHeap()
+SpilledExpansions::Progress
+RendererImpl::spillProgress(AbstractSystem::Stats& outStats)
 {
-    // Restore heap property to mUnfinishedShapes
-    auto first = mUnfinishedShapes.begin();
-    auto last = mUnfinishedShapes.end();
-    typedef UnfinishedContainer::iterator::difference_type difference_type;
-    difference_type n = last - first;
-    if (n < 2)
-        return;
-
-    AbstractSystem::Stats outStats = m_stats;
-    outStats.outputCount = static_cast<int>(n);
     outStats.outputDone = 0;
     outStats.showProgress = true;
-    
-    last = first;
-    ++last;
-    for (difference_type i = 1; i < n; ++i) {
-        push_heap(first, ++last);
-    
+    return [this, &outStats]() {
         ++outStats.outputDone;
         if (requestUpdate) {
             system()->stats(outStats);
             requestUpdate = false;
         }
-        if (requestStop || requestFinishUp)
-            return;
-    }
-    assert(is_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end()));
+        return !(requestStop || requestFinishUp);
+    };
+}
+
+void
+RendererImpl::fixupHeap()
+{
+    // Restore heap property to mUnfinishedShapes, in linear time
+    TraceLog::Scope trace("fixupHeap", "spill");
+    trace.arg("shapes", mUnfinishedShapes.size());
+    make_heap(mUnfinishedShapes.begin(), mUnfinishedShapes.end());
 }
 
 //-------------------------------------------------------------------------////
@@ -889,35 +1000,86 @@ RendererImpl::fixupHeap()
 void
 RendererImpl::moveFinishedToFile()
 {
+    // The preview can't get the shapes back from the file
+    drawPreview();
+    mPreviewDrawn = 0;
+    
+    TraceLog::Scope trace("moveFinishedToFile", "spill");
+    trace.arg("shapes", mFinishedShapes.size());
     m_finishedFiles.emplace_back(system(), AbstractSystem::ShapeTemp, "shapes", ++mFinishedFileCount);
     
     unique_ptr<ostream> f(m_finishedFiles.back().forWrite());
+    colorFinishedShapes();
 
 	if (f->good()) {
-        if (mFinishedShapes.size() > 10000)
-            system()->message("Sorting shapes...");
-        std::sort(mFinishedShapes.begin(), mFinishedShapes.end());
-        AbstractSystem::Stats outStats = m_stats;
-        outStats.outputCount = static_cast<int>(mFinishedShapes.size());
-        outStats.outputDone = 0;
-        outStats.showProgress = true;
-        for (const FinishedShape& fs: mFinishedShapes) {
-            *f << fs;
-            ++outStats.outputDone;
-            if (requestUpdate) {
-                system()->stats(outStats);
-                requestUpdate = false;
-            }
-            if (requestStop)
-                return;
+        // The spill writer sorts and writes the shapes on its own thread,
+        // expansion continues with an empty container
+        if (!mSpillWriter.write(mFinishedShapes, f.release())) {
+            system()->message("Cannot write temporary file for shapes");
+            requestStop = true;
         }
 	} else {
 		system()->message("Cannot open temporary file for shapes");
         requestStop = true;
-        return;
 	}
+}
 
-    mFinishedShapes.clear();
+void
+RendererImpl::colorFinishedShapes()
+{
+    // The colors of finished shapes are converted in batches, once however
+    // many times the shape is drawn
+    if (mPendingColors.empty())
+        return;
+    RGBA8 rgba[ColorBatch];
+    m_cfdg->getColors(mPendingColors.data(), rgba, mPendingColors.size());
+    FinishedContainer::iterator it = mFinishedShapes.end() - mPendingColors.size();
+    for (std::size_t i = 0; i < mPendingColors.size(); ++i, ++it)
+        it->mColor = rgba[i];
+    mPendingColors.clear();
+}
+
+void
+RendererImpl::mergeInBackground()
+{
+    if (mBackgroundMerge.busy()) {
+        if (!mBackgroundMerge.ready())
+            return;
+        // The newest shape file may still be in the spill writer, keep it
+        // at the end
+        if (!mBackgroundMerge.collect(m_finishedFiles, mSpillWriter.busy())) {
+            system()->message("Cannot merge temporary files for shapes");
+            requestStop = true;
+            return;
+        }
+    }
+    
+    size_t complete = m_finishedFiles.size() - (mSpillWriter.busy() ? 1 : 0);
+    if (m_finishedFiles.empty() || complete < MergeFilesAt)
+        return;
+    
+    size_t count = min(complete, static_cast<size_t>(MaxMergeFiles));
+    system()->message("Merging %d temp files in the background",
+                      static_cast<int>(count));
+    mBackgroundMerge.start(m_finishedFiles, count,
+                           TempFile(system(), AbstractSystem::MergeTemp, "merge",
+                                    ++mFinishedFileCount));
+}
+
+void
+RendererImpl::finishSpills()
+{
+    // Wait for the spill threads, the final merge needs all of the files
+    if (!mSpillWriter.wait()) {
+        system()->message("Cannot write temporary file for shapes");
+        requestStop = true;
+        throw Stopped();
+    }
+    if (!mBackgroundMerge.collect(m_finishedFiles, false)) {
+        system()->message("Cannot merge temporary files for shapes");
+        requestStop = true;
+        throw Stopped();
+    }
 }
 
 //-------------------------------------------------------------------------////
@@ -948,9 +1110,463 @@ void RendererImpl::rescaleOutput(int& curr_width, int& curr_height, bool final)
 }
 
 
+// Indexes the finished shapes by animation frame, passing each one to op on
+// the way. If there are temp files then all of the shapes are merged into the
+// index's own file once, instead of once per frame.
+void
+RendererImpl::indexFrames(int frames, ShapeFunction op)
+{
+    TraceLog::Scope trace("index frames", "animate");
+    colorFinishedShapes();
+    finishSpills();
+    bool ok = true;
+    if (m_finishedFiles.empty()) {
+        SortFinishedShapes(mFinishedShapes);
+        mFrameIndex.start(mTimeBounds, frames, mFinishedShapes);
+        for (const FinishedShape& s: mFinishedShapes) {
+            op(s);
+            mFrameIndex.add(s);
+        }
+    } else {
+        // Only shapes from files, so that the index owns the parameters
+        // that it writes
+        if (!mFinishedShapes.empty()) {
+            moveFinishedToFile();
+            finishSpills();
+        }
+        ok = mFrameIndex.start(mTimeBounds, frames,
+                               TempFile(system(), AbstractSystem::ShapeTemp, "frames",
+                                        ++mFinishedFileCount));
+        forEachShape(true, [&](const FinishedShape& s) {
+            op(s);
+            ok = mFrameIndex.add(s) && ok;
+        });
+    }
+    ok = mFrameIndex.finish() && ok;
+    trace.arg("accumulates", mFrameIndex.accumulates() ? 1.0 : 0.0);
+    if (!ok) {
+        system()->message("Cannot write temporary file for animation frames");
+        requestStop = true;
+        throw Stopped();
+    }
+}
+
+// Draws the frames of an indexed animation on as many threads as there are
+// cores, each frame into a canvas of the thread's own, and outputs them in
+// order. Primitives are drawn on the threads but path shapes go through the
+// rule's path cache and this renderer's path state, so they are drawn one at
+// a time. Returns false if the frames have to be drawn one at a time.
+bool
+RendererImpl::animateInParallel(int frames, OutputBounds& outputBounds, bool zoom)
+{
+    unsigned threads = std::min(std::thread::hardware_concurrency(),
+                                static_cast<unsigned>(frames));
+    if (threads < 2 || m_tiledCanvas)
+        return false;
+    
+    std::vector<std::unique_ptr<Canvas>> canvases;
+    for (unsigned i = 0; i < threads; ++i) {
+        canvases.push_back(m_canvas->makeFrameCanvas());
+        if (!canvases.back())
+            return false;
+    }
+    
+    TraceLog::Scope trace("parallel frames", "animate");
+    trace.arg("threads", threads);
+    
+    // The scale of each frame, as output() would compute it
+    struct Frame {
+        agg::trans_affine   trans;
+        double              area;
+        int                 width;
+        int                 height;
+    };
+    std::vector<Frame> frameScales(frames);
+    for (int frame = 0; frame < frames; ++frame) {
+        if (zoom) mBounds = outputBounds.frameBounds(frame);
+        Frame& f = frameScales[frame];
+        f.width = m_width;
+        f.height = m_height;
+        rescaleOutput(f.width, f.height, true);
+        f.trans = m_currTrans;
+        f.area = m_currArea;
+    }
+    
+    // Temp file streams are opened here because opening one sends a message
+    std::vector<std::unique_ptr<std::istream>> streams;
+    for (unsigned i = 0; i < threads; ++i)
+        streams.emplace_back(mFrameIndex.openForRead());
+    
+    Canvas* out = m_canvas;
+    const agg::rgba bk = m_cfdg->getBackgroundColor();
+    std::atomic<int> nextFrame(1);
+    std::atomic<bool> stopped(false);
+    std::mutex pathMutex;
+    std::mutex turnMutex;
+    std::condition_variable turn;
+    int nextOutput = 1;
+    std::string failure;        // what went wrong on a thread
+    std::atomic<bool> readFailed(false);
+    
+    m_drawingMode = true;
+    mDrawCommand = -1;
+    
+    auto fail = [&](const std::string& why) {
+        std::lock_guard<std::mutex> lock(turnMutex);
+        if (!stopped && failure.empty())
+            failure = why;
+        stopped = true;
+        turn.notify_all();
+    };
+    
+    auto worker = [&](unsigned thread) {
+        Canvas* canvas = canvases[thread].get();
+        int drawn = 0;      // the frame in the canvas
+        for (int frame; (frame = nextFrame++) <= frames; drawn = frame) {
+            const Frame& scale = frameScales[frame - 1];
+            int since = mAccumulateFrames ? drawn : 0;
+            canvas->start(since == 0, bk, scale.width, scale.height);
+            try {
+                bool ok = mFrameIndex.forFrame(frame, since, [&](const FinishedShape& s) {
+                    if (stopped || requestStop) throw Stopped();
+                    agg::trans_affine tr = s.mTransform;
+                    tr *= scale.trans;
+                    double a = s.mZ.sz * scale.area;
+                    if ((!isfinite(a) && s.mShapeType != primShape::fillType) ||
+                        a < m_minArea) return;
+                    if (m_cfdg->getShapeType(s.mShapeType) == CFDGImpl::pathType) {
+                        std::lock_guard<std::mutex> lock(pathMutex);
+                        m_canvas = canvas;
+                        m_currTrans = scale.trans;
+                        m_cfdg->findRule(s.mShapeType, 0.0)->traversePath(s.pathShape(), this);
+                    } else if (!drawPrimitive(canvas, s, tr)) {
+                        throw std::runtime_error("Non drawable shape with no rules: " +
+                                                 m_cfdg->decodeShapeName(s.mShapeType));
+                    }
+                }, streams[thread].get());
+                if (!ok) {
+                    readFailed = true;
+                    fail(std::string());
+                    return;
+                }
+            } catch (Stopped&) {
+                fail(std::string());
+                return;
+            } catch (exception& e) {
+                fail(e.what());
+                return;
+            }
+            canvas->end();
+            
+            std::unique_lock<std::mutex> lock(turnMutex);
+            turn.wait(lock, [&]() { return stopped || nextOutput == frame; });
+            if (stopped)
+                return;
+            system()->message("Generating frame %d of %d", frame, frames);
+            out->outputFrame(*canvas);
+            m_stats.shapeCount += outputBounds.frameCount(frame - 1);
+            m_stats.outputTime = out->mTime;
+            outputStats();
+            ++nextOutput;
+            if (requestStop || requestFinishUp)
+                stopped = true;
+            turn.notify_all();
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(worker, i);
+    for (std::thread& t: workers)
+        t.join();
+    
+    m_canvas = out;
+    if (readFailed) {
+        system()->message("Cannot read temporary file for animation frames");
+        requestStop = true;
+    } else if (!failure.empty()) {
+        system()->catastrophicError(failure.c_str());
+    }
+    return true;
+}
+
+namespace {
+    // The system of the renderers that expand frames on other threads. The
+    // calls are passed on one at a time, except for stats, which are
+    // reported for each frame as it is output, and the messages from
+    // parsing the design again.
+    class FrameSystem : public AbstractSystem {
+    public:
+        FrameSystem(AbstractSystem* sys, const std::map<std::string, std::string>& sources)
+        : mSystem(sys), mSources(sources), mQuiet(true) {}
+        
+        void message(const char* fmt, ...) override
+        {
+            if (mQuiet) return;
+            char buf[256];
+            va_list args;
+            va_start(args, fmt);
+            vsnprintf(buf, sizeof(buf), fmt, args);
+            va_end(args);
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSystem->message("%s", buf);
+        }
+        void syntaxError(const CfdgError& err) override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSystem->syntaxError(err);
+        }
+        bool error(bool errorOccurred) override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->error(errorOccurred);
+        }
+        void catastrophicError(const char* what) override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mSystem->catastrophicError(what);
+        }
+        std::istream* openFileForRead(const std::string& path) override
+        {
+            // The text that the design was parsed from, even if the files
+            // have changed since
+            auto source = mSources.find(path);
+            if (source != mSources.end())
+                return new std::istringstream(source->second, std::ios::binary);
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->openFileForRead(path);
+        }
+        std::istream* tempFileForRead(const std::string& path) override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->tempFileForRead(path);
+        }
+        std::ostream* tempFileForWrite(TempType tt, std::string& nameOut) override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->tempFileForWrite(tt, nameOut);
+        }
+        const char* tempFileDirectory() override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->tempFileDirectory();
+        }
+        std::vector<std::string> findTempFiles() override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->findTempFiles();
+        }
+        size_t getPhysicalMemory() override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->getPhysicalMemory();
+        }
+        std::string relativeFilePath(const std::string& base, const std::string& rel) override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mSystem->relativeFilePath(base, rel);
+        }
+        void orphan() override {}
+        void stats(const Stats&) override {}
+        
+        AbstractSystem*     mSystem;
+        const std::map<std::string, std::string>& mSources;
+        std::atomic<bool>   mQuiet;
+    private:
+        std::mutex          mMutex;
+    };
+    
+    // Invalid bounds are all the same
+    bool
+    sameBounds(const Bounds& a, const Bounds& b)
+    {
+        if (!a.valid() || !b.valid())
+            return a.valid() == b.valid();
+        return a.mMin_X == b.mMin_X && a.mMin_Y == b.mMin_Y &&
+               a.mMax_X == b.mMax_X && a.mMax_Y == b.mMax_Y;
+    }
+}
+
+// Expands the frames of a frame time animation on several threads, each with
+// a renderer of its own for a copy of the design, parsed again from the text
+// that the design was parsed from, and outputs them in order.
+// Each frame starts with the bounds that the frames before it ended with, so
+// a frame is started from the latest bounds that are known and expanded again
+// when its turn comes if they have grown since. There are as many threads as
+// there are cores, or fewer if the shapes of that many frames don't fit in
+// the memory that one renderer may use before it spills to temp files.
+// Returns false if the frames have to be expanded one at a time.
+bool
+RendererImpl::expandFramesInParallel(int frames, int shapes)
+{
+    std::size_t budget = static_cast<std::size_t>(MoveFinishedAt) * sizeof(FinishedShape) +
+                         static_cast<std::size_t>(MoveUnfinishedAt) * sizeof(Shape);
+    std::size_t frameSize =
+        2 * static_cast<std::size_t>(std::min(static_cast<unsigned>(shapes), MoveFinishedAt)) *
+            sizeof(FinishedShape) +
+        static_cast<std::size_t>(m_width) * m_height * 4;
+    std::size_t fit = budget / std::max<std::size_t>(frameSize, 1);
+    unsigned threads = static_cast<unsigned>(std::min<std::size_t>(fit,
+                                std::min(std::thread::hardware_concurrency(),
+                                         static_cast<unsigned>(frames))));
+    if (threads < 2 || m_tiledCanvas || m_cfdg->fileNames.empty() ||
+        !m_cfdg->mSources.count(m_cfdg->fileNames.front()))
+        return false;
+    
+    // Declared before the renderers, which use it until they are deleted
+    FrameSystem frameSystem(system(), m_cfdg->mSources);
+    std::vector<std::unique_ptr<RendererImpl>> renderers;
+    std::vector<std::unique_ptr<Canvas>> canvases;
+    for (unsigned i = 0; i < threads; ++i) {
+        std::unique_ptr<Canvas> canvas(m_canvas->makeFrameCanvas());
+        if (!canvas)
+            break;
+        CFDG* design = CFDG::ParseFile(m_cfdg->fileNames.front().c_str(),
+                                       &frameSystem, mVariation);
+        Renderer* r = design ? design->renderer(m_width, m_height, m_minSize,
+                                                mVariation, m_border) : nullptr;
+        if (!r)
+            break;
+        renderers.emplace_back(static_cast<RendererImpl*>(r));
+        renderers.back()->resetSize(m_width, m_height);
+        renderers.back()->m_maxShapes = m_maxShapes;
+        renderers.back()->mOcclusionCulling = mOcclusionCulling;
+        canvases.push_back(std::move(canvas));
+    }
+    frameSystem.mQuiet = false;
+    if (renderers.size() < 2)
+        return false;
+    threads = static_cast<unsigned>(renderers.size());
+    
+    TraceLog::Scope trace("parallel expansion", "animate");
+    trace.arg("threads", threads);
+    
+    struct FrameStart {
+        Bounds  bounds;
+        double  scale;
+        double  scaleArea;
+        
+        bool operator==(const FrameStart& o) const
+        {
+            return sameBounds(bounds, o.bounds) && scale == o.scale &&
+                   scaleArea == o.scaleArea;
+        }
+    };
+    FrameStart known = { mBounds, mScale, mScaleArea };     // where the next frame starts
+    double frameInc = (mTimeBounds.tend - mTimeBounds.tbegin) / frames;
+    
+    std::mutex turnMutex;
+    std::condition_variable turn;
+    int nextFrame = 1;
+    int nextOutput = 1;
+    unsigned running = threads;
+    bool stopped = false;
+    
+    // Expands and draws the frame, as the animation loop does
+    auto expand = [&](RendererImpl* r, Canvas* canvas, int frame, FrameStart& start) {
+        r->outputPrep(canvas);
+        r->m_stats.animating = true;
+        r->mFrameTimeBounds = mFrameTimeBounds;
+        r->mFrameTimeBounds.tbegin = mTimeBounds.tbegin + frameInc * (frame - 1);
+        r->mFrameTimeBounds.tend = mTimeBounds.tbegin + frameInc * frame;
+        r->mCurrentTime = (r->mFrameTimeBounds.tbegin + r->mFrameTimeBounds.tend) * 0.5;
+        r->mCurrentFrame = (frame - 1.0)/(frames - 1.0);
+        r->mBounds = start.bounds;
+        r->mScale = start.scale;
+        r->mScaleArea = start.scaleArea;
+        try {
+            r->init();
+        } catch (CfdgError& err) {
+            r->system()->syntaxError(err);
+            r->cleanup();
+            return false;
+        }
+        r->run(canvas, false);
+        start.bounds = r->mBounds;
+        start.scale = r->mScale;
+        start.scaleArea = r->mScaleArea;
+        r->cleanup();
+        return !r->requestStop;
+    };
+    
+    auto worker = [&](unsigned thread) {
+        RendererImpl* r = renderers[thread].get();
+        Canvas* canvas = canvases[thread].get();
+        std::unique_lock<std::mutex> lock(turnMutex);
+        while (!stopped && nextFrame <= frames) {
+            int frame = nextFrame++;
+            FrameStart start = known;
+            FrameStart end = start;
+            lock.unlock();
+            bool ok = expand(r, canvas, frame, end);
+            lock.lock();
+            turn.wait(lock, [&]() { return stopped || nextOutput == frame; });
+            if (ok && !stopped && !(start == known)) {
+                // The frames before it grew the bounds, it is its turn so
+                // nothing else can change them now
+                end = start = known;
+                lock.unlock();
+                ok = expand(r, canvas, frame, end);
+                lock.lock();
+            }
+            if (stopped)
+                break;
+            if (!ok) {
+                requestStop = true;
+                stopped = true;
+                break;
+            }
+            system()->message("Generating frame %d of %d", frame, frames);
+            m_canvas->outputFrame(*canvas);
+            known = end;
+            m_stats.shapeCount = r->m_stats.shapeCount;
+            m_stats.outputTime = m_canvas->mTime;
+            outputStats();
+            ++nextOutput;
+            if (requestStop || requestFinishUp)
+                stopped = true;
+            turn.notify_all();
+        }
+        --running;
+        turn.notify_all();
+    };
+    
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(worker, i);
+    
+    // Interrupts come to this renderer, pass them on
+    {
+        std::unique_lock<std::mutex> lock(turnMutex);
+        while (running) {
+            turn.wait_for(lock, std::chrono::milliseconds(100));
+            for (auto& r: renderers) {
+                if (requestStop || stopped) r->requestStop = true;
+                if (requestFinishUp) r->requestFinishUp = true;
+            }
+        }
+    }
+    for (std::thread& t: workers)
+        t.join();
+    return true;
+}
+
 void
 RendererImpl::forEachShape(bool final, ShapeFunction op)
 {
+    if (final && mIndexedFrame) {
+        int since = mAccumulateFrames ? mIndexedFrame - 1 : 0;
+        if (!mFrameIndex.forFrame(mIndexedFrame, since, op)) {
+            system()->message("Cannot read temporary file for animation frames");
+            requestStop = true;
+            throw Stopped();
+        }
+        return;
+    }
+    
+    if (final)
+        finishSpills();
+    
     if (!final || m_finishedFiles.empty()) {
         FinishedContainer::iterator start = mFinishedShapes.begin();
         FinishedContainer::iterator last  = mFinishedShapes.end();
@@ -965,6 +1581,8 @@ RendererImpl::forEachShape(bool final, ShapeFunction op)
             TempFile t(system(), AbstractSystem::MergeTemp, "merge", ++mFinishedFileCount);
             
             {
+                TraceLog::Scope trace("merge pass", "merge");
+                trace.arg("files", MaxMergeFiles);
                 OutputMerge merger;
                 
                 begin = m_finishedFiles.begin();
@@ -997,6 +1615,8 @@ RendererImpl::forEachShape(bool final, ShapeFunction op)
             merger.addTempFile(*it);
         
         merger.addShapes(mFinishedShapes.begin(), mFinishedShapes.end());
+        TraceLog::Scope trace("final merge", "merge");
+        trace.arg("files", m_finishedFiles.size());
         merger.merge(op);
     }
 }
@@ -1010,14 +1630,21 @@ RendererImpl::drawShape(const FinishedShape& s)
     if (requestUpdate)
         outputStats();
 
-    if (!s.mWorldState.m_time.overlaps(mFrameTimeBounds))
+    if (!s.mTime.overlaps(mFrameTimeBounds))
         return;
 
     m_stats.outputDone += 1;
+    drawFinished(s);
+}
 
-    agg::trans_affine tr = s.mWorldState.m_transform;
+// Draws a finished shape onto the current canvas, leaving the progress
+// checks and the output stats to the caller
+void
+RendererImpl::drawFinished(const FinishedShape& s)
+{
+    agg::trans_affine tr = s.mTransform;
     tr *= m_currTrans;
-    double a = s.mWorldState.m_Z.sz * m_currArea; //fabs(tr.determinant());
+    double a = s.mZ.sz * m_currArea; //fabs(tr.determinant());
     if ((!isfinite(a) && s.mShapeType != primShape::fillType) || 
         a < m_minArea) return;
     
@@ -1031,39 +1658,283 @@ RendererImpl::drawShape(const FinishedShape& s)
     if (m_cfdg->getShapeType(s.mShapeType) == CFDGImpl::pathType) {
         //mRenderer.m_canvas->path(s.mColor, tr, *s.mAttributes);
         const ASTrule* rule = m_cfdg->findRule(s.mShapeType, 0.0);
-        rule->traversePath(s, this);
-    } else {
-        RGBA8 color = m_cfdg->getColor(s.mWorldState.m_Color);
-        switch(s.mShapeType) {
-            case primShape::circleType:
-                m_canvas->circle(color, tr);
-                break;
-            case primShape::squareType:
-                m_canvas->square(color, tr);
-                break;
-            case primShape::triangleType:
-                m_canvas->triangle(color, tr);
-                break;
-            case primShape::fillType:
-                m_canvas->fill(color);
+        if (mDrawCommand < 0) {
+            rule->traversePath(s.pathShape(), this);
+        } else {
+            // Drawing under, so the path commands have to go last to first.
+            // Count them and then draw them one at a time.
+            mDrawCommand = INT_MAX;
+            mPathCommand = 0;
+            rule->traversePath(s.pathShape(), this);
+            for (mDrawCommand = mPathCommand - 1; mDrawCommand >= 0; --mDrawCommand) {
+                mPathCommand = 0;
+                rule->traversePath(s.pathShape(), this);
+            }
+            mDrawCommand = 0;
+        }
+    } else if (!drawPrimitive(m_canvas, s, tr)) {
+        system()->error();
+        system()->message("Non drawable shape with no rules: %s",
+            m_cfdg->decodeShapeName(s.mShapeType).c_str());
+        requestStop = true;
+        throw Stopped();
+    }
+}
+
+bool
+RendererImpl::drawPrimitive(Canvas* canvas, const FinishedShape& s,
+                            const agg::trans_affine& tr)
+{
+    const RGBA8& color = s.mColor;
+    switch(s.mShapeType) {
+        case primShape::circleType:
+            canvas->circle(color, tr);
+            return true;
+        case primShape::squareType:
+            canvas->square(color, tr);
+            return true;
+        case primShape::triangleType:
+            canvas->triangle(color, tr);
+            return true;
+        case primShape::fillType:
+            canvas->fill(color);
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+// Draws a splat grid, each cell as a spot of its average color with its
+// coverage as alpha
+void
+RendererImpl::drawSplats(const SplatGrid& grid)
+{
+    if (requestStop) throw Stopped();
+    TraceLog::Scope trace("splats", "draw");
+    trace.arg("cells", grid.size());
+    double area = mSplatCellSize * mSplatCellSize * m_currArea;
+    for (auto& splat: grid) {
+        const SplatCell& cell = splat.second;
+        if (!(cell.a > 0.0f))
+            continue;
+        double x = (static_cast<std::int32_t>(splat.first >> 32) + 0.5) * mSplatCellSize;
+        double y = (static_cast<std::int32_t>(splat.first & 0xffffffff) + 0.5) * mSplatCellSize;
+        m_currTrans.transform(&x, &y);
+        RGBA8 color(agg::rgba(cell.r / cell.a, cell.g / cell.a, cell.b / cell.a, 1.0));
+        m_canvas->splat(color, x, y, area, cell.a);
+    }
+    m_canvas->flushSplats();
+}
+
+// Draws the finished shapes that are new since the last time into the preview.
+// The frame of the preview has room for the design to grow; when it outgrows
+// it anyway the preview is moved into a larger frame, or started over with
+// the shapes still in memory if the canvas can't do that.
+void
+RendererImpl::drawPreview()
+{
+    if (!mPreview || !mBounds.valid() || mPreviewDrawn >= mFinishedShapes.size())
+        return;
+    
+    TraceLog::Scope trace("preview", "draw");
+    trace.arg("shapes", mFinishedShapes.size() - mPreviewDrawn);
+    
+    bool clear = false;
+    if (!mPreviewFrame.valid() ||
+        mBounds.mMin_X < mPreviewFrame.mMin_X || mBounds.mMax_X > mPreviewFrame.mMax_X ||
+        mBounds.mMin_Y < mPreviewFrame.mMin_Y || mBounds.mMax_Y > mPreviewFrame.mMax_Y)
+    {
+        Bounds frame = m_sized ? mBounds : (mPreviewFrame + mBounds).dilate(2.0);
+        int width = mPreview->mWidth;
+        int height = mPreview->mHeight;
+        agg::trans_affine trans;
+        frame.computeScale(width, height, 0.0, 0.0, false, &trans, true);
+        if (mPreviewFrame.valid()) {
+            agg::trans_affine move = mPreviewTrans;
+            move.invert();
+            move *= trans;
+            clear = !mPreview->reframe(move);
+        } else {
+            clear = true;
+        }
+        if (clear)
+            mPreviewDrawn = 0;
+        mPreviewFrame = frame;
+        mPreviewTrans = trans;
+    }
+    
+    mPreview->start(clear, m_cfdg->getBackgroundColor(),
+                    mPreview->mWidth, mPreview->mHeight);
+    colorFinishedShapes();
+    
+    Canvas* canvas = m_canvas;
+    agg::trans_affine currTrans = m_currTrans;
+    double currScale = m_currScale;
+    double currArea = m_currArea;
+    m_canvas = mPreview;
+    m_currTrans = mPreviewTrans;
+    m_currScale = mPreviewTrans.scale();
+    m_currArea = m_currScale * m_currScale;
+    m_drawingMode = true;
+    // The preview is not part of the output, so it doesn't count towards the
+    // output stats. If it is stopped part way then only the shapes it got to
+    // are drawn, the rest are drawn in the next preview.
+    std::size_t end = mFinishedShapes.size();
+    try {
+        for (; mPreviewDrawn < end; ++mPreviewDrawn) {
+            if (requestStop || (!mFinal && requestFinishUp))
                 break;
-            default:
-                system()->error();
-                system()->message("Non drawable shape with no rules: %s",
-                    m_cfdg->decodeShapeName(s.mShapeType).c_str());
-                requestStop = true;
-                throw Stopped();
+            const FinishedShape& s = *(mFinishedShapes.begin() + mPreviewDrawn);
+            if (s.mTime.overlaps(mFrameTimeBounds))
+                drawFinished(s);
         }
     }
+    catch (Stopped&) { }
+    m_drawingMode = false;
+    m_canvas = canvas;
+    m_currTrans = currTrans;
+    m_currScale = currScale;
+    m_currArea = currArea;
 }
 
+void
+RendererImpl::outputPreview()
+{
+    drawPreview();
+    if (mPreviewFrame.valid()) {
+        TraceLog::Scope trace("preview", "output");
+        mPreview->end();
+    }
+    mPreviewAt = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(mPreviewInterval);
+}
+
+// Draws the finished shapes from last to first, each one under the ones
+// already drawn, and skips the shapes that are completely hidden by them.
+void
+RendererImpl::drawOccluded()
+{
+    TraceLog::Scope trace("occlusion culling", "draw");
+    unsigned culled = 0;
+    mDrawCommand = 0;
+    for (auto it = mFinishedShapes.rbegin(), e = mFinishedShapes.rend(); it != e; ++it) {
+        if (occluded(*it)) {
+            if (requestStop) throw Stopped();
+            m_stats.outputDone += 1;
+            ++culled;
+        } else {
+            drawShape(*it);
+        }
+    }
+    mDrawCommand = -1;
+    m_outputSoFar = static_cast<int>(mFinishedShapes.size());
+    trace.arg("culled", culled);
+}
+
+bool
+RendererImpl::occluded(const FinishedShape& s)
+{
+    if (s.mShapeType == primShape::fillType)
+        return m_canvas->occluded(-Renderer::Infinity, -Renderer::Infinity,
+                                  Renderer::Infinity, Renderer::Infinity);
+    if (!s.mBounds.valid())
+        return false;
+    
+    double x1 = s.mBounds.mMin_X, y1 = s.mBounds.mMin_Y;
+    double x2 = s.mBounds.mMax_X, y2 = s.mBounds.mMax_Y;
+    m_currTrans.transform(&x1, &y1);
+    m_currTrans.transform(&x2, &y2);
+    return m_canvas->occluded(std::min(x1, x2), std::min(y1, y2),
+                              std::max(x1, x2), std::max(y1, y2));
+}
+
+// Draws the finished shapes into one band of the canvas at a time, each band
+// getting the shapes whose bounds overlap it. The shapes are indexed by band
+// first, in memory or, if there are temp files, in a temp file of their own
+// that is written in one merge and then read band by band.
+void
+RendererImpl::drawBands()
+{
+    TraceLog::Scope trace("bands", "draw");
+    int bands = m_canvas->bands();
+    trace.arg("bands", bands);
+    
+    finishSpills();
+    bool ok = true;
+    int first, last;
+    if (m_finishedFiles.empty()) {
+        mBandIndex.start(bands, mFinishedShapes);
+        for (const FinishedShape& s: mFinishedShapes) {
+            bandRange(s, first, last);
+            mBandIndex.add(s, first, last);
+        }
+    } else {
+        // Only shapes from files, so that the index owns the parameters
+        // that it writes
+        if (!mFinishedShapes.empty()) {
+            moveFinishedToFile();
+            finishSpills();
+        }
+        ok = mBandIndex.start(bands,
+                              TempFile(system(), AbstractSystem::ShapeTemp, "bands",
+                                       ++mFinishedFileCount), this);
+        forEachShape(true, [&](const FinishedShape& s) {
+            bandRange(s, first, last);
+            ok = mBandIndex.add(s, first, last) && ok;
+        });
+    }
+    ok = mBandIndex.finish() && ok;
+    m_stats.outputCount = static_cast<int>(mBandIndex.entries());
+    trace.arg("entries", mBandIndex.entries());
+    
+    for (int band = 0; ok && band < bands; ++band) {
+        m_canvas->startBand(band);
+        try {
+            ok = mBandIndex.forBand(band, [this](const FinishedShape& s) {
+                this->drawShape(s);
+            });
+        } catch (Stopped&) {
+            // What is drawn of the band so far still goes out
+            m_canvas->endBand(band);
+            mBandIndex.clear();
+            throw;
+        }
+        m_canvas->endBand(band);
+    }
+    mBandIndex.clear();
+    if (!ok) {
+        system()->message("Cannot use temporary file for output bands");
+        requestStop = true;
+        throw Stopped();
+    }
+}
+
+void
+RendererImpl::bandRange(const FinishedShape& s, int& first, int& last)
+{
+    if (s.mShapeType == primShape::fillType || !s.mBounds.valid()) {
+        first = 0;
+        last = m_canvas->bands() - 1;
+        return;
+    }
+    
+    // The bounds of a circle are the bounds of the octagon inside it
+    Bounds b = s.mShapeType == primShape::circleType ?
+               s.mBounds.dilate(CIRCLE_BOUNDS) : s.mBounds;
+    double x1 = b.mMin_X, y1 = b.mMin_Y;
+    double x2 = b.mMax_X, y2 = b.mMax_Y;
+    m_currTrans.transform(&x1, &y1);
+    m_currTrans.transform(&x2, &y2);
+    m_canvas->bandRange(std::min(y1, y2), std::max(y1, y2), first, last);
+}
 
 void RendererImpl::output(bool final)
 {
     if (!m_canvas)
         return;
         
-    if (!final &&  !m_finishedFiles.empty())
+    if (!final && (!m_finishedFiles.empty() || mBackgroundMerge.busy()))
         return; // don't do updates once we have temp files
         
     m_stats.inOutput = true;
@@ -1072,33 +1943,72 @@ void RendererImpl::output(bool final)
     m_stats.outputCount = m_stats.shapeCount;
     mFinal = final;
 
+    TraceLog::Scope trace(final ? "final output" : "partial output", "draw");
+    trace.arg("shapes", m_stats.shapeCount);
+
     int curr_width = m_width;
     int curr_height = m_height;
     rescaleOutput(curr_width, curr_height, final);
     
     m_stats.outputDone = m_outputSoFar;
     
-    if (final) {
+    colorFinishedShapes();
+    if (final && !mIndexedFrame) {
+        TraceLog::Scope trace("sort", "draw");
         if (mFinishedShapes.size() > 10000)
             system()->message("Sorting shapes...");
-        std::sort(mFinishedShapes.begin(), mFinishedShapes.end());
+        SortFinishedShapes(mFinishedShapes);
     }
     
-    m_canvas->start(m_outputSoFar == 0, m_cfdg->getBackgroundColor(),
+    // Frames of an accumulating animation are drawn over the previous frame
+    bool accumulated = mIndexedFrame > 1 && mAccumulateFrames;
+    m_canvas->start(m_outputSoFar == 0 && !accumulated, m_cfdg->getBackgroundColor(),
         curr_width, curr_height);
 
     m_drawingMode = true;
     //OutputDraw draw(*this, final);
+    
+    // Back to front drawing needs all of the shapes in memory, the merge of
+    // temporary files only goes forward
+    bool banded = final && !mIndexedFrame && m_canvas->bands() > 1;
+    // Splats are drawn between the z layers of the finished shapes, which
+    // back to front occlusion culling cannot do
+    bool splats = final && !mSplatLayers.empty();
+    bool under = final && mOcclusionCulling && !m_cfdg->usesAlpha && !m_tiledCanvas &&
+                 !mIndexedFrame && !banded && !splats;
     try {
-        forEachShape(final, [=](const FinishedShape& s) {
-            this->drawShape(s);
-        });
+        if (under) {
+            finishSpills();
+            under = m_finishedFiles.empty() && m_canvas->drawUnder(true);
+        }
+        if (banded)
+            drawBands();
+        else if (under)
+            drawOccluded();
+        else if (splats) {
+            auto layer = mSplatLayers.cbegin();
+            forEachShape(final, [&](const FinishedShape& s) {
+                for (; layer != mSplatLayers.cend() && layer->first < s.mZ.tz; ++layer)
+                    this->drawSplats(layer->second);
+                this->drawShape(s);
+            });
+            for (; layer != mSplatLayers.cend(); ++layer)
+                drawSplats(layer->second);
+            m_stats.outputDone += static_cast<int>(mSplatCount);
+        } else
+            forEachShape(final, [=](const FinishedShape& s) {
+                this->drawShape(s);
+            });
     }
     catch (Stopped&) { }
     catch (exception& e) {
         system()->catastrophicError(e.what());
     }
-
+    
+    if (under) {
+        mDrawCommand = -1;
+        m_canvas->drawUnder(false);
+    }
     m_canvas->end();
     m_stats.inOutput = false;
     m_stats.outputTime = m_canvas->mTime;
@@ -1116,7 +2026,7 @@ void
 RendererImpl::processPathCommand(const Shape& s, const AST::CommandInfo* attr)
 {
     if (m_drawingMode) {
-        if (m_canvas && attr) {
+        if (m_canvas && attr && (mDrawCommand < 0 || mPathCommand++ == mDrawCommand)) {
             RGBA8 color = m_cfdg->getColor(s.mWorldState.m_Color);
             agg::trans_affine tr = s.mWorldState.m_transform;
             tr *= m_currTrans;
@@ -1128,18 +2038,24 @@ RendererImpl::processPathCommand(const Shape& s, const AST::CommandInfo* attr)
             agg::point_d cent(0.0, 0.0);
             mPathBounds.update(s.mWorldState.m_transform, m_pathIter, mScale, *attr, 
                                &cent, &area);
-            mCurrentCentroid.x = (mCurrentCentroid.x * mCurrentArea + cent.x * area) /
-                                  (mCurrentArea + area);
-            mCurrentCentroid.y = (mCurrentCentroid.x * mCurrentArea + cent.y * area) /
-                                  (mCurrentArea + area);
-            mCurrentArea = mCurrentArea + area;
+            addPathArea(cent, area);
         }
     }
 }
 
+void
+RendererImpl::addPathArea(const agg::point_d& cent, double area)
+{
+    mCurrentCentroid.x = (mCurrentCentroid.x * mCurrentArea + cent.x * area) /
+                          (mCurrentArea + area);
+    mCurrentCentroid.y = (mCurrentCentroid.x * mCurrentArea + cent.y * area) /
+                          (mCurrentArea + area);
+    mCurrentArea = mCurrentArea + area;
+}
+
 void
 RendererImpl::storeParams(const StackRule* p)
 {
-    p->mRefCount = StackRule::MaxRefCount;
+    p->setRefCount(StackRule::MaxRefCount);
     m_cfdg->mLongLivedParams.push_back(p);
 }
@@ -36,7 +36,11 @@
 
 #include <deque>
 #include <set>
+#include <map>
 #include <array>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
 
 #include "agg_trans_affine.h"
 #include "agg_trans_affine_time.h"
@@ -46,11 +50,13 @@
 #include "shape.h"
 #include "tempfile.h"
 #include "shape.h"
+#include "shapeSTL.h"
 #include "CmdInfo.h"
 #include "pathIterator.h"
 #include "chunk_vector.h"
 
 class ShapeOp;
+class OutputBounds;
 namespace AST {
     class ASTbodyContainer;
     class ASTrule;
@@ -68,6 +74,9 @@ class RendererImpl : public RendererAST {
         virtual void storeParams(const StackRule* p);
     
         void setMaxShapes(int n);
+        void setOcclusionCulling(bool cull);
+        void setLevelOfDetail(bool splat);
+        void setPreview(Canvas* preview, double interval);
         void resetBounds();
         void resetSize(int x, int y);
         void initBounds();
@@ -76,16 +85,38 @@ class RendererImpl : public RendererAST {
         void draw(Canvas* canvas);
         void animate(Canvas* canvas, int frames, bool zoom);
         void processPathCommand(const Shape& s, const AST::CommandInfo* attr) override;
+        void addPathArea(const agg::point_d& cent, double area);
         void processShape(const Shape& s) override;
         void processPrimShape(const Shape& s, const AST::ASTrule* attr = nullptr) override;
         void processSubpath(const Shape& s, bool tr, int) override;
         
     private:
+        struct SplatCell {
+            float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;  // premultiplied
+        };
+        typedef std::unordered_map<std::uint64_t, SplatCell> SplatGrid;
+    
         void outputPrep(Canvas*);
         void rescaleOutput(int& curr_width, int& curr_height, bool final);
         void forEachShape(bool final, ShapeFunction op);
+        void indexFrames(int frames, ShapeFunction op);
+        bool animateInParallel(int frames, OutputBounds& outputBounds, bool zoom);
+        bool expandFramesInParallel(int frames, int shapes);
         void processPrimShapeSiblings(const Shape& s, const AST::ASTrule* attr);
         void drawShape(const FinishedShape& s);
+        void drawFinished(const FinishedShape& s);
+        static bool drawPrimitive(Canvas* canvas, const FinishedShape& s,
+                                  const agg::trans_affine& tr);
+        void drawOccluded();
+        bool occluded(const FinishedShape& s);
+        void drawBands();
+        void bandRange(const FinishedShape& s, int& first, int& last);
+        bool splatting() const
+        { return mLevelOfDetail && !m_tiled && !m_frieze && !m_cfdg->usesTime; }
+        void splatPrimitive(const Shape& s);
+        void drawSplats(const SplatGrid& grid);
+        void drawPreview();
+        void outputPreview();
 
         void output(bool final);
         void outputPartial() { output(false); }
@@ -99,10 +130,14 @@ class RendererImpl : public RendererAST {
         bool isDone();
         void fileIfNecessary();
         void moveFinishedToFile();
-        void moveUnfinishedToTwoFiles();
+        void colorFinishedShapes();
+        void mergeInBackground();
+        void finishSpills();
+        void moveUnfinishedToFile();
         void getUnfinishedFromFile();
         AbstractSystem* system() { return m_cfdg->system(); }
         void fixupHeap();
+        SpilledExpansions::Progress spillProgress(AbstractSystem::Stats& outStats);
     
         void init();
         void cleanup();
@@ -122,14 +157,45 @@ class RendererImpl : public RendererAST {
         double m_frieze_size;
         bool m_drawingMode;
         bool mFinal;
+        bool mOcclusionCulling;
+        int mPathCommand;       // path commands seen while drawing a path
+        int mDrawCommand;       // the only path command to draw, or -1 for all
+    
+        // Level of detail: rules smaller than a pixel are expanded from a
+        // queue of their own and the primitives smaller than a pixel are
+        // accumulated in a grid instead of being kept as finished shapes.
+        // There is a grid for each z layer, drawn after the finished shapes
+        // of its layer.
+        bool mLevelOfDetail;
+        std::vector<Shape> mSplatQueue;
+        std::map<double, SplatGrid> mSplatLayers;
+        double mSplatCellSize;
+        std::size_t mSplatCount;
+    
+        // Preview: finished shapes are drawn into the preview canvas as they
+        // are made, before they can be moved to temp files
+        Canvas* mPreview;
+        std::chrono::duration<double> mPreviewInterval;
+        std::chrono::steady_clock::time_point mPreviewAt;   // next output
+        std::size_t mPreviewDrawn;      // finished shapes in the preview
+        Bounds mPreviewFrame;
+        agg::trans_affine mPreviewTrans;
 
         typedef chunk_vector<FinishedShape, 10> FinishedContainer;
         FinishedContainer mFinishedShapes;
+        std::vector<HSBColor> mPendingColors;
+            // colors of the last finished shapes, not yet converted
         typedef chunk_vector<Shape, 10> UnfinishedContainer;
         UnfinishedContainer mUnfinishedShapes;
 
+        SpillWriter mSpillWriter;
+        BackgroundMerge mBackgroundMerge;
         std::deque<TempFile> m_finishedFiles;
-        std::deque<TempFile> m_unfinishedFiles;
+        SpilledExpansions mSpilledExpansions;
+        FrameIndex mFrameIndex;
+        int mIndexedFrame;      // animation frame drawn from mFrameIndex, or 0
+        BandIndex mBandIndex;
+        bool mAccumulateFrames; // draw each frame over the previous one
         int mFinishedFileCount;
         int mUnfinishedFileCount;
 
@@ -160,16 +226,12 @@ class RendererImpl : public RendererAST {
         std::vector<agg::trans_affine> mSymmetryOps;
 
         AbstractSystem::Stats m_stats;
-        int m_unfinishedInFilesCount;
-    
-        primShape        circleCopy;
-        primShape        squareCopy;
-        primShape        triangleCopy;
-        std::array<AST::CommandInfo, 3> shapeMap;
     
         static unsigned int MoveFinishedAt;     // when this many, move to file
         static unsigned int MoveUnfinishedAt;   // when this many, move to files
         static unsigned int MaxMergeFiles;      // maximum number of files to merge at once
+        static unsigned int MergeFilesAt;       // when this many, merge in the background
+        static const std::size_t ColorBatch = 256;  // colors converted at once
     
     protected:
         void colorConflict(const yy::location& w) override;
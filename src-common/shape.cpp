@@ -28,17 +28,24 @@
 
 // Shape layout in files:
 // Shapebase (shape type and world state)
-// Shape bounds if this is a finished shape
 // Parameter token (8 bytes):
 //   zero if there are no parameters
 //   a memory pointer if the parameters are owned by some other object
 //   a header token if the parameters are owned by the shape
 //   (this is shapeName << 24 | paramCount << 8 | 0xff)
+//   an index token if the parameters were already written to this file
+//   (this is index << 8 | 0xfe)
 // The parameter block starting with the typeInfo block (2nd block)
-// A header token can be distinguished from a pointer by the lower two bits:
-// 00b for a pointer and 11b for a header token. See shapetype.cpp for
+// A token can be distinguished from a pointer by the lower two bits:
+// 00b for a pointer and non-zero for a token. See stacktype.cpp for
 // information on parameter block file layout.
 //
+// Finished shape layout in files:
+// Shape type, with PathFlag set if the shape is a path, and order
+// Transform, z, time, bounds and drawing color
+// For paths, the PathState: color, color target, random seed and the
+// parameter token, as above
+//
 
 #include "shape.h"
 #include <cassert>
@@ -54,6 +61,10 @@
 using std::isfinite;
 #endif
 
+namespace {
+    const int32_t PathFlag = 0x40000000;
+}
+
 bool
 Modification::isFinite() const
 {
@@ -121,10 +132,9 @@ Shape::read(std::istream& is)
 }
 
 void
-Shape::writeParams(std::ostream& os) const
+Shape::writeParams(std::ostream& os, bool release) const
 {
-    StackRule::Write(os, mParameters);
-    releaseParams();
+    StackRule::Write(os, mParameters, release);
 }
 
 void
@@ -133,19 +143,78 @@ Shape::readParams(std::istream& is)
     mParameters = StackRule::Read(is);
 }
 
+FinishedShape::FinishedShape(const Shape& s, int order, const Bounds& b, bool path)
+: mShapeType(s.mShapeType), mOrder(order), mTransform(s.mWorldState.m_transform),
+  mZ(s.mWorldState.m_Z), mTime(s.mWorldState.m_time), mBounds(b)
+{
+    if (path) {
+        PathState* state = new PathState;
+        state->m_Color = s.mWorldState.m_Color;
+        state->m_ColorTarget = s.mWorldState.m_ColorTarget;
+        state->mRand64Seed = s.mWorldState.mRand64Seed;
+        state->mParameters = s.mParameters;
+        mPath.reset(state);
+    }
+}
+
+Shape
+FinishedShape::pathShape() const
+{
+    Shape s;
+    s.mShapeType = mShapeType;
+    s.mWorldState.m_transform = mTransform;
+    s.mWorldState.m_Z = mZ;
+    s.mWorldState.m_time = mTime;
+    s.mWorldState.m_ColorAssignment = mOrder;
+    if (mPath) {
+        s.mWorldState.m_Color = mPath->m_Color;
+        s.mWorldState.m_ColorTarget = mPath->m_ColorTarget;
+        s.mWorldState.mRand64Seed = mPath->mRand64Seed;
+        s.mParameters = mPath->mParameters;
+    }
+    s.mAreaCache = s.mWorldState.area();
+    return s;
+}
+
 void
-FinishedShape::write(std::ostream& os) const
+FinishedShape::write(std::ostream& os, bool release) const
 {
-    ShapeBase::write(os);
-    os.write(reinterpret_cast<const char*>(&mBounds), sizeof(Bounds));
-    writeParams(os);
+    int32_t type = mShapeType | (mPath ? PathFlag : 0);
+    os.write(reinterpret_cast<const char*>(&type), sizeof(type));
+    os.write(reinterpret_cast<const char*>(&mOrder), sizeof(mOrder));
+    os.write(reinterpret_cast<const char*>(&mTransform), sizeof(mTransform));
+    os.write(reinterpret_cast<const char*>(&mZ), sizeof(mZ));
+    os.write(reinterpret_cast<const char*>(&mTime), sizeof(mTime));
+    os.write(reinterpret_cast<const char*>(&mBounds), sizeof(mBounds));
+    os.write(reinterpret_cast<const char*>(&mColor), sizeof(mColor));
+    if (mPath) {
+        os.write(reinterpret_cast<const char*>(&mPath->m_Color), sizeof(HSBColor));
+        os.write(reinterpret_cast<const char*>(&mPath->m_ColorTarget), sizeof(HSBColor));
+        os.write(reinterpret_cast<const char*>(&mPath->mRand64Seed), sizeof(Rand64));
+        StackRule::Write(os, mPath->mParameters, release);
+    }
 }
 
 void
 FinishedShape::read(std::istream& is)
 {
-    ShapeBase::read(is);
-    is.read(reinterpret_cast<char *>(&mBounds), sizeof(Bounds));
-    readParams(is);
+    int32_t type = 0;
+    is.read(reinterpret_cast<char*>(&type), sizeof(type));
+    mShapeType = type & ~PathFlag;
+    is.read(reinterpret_cast<char*>(&mOrder), sizeof(mOrder));
+    is.read(reinterpret_cast<char*>(&mTransform), sizeof(mTransform));
+    is.read(reinterpret_cast<char*>(&mZ), sizeof(mZ));
+    is.read(reinterpret_cast<char*>(&mTime), sizeof(mTime));
+    is.read(reinterpret_cast<char*>(&mBounds), sizeof(mBounds));
+    is.read(reinterpret_cast<char*>(&mColor), sizeof(mColor));
+    if (type & PathFlag) {
+        PathState* state = new PathState;
+        is.read(reinterpret_cast<char*>(&state->m_Color), sizeof(HSBColor));
+        is.read(reinterpret_cast<char*>(&state->m_ColorTarget), sizeof(HSBColor));
+        is.read(reinterpret_cast<char*>(&state->mRand64Seed), sizeof(Rand64));
+        state->mParameters = StackRule::Read(is);
+        mPath.reset(state);
+    } else {
+        mPath.reset();
+    }
 }
-
@@ -33,6 +33,7 @@
 #include <iostream>
 #include <cmath>
 #include <functional>
+#include <memory>
 
 #include "agg_math_stroke.h"
 #include "agg_trans_affine.h"
@@ -130,31 +131,52 @@ public:
     void write(std::ostream& os) const;
     void read(std::istream& is);
 protected:
-    void writeParams(std::ostream& os) const;
+    void writeParams(std::ostream& os, bool release = true) const;
     void readParams(std::istream& is);
 };
 
-class FinishedShape : public Shape {
+// The state of a finished path shape that is only needed to traverse the
+// path again when it is drawn
+struct PathState {
+    HSBColor m_Color;
+    HSBColor m_ColorTarget;
+    Rand64 mRand64Seed;
+    const StackRule* mParameters;
+};
+
+// Contains what is needed to draw a finished shape. Primitive shapes are
+// drawn with the converted color, path shapes also keep a PathState.
+class FinishedShape {
 public:
+    int mShapeType;
+    int mOrder;                         // breaks ties in z
+    agg::trans_affine mTransform;
+    agg::trans_affine_1D mZ;            // z position and path area
+    agg::trans_affine_time mTime;
     Bounds mBounds;
-    FinishedShape() = default;
-    FinishedShape(const Shape& s, int order, const Bounds& b)
+    agg::rgba16 mColor;
+        // color converted once for drawing, set by the renderer
+    std::shared_ptr<const PathState> mPath;
+    
+    FinishedShape() : mShapeType(-1), mOrder(0), mColor(0, 0, 0, 0) { }
+    FinishedShape(const Shape& s, int order, const Bounds& b, bool path);
+
+    bool operator<(const FinishedShape& b) const
     {
-        mShapeType = s.mShapeType;
-        mWorldState = s.mWorldState;
-        mWorldState.m_ColorAssignment = order;
-        mParameters = s.mParameters;
-        mBounds = b;
-    };
-
-    bool operator<(const Shape& b) const
+        return (mZ.tz == b.mZ.tz) ? (mOrder < b.mOrder) : (mZ.tz < b.mZ.tz);
+    }
+    
+    Shape pathShape() const;
+        // the shape that the path is traversed with
+    void releaseParams() const
     {
-        return (mWorldState.m_Z.tz == b.mWorldState.m_Z.tz) ?
-            (mWorldState.m_ColorAssignment < b.mWorldState.m_ColorAssignment) :
-            (mWorldState.m_Z.tz < b.mWorldState.m_Z.tz);
+        if (mPath && mPath->mParameters)
+            mPath->mParameters->release();
     }
     
-    void write(std::ostream& os) const;
+    void write(std::ostream& os, bool release = true) const;
+        // If release is false then the reference count of the parameters
+        // is left untouched, otherwise the reference is handed to the stream
     void read(std::istream& is);
 };
 
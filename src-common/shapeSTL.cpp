@@ -28,14 +28,18 @@
 
 
 #include "shapeSTL.h"
+#include "traceLog.h"
+#include "readAhead.h"
 #include <limits>
+#include <algorithm>
+#include <cmath>
 using namespace std;
 
 
 void
 OutputMerge::addTempFile(TempFile& t)
 {
-    istream* f = t.forRead();
+    istream* f = new ReadAheadStream(t.forRead());
     mStreams.emplace_back(f);
     mIters.push_back(FileIter(*f));
     
@@ -51,6 +55,24 @@ OutputMerge::addShapes(ShapeIter begin, ShapeIter end)
     insertNext(numeric_limits<size_t>::max());
 }
 
+void
+OutputMerge::passThrough(size_t i, ShapeFunction& op)
+{
+    // Shapes from input i that come before everything in the sieve are
+    // passed on directly. When the inputs hold disjoint runs, e.g. spills
+    // of a design with a single z layer, the merge becomes a concatenation.
+    if (i == numeric_limits<size_t>::max()) {
+        while (mShapesNext != mShapesEnd &&
+               (mSieve.empty() || *mShapesNext < mSieve.begin()->first))
+            op(*mShapesNext++);
+    } else {
+        FileIter& input = mIters[i];
+        while (input != mFileEnd &&
+               (mSieve.empty() || *input < mSieve.begin()->first))
+            op(*input++);
+    }
+}
+
 OutputMerge::~OutputMerge()
 {
 }
@@ -70,3 +92,682 @@ OutputMerge::insertNext(size_t i)
         }
     }
 }
+
+void
+SortFinishedShapes(chunk_vector<FinishedShape, 10>& shapes)
+{
+    typedef chunk_vector<FinishedShape, 10> ShapeBatch;
+    static const size_t MaxLayers = 16;
+    
+    std::vector<double> layerZ;
+    std::vector<int>    layerOrder;     // order of the last shape in each layer
+    std::vector<size_t> layerCount;
+    size_t layer = 0;
+    for (const FinishedShape& fs: shapes) {
+        double z = fs.mZ.tz;
+        if (layerZ.empty() || layerZ[layer] != z) {
+            layer = std::find(layerZ.begin(), layerZ.end(), z) - layerZ.begin();
+            if (layer == layerZ.size()) {
+                if (layer == MaxLayers) {
+                    std::sort(shapes.begin(), shapes.end());
+                    return;
+                }
+                layerZ.push_back(z);
+                layerOrder.push_back(numeric_limits<int>::min());
+                layerCount.push_back(0);
+            }
+        }
+        if (fs.mOrder < layerOrder[layer]) {
+            // Not in creation order within a layer
+            std::sort(shapes.begin(), shapes.end());
+            return;
+        }
+        layerOrder[layer] = fs.mOrder;
+        ++layerCount[layer];
+    }
+    
+    if (layerZ.size() < 2)
+        return;
+    
+    // Concatenate the layers in z order
+    std::vector<size_t> byZ(layerZ.size());
+    for (size_t i = 0; i < byZ.size(); ++i)
+        byZ[i] = i;
+    std::sort(byZ.begin(), byZ.end(), [&](size_t a, size_t b) {
+        return layerZ[a] < layerZ[b];
+    });
+    
+    // Counting sort of the shape indices by layer, then a single copy
+    std::vector<size_t> start(layerZ.size());
+    size_t next = 0;
+    for (size_t i: byZ) {
+        start[i] = next;
+        next += layerCount[i];
+    }
+    std::vector<size_t> index(shapes.size());
+    layer = 0;
+    size_t n = 0;
+    for (const FinishedShape& fs: shapes) {
+        if (layerZ[layer] != fs.mZ.tz)
+            layer = std::find(layerZ.begin(), layerZ.end(), fs.mZ.tz) - layerZ.begin();
+        index[start[layer]++] = n++;
+    }
+    
+    ShapeBatch sorted;
+    ShapeBatch::iterator first = shapes.begin();
+    for (size_t i: index)
+        sorted.push_back(*(first + static_cast<ShapeBatch::difference_type>(i)));
+    shapes.swap(sorted);
+}
+
+SpillWriter::SpillWriter()
+: mPending(false), mWriting(false), mFailed(false), mQuit(false), mAbort(false)
+{
+}
+
+SpillWriter::~SpillWriter()
+{
+    abort();
+    if (mThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+        mCond.notify_all();
+        mThread.join();
+    }
+}
+
+bool
+SpillWriter::write(ShapeBatch& shapes, std::ostream* f)
+{
+    bool ok = wait();
+    
+    mStream.reset(f);
+    mBatch.swap(shapes);
+    mAbort = false;
+    mPending = true;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWriting = true;
+    }
+    if (!mThread.joinable())
+        mThread = std::thread(&SpillWriter::writeLoop, this);
+    mCond.notify_all();
+    return ok;
+}
+
+bool
+SpillWriter::wait()
+{
+    if (!mPending)
+        return !mFailed;
+    
+    {
+        TraceLog::Scope trace("spill wait", "spill");
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this]{ return !mWriting; });
+    }
+    
+    for (const FinishedShape& fs: mBatch)
+        fs.releaseParams();
+    mBatch.clear();
+    mPending = false;
+    
+    bool ok = !mFailed;
+    mFailed = false;
+    return ok;
+}
+
+void
+SpillWriter::abort()
+{
+    mAbort = true;
+    wait();
+}
+
+void
+SpillWriter::writeLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mCond.wait(lock, [this]{ return mWriting || mQuit; });
+        if (!mWriting)
+            return;
+        lock.unlock();
+        
+        bool failed = false;
+        {
+            TraceLog::Scope trace("spill write", "spill");
+            trace.arg("shapes", mBatch.size());
+            SortFinishedShapes(mBatch);
+            for (const FinishedShape& fs: mBatch) {
+                if (mAbort) break;
+                fs.write(*mStream, false);
+            }
+            mStream->flush();
+            failed = !mStream->good();
+            mStream.reset();
+        }
+        
+        lock.lock();
+        mFailed = failed;
+        mWriting = false;
+        mCond.notify_all();
+    }
+}
+
+namespace {
+    class MergeAborted { };
+}
+
+BackgroundMerge::BackgroundMerge()
+: mMerging(false), mFailed(false), mQuit(false), mAbort(false)
+{
+}
+
+BackgroundMerge::~BackgroundMerge()
+{
+    abort();
+    if (mThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+        }
+        mCond.notify_all();
+        mThread.join();
+    }
+}
+
+void
+BackgroundMerge::start(std::deque<TempFile>& runs, size_t count, TempFile&& out)
+{
+    mMerger.reset(new OutputMerge);
+    for (size_t i = 0; i < count; ++i) {
+        mInputs.push_back(std::move(runs.front()));
+        runs.pop_front();
+        mMerger->addTempFile(mInputs.back());
+    }
+    mOutput.push_back(std::move(out));
+    mStream.reset(mOutput.back().forWrite());
+    mAbort = false;
+    mFailed = false;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMerging = true;
+    }
+    if (!mThread.joinable())
+        mThread = std::thread(&BackgroundMerge::mergeLoop, this);
+    mCond.notify_all();
+}
+
+bool
+BackgroundMerge::ready()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return busy() && !mMerging;
+}
+
+bool
+BackgroundMerge::collect(std::deque<TempFile>& runs, bool beforeLast)
+{
+    if (!busy())
+        return true;
+    
+    {
+        TraceLog::Scope trace("merge wait", "merge");
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this]{ return !mMerging; });
+    }
+    
+    mMerger.reset();
+    mInputs.clear();
+    if (mFailed || mAbort) {
+        mOutput.clear();
+        return !mFailed;
+    }
+    
+    auto pos = runs.end();
+    if (beforeLast && !runs.empty())
+        --pos;
+    runs.insert(pos, std::move(mOutput.front()));
+    mOutput.clear();
+    return true;
+}
+
+void
+BackgroundMerge::abort()
+{
+    mAbort = true;
+    collect(mOutput, false);
+}
+
+void
+BackgroundMerge::mergeLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mCond.wait(lock, [this]{ return mMerging || mQuit; });
+        if (!mMerging)
+            return;
+        lock.unlock();
+        
+        bool failed = false;
+        try {
+            TraceLog::Scope trace("background merge", "merge");
+            trace.arg("files", mInputs.size());
+            std::ostream& f = *mStream;
+            mMerger->merge([&](const FinishedShape& s) {
+                if (mAbort) throw MergeAborted();
+                f << s;
+            });
+            f.flush();
+            failed = !f.good();
+        } catch (MergeAborted&) {
+        } catch (std::exception&) {
+            failed = true;
+        }
+        mStream.reset();
+        
+        lock.lock();
+        mFailed = failed;
+        mMerging = false;
+        mCond.notify_all();
+    }
+}
+
+int
+SpilledExpansions::BucketOf(double area)
+{
+    return area > 0.0 ? std::ilogb(area) : numeric_limits<int>::min();
+}
+
+double
+SpilledExpansions::maxArea() const
+{
+    return mBuckets.empty() ? 0.0 : mBuckets.rbegin()->second.maxArea();
+}
+
+double
+SpilledExpansions::Bucket::maxArea() const
+{
+    double area = 0.0;
+    for (const Segment& seg: mSegments)
+        area = std::max(area, seg.mMaxArea);
+    return area;
+}
+
+bool
+SpilledExpansions::write(ShapeIter begin, ShapeIter& end, TempFile&& file,
+                         size_t segmentSize, const Progress& progress)
+{
+    int num = file.number();
+    Run& run = mRuns.emplace(num, Run(std::move(file))).first->second;
+    std::unique_ptr<std::ostream> f(run.mFile.forWrite());
+    if (!f || !f->good())
+        return false;
+    
+    Segment* seg = nullptr;
+    int bucketNum = 0;
+    for (ShapeIter it = begin; it != end; ++it) {
+        int b = BucketOf(it->area());
+        if (!seg || b != bucketNum || seg->mCount >= segmentSize) {
+            bucketNum = b;
+            Bucket& bucket = mBuckets[b];
+            bucket.mSegments.push_back(Segment{num, f->tellp(), 0, it->area()});
+            seg = &bucket.mSegments.back();
+            // Each segment is read on its own, so it needs its own dictionary
+            StackRule::ResetDictionary(*f);
+            ++run.mSegments;
+        }
+        it->write(*f);
+        ++seg->mCount;
+        ++mCount;
+        if (!progress()) {
+            end = ++it;
+            break;
+        }
+    }
+    
+    return f->good();
+}
+
+bool
+SpilledExpansions::readLargest(ShapeHeap& dest, size_t limit, const Progress& progress)
+{
+    size_t read = 0;
+    bool ok = true;
+    while (ok && !mBuckets.empty()) {
+        // Read the segment that starts with the largest shape, they are
+        // about the same size so the order within a bucket is only a guess
+        auto largest = --mBuckets.end();
+        std::vector<Segment>& segs = largest->second.mSegments;
+        auto next = std::max_element(segs.begin(), segs.end(),
+            [](const Segment& a, const Segment& b) { return a.mMaxArea < b.mMaxArea; });
+        if (read && read + next->mCount > limit)
+            break;
+        
+        Segment seg = *next;
+        segs.erase(next);
+        if (segs.empty())
+            mBuckets.erase(largest);
+        
+        auto run = mRuns.find(seg.mRun);
+        std::unique_ptr<std::istream> f(run->second.mFile.forRead());
+        bool stopped = false;
+        if (f && f->seekg(seg.mOffset)) {
+            Shape s;
+            for (size_t i = 0; i < seg.mCount && *f >> s; ++i) {
+                dest.push_back(s);
+                if (!progress()) {
+                    stopped = true;
+                    break;
+                }
+            }
+        }
+        ok = f && !f->fail();
+        read += seg.mCount;
+        mCount -= seg.mCount;
+        if (--run->second.mSegments == 0)
+            mRuns.erase(run);
+        // The rest of a stopped segment is dropped, its parameters were
+        // never read in
+        if (stopped)
+            break;
+    }
+    return ok;
+}
+
+void
+FrameIndex::init(const agg::trans_affine_time& time, int frames)
+{
+    clear();
+    mTime = time;
+    mFrames = frames;
+    mFrameInc = (time.tend - time.tbegin) / frames;
+}
+
+void
+FrameIndex::start(const agg::trans_affine_time& time, int frames, ShapeSource& shapes)
+{
+    init(time, frames);
+    mShapes = &shapes;
+}
+
+bool
+FrameIndex::start(const agg::trans_affine_time& time, int frames, TempFile&& file)
+{
+    init(time, frames);
+    mFile.reset(new TempFile(std::move(file)));
+    mStream.reset(mFile->forWrite());
+    return mStream && mStream->good();
+}
+
+bool
+FrameIndex::add(const FinishedShape& s)
+{
+    int first, last;
+    bool alive = frameRange(s.mTime, first, last);
+    if (!alive && mStream) {
+        s.releaseParams();
+        return true;
+    }
+    
+    // In memory the blocks are ranges of the container, so they also hold
+    // the shapes that aren't in any frame
+    if (mBlocks.empty() || mBlocks.back().mCount == BlockShapes) {
+        mBlocks.push_back(Block{0, mCount, 0, numeric_limits<int>::max(), 0, 0});
+        if (mStream) {
+            mBlocks.back().mOffset = mStream->tellp();
+            // Each block is read on its own, so it needs its own dictionary
+            StackRule::ResetDictionary(*mStream);
+        }
+    }
+    Block& block = mBlocks.back();
+    ++block.mCount;
+    ++mCount;
+    if (alive) {
+        mAccumulates = mAccumulates && last == mFrames && first >= mLastFirst;
+        mLastFirst = first;
+        block.mFirst = std::min(block.mFirst, first);
+        block.mFirstMax = std::max(block.mFirstMax, first);
+        block.mLast = std::max(block.mLast, last);
+    }
+    
+    if (!mStream)
+        return true;
+    s.write(*mStream);
+    return mStream->good();
+}
+
+bool
+FrameIndex::finish()
+{
+    if (!mStream)
+        return true;
+    mStream->flush();
+    bool ok = mStream->good();
+    mStream.reset();
+    return ok;
+}
+
+std::istream*
+FrameIndex::openForRead()
+{
+    return mFile ? mFile->forRead() : nullptr;
+}
+
+bool
+FrameIndex::forFrame(int frame, int since, ShapeFunction op, std::istream* f)
+{
+    std::unique_ptr<std::istream> own;
+    if (mFile && !f) {
+        own.reset(mFile->forRead());
+        f = own.get();
+    }
+    
+    for (const Block& block: mBlocks) {
+        if (frame < block.mFirst || frame > block.mLast || block.mFirstMax <= since)
+            continue;
+        
+        auto draw = [&](const FinishedShape& s) {
+            int first, last;
+            if (frameRange(s.mTime, first, last) &&
+                first <= frame && frame <= last && first > since)
+                op(s);
+        };
+        
+        if (!mFile) {
+            auto it = mShapes->begin() + block.mBegin;
+            for (size_t i = 0; i < block.mCount && it != mShapes->end(); ++i, ++it)
+                draw(*it);
+            continue;
+        }
+        
+        if (!f || !f->seekg(block.mOffset))
+            return false;
+        StackRule::ResetDictionary(*f);
+        FinishedShape s;
+        for (size_t i = 0; i < block.mCount && *f >> s; ++i) {
+            try {
+                draw(s);
+            } catch (...) {
+                s.releaseParams();
+                throw;
+            }
+            s.releaseParams();
+        }
+        if (f->fail())
+            return false;
+    }
+    return true;
+}
+
+void
+FrameIndex::clear()
+{
+    mStream.reset();
+    mFile.reset();
+    mShapes = nullptr;
+    mBlocks.clear();
+    mCount = 0;
+    mLastFirst = 0;
+    mAccumulates = true;
+}
+
+bool
+FrameIndex::frameRange(const agg::trans_affine_time& t, int& first, int& last) const
+{
+    // Frame k covers [frameEnd(k - 1), frameEnd(k)] and overlaps the time
+    // unless it ends before the time begins or begins after the time ends.
+    // The estimate from dividing is nudged to agree with that exactly.
+    double f = std::ceil((t.tbegin - mTime.tbegin) / mFrameInc);
+    first = !(f > 1.0) ? 1 : (f > mFrames ? mFrames + 1 : static_cast<int>(f));
+    while (first > 1 && !(frameEnd(first - 1) < t.tbegin))
+        --first;
+    while (first <= mFrames && frameEnd(first) < t.tbegin)
+        ++first;
+    
+    double l = std::floor((t.tend - mTime.tbegin) / mFrameInc) + 1.0;
+    last = !(l < mFrames) ? mFrames : (l < 0.0 ? 0 : static_cast<int>(l));
+    while (last < mFrames && !(frameEnd(last) > t.tend))
+        ++last;
+    while (last >= 1 && frameEnd(last - 1) > t.tend)
+        --last;
+    
+    return first <= last;
+}
+
+void
+BandIndex::start(int bands, ShapeSource& shapes)
+{
+    clear();
+    mBands.resize(bands);
+    mShapes = &shapes;
+}
+
+bool
+BandIndex::start(int bands, TempFile&& file, RendererAST* r)
+{
+    clear();
+    mBands.resize(bands);
+    mRenderer = r;
+    mFile.reset(new TempFile(std::move(file)));
+    mStream.reset(mFile->forWrite());
+    return mStream && mStream->good();
+}
+
+bool
+BandIndex::add(const FinishedShape& s, int first, int last)
+{
+    size_t index = mCount++;
+    if (first > last) {
+        if (mStream)
+            s.releaseParams();
+        return true;
+    }
+    mEntries += last - first + 1;
+    
+    if (!mStream) {
+        for (int b = first; b <= last; ++b)
+            mBands[b].mShapes.push_back(index);
+        return true;
+    }
+    
+    // Each band's segments have their own dictionary, so each of them gets
+    // a reference to the parameters
+    if (s.mPath && s.mPath->mParameters)
+        for (int b = first; b < last; ++b)
+            s.mPath->mParameters->retain(mRenderer);
+    
+    bool ok = true;
+    for (int b = first; b <= last; ++b) {
+        Band& band = mBands[b];
+        if (!band.mBuffer)
+            band.mBuffer.reset(new std::ostringstream(std::ios::binary));
+        s.write(*band.mBuffer);
+        ++band.mBuffered;
+        if (static_cast<size_t>(band.mBuffer->tellp()) >= SegmentBytes)
+            ok = flush(band) && ok;
+    }
+    return ok;
+}
+
+// Appends the buffered shapes of the band to the file as a segment, the
+// parameters that the buffer held go with it
+bool
+BandIndex::flush(Band& band)
+{
+    if (!band.mBuffered)
+        return true;
+    band.mSegments.push_back(Segment{mStream->tellp(), band.mBuffered});
+    std::string bytes = band.mBuffer->str();
+    mStream->write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    band.mBuffer.reset();
+    band.mBuffered = 0;
+    return mStream->good();
+}
+
+bool
+BandIndex::finish()
+{
+    if (!mStream)
+        return true;
+    bool ok = true;
+    for (Band& band: mBands)
+        ok = flush(band) && ok;
+    mStream->flush();
+    ok = mStream->good() && ok;
+    mStream.reset();
+    return ok;
+}
+
+bool
+BandIndex::forBand(int band, ShapeFunction op)
+{
+    if (!mFile) {
+        for (size_t index: mBands[band].mShapes)
+            op((*mShapes)[index]);
+        return true;
+    }
+    
+    std::unique_ptr<std::istream> f(mFile->forRead());
+    for (const Segment& segment: mBands[band].mSegments) {
+        if (!f || !f->seekg(segment.mOffset))
+            return false;
+        StackRule::ResetDictionary(*f);
+        FinishedShape s;
+        for (size_t i = 0; i < segment.mCount && *f >> s; ++i) {
+            try {
+                op(s);
+            } catch (...) {
+                s.releaseParams();
+                throw;
+            }
+            s.releaseParams();
+        }
+        if (f->fail())
+            return false;
+    }
+    return true;
+}
+
+void
+BandIndex::clear()
+{
+    mStream.reset();
+    mBands.clear();
+    mFile.reset();
+    mShapes = nullptr;
+    mRenderer = nullptr;
+    mCount = 0;
+    mEntries = 0;
+}
+
+void
+SpilledExpansions::clear()
+{
+    mBuckets.clear();
+    mRuns.clear();
+    mCount = 0;
+}
@@ -36,17 +36,28 @@
 
 #include <functional>
 #include <iostream>
+#include <sstream>
 #include <iterator>
 #include <map>
 #include <vector>
+#include <deque>
 #include <set>
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "chunk_vector.h"
 
 #include "cfdg.h"
 #include "shape.h"
 #include "tempfile.h"
 
+void SortFinishedShapes(chunk_vector<FinishedShape, 10>& shapes);
+    // Puts finished shapes in drawing order: by z, then by creation order.
+    // Shapes are finished in creation order, so if there are only a few
+    // distinct z values the z layers are concatenated instead of sorted.
+
 class OutputMerge
 {
 public:
@@ -70,6 +81,7 @@ public:
             size_t i = nextShape->second;
         
             mSieve.erase(nextShape);
+            passThrough(i, op);
             insertNext(i);
         }
     }
@@ -95,7 +107,272 @@ private:
     Sieve       mSieve;
     
     void insertNext(size_t i);
+    void passThrough(size_t i, ShapeFunction& op);
     OutputMerge& operator=(const OutputMerge&) { return *this; }
 };
 
+// Sorts and writes batches of finished shapes to temp files on a writer
+// thread so that expansion can continue while a batch is spilled. There is
+// at most one batch in flight: submitting another waits for the previous
+// one to be written. The parameters of written shapes are released on the
+// calling thread, in wait(), because StackRule reference counts are not
+// thread-safe.
+class SpillWriter
+{
+public:
+    typedef chunk_vector<FinishedShape, 10> ShapeBatch;
+    
+    SpillWriter();
+    ~SpillWriter();
+    
+    bool write(ShapeBatch& shapes, std::ostream* f);
+        // Takes the shapes, leaving shapes empty, and takes ownership of f.
+        // Returns false if writing the previous batch failed.
+    bool wait();
+        // Waits until the current batch is written and its stream closed.
+        // Returns false if writing failed.
+    void abort();
+        // Stops writing the current batch as soon as possible and waits.
+    bool busy() const { return mPending; }
+    
+private:
+    void writeLoop();
+    
+    ShapeBatch                      mBatch;
+    std::unique_ptr<std::ostream>   mStream;
+    
+    std::thread                     mThread;
+    std::mutex                      mMutex;
+    std::condition_variable         mCond;
+    bool                            mPending;   // batch submitted, not yet waited on
+    bool                            mWriting;   // batch still owned by the writer thread
+    bool                            mFailed;
+    bool                            mQuit;
+    std::atomic<bool>               mAbort;
+    
+    SpillWriter(const SpillWriter&) = delete;
+    SpillWriter& operator=(const SpillWriter&) = delete;
+};
+
+// Merges spilled runs of finished shapes into one larger run on a worker
+// thread while expansion continues, so that the final output has fewer runs
+// to merge. The temp files are opened and deleted on the calling thread;
+// the worker thread only reads and writes the streams.
+class BackgroundMerge
+{
+public:
+    BackgroundMerge();
+    ~BackgroundMerge();
+    
+    void start(std::deque<TempFile>& runs, size_t count, TempFile&& out);
+        // Takes the first count runs and merges them into out
+    bool busy() const { return mMerger != nullptr; }
+    bool ready();
+        // True if a merge is busy but finished
+    bool collect(std::deque<TempFile>& runs, bool beforeLast);
+        // Waits for the merge to finish, deletes the input runs and adds
+        // the merged run to runs, ahead of the last run if beforeLast is
+        // true. Returns false if the merge failed.
+    void abort();
+        // Stops the merge as soon as possible and discards it.
+    
+private:
+    void mergeLoop();
+    
+    std::vector<TempFile>           mInputs;
+    std::deque<TempFile>            mOutput;
+    std::unique_ptr<OutputMerge>    mMerger;
+    std::unique_ptr<std::ostream>   mStream;
+    
+    std::thread                     mThread;
+    std::mutex                      mMutex;
+    std::condition_variable         mCond;
+    bool                            mMerging;   // merge owned by the worker thread
+    bool                            mFailed;
+    bool                            mQuit;
+    std::atomic<bool>               mAbort;
+    
+    BackgroundMerge(const BackgroundMerge&) = delete;
+    BackgroundMerge& operator=(const BackgroundMerge&) = delete;
+};
+
+// External-memory priority queue for unfinished shapes. Each spill writes
+// one temp file holding a run of shapes sorted largest area first. The run
+// is indexed by area bucket (the binary exponent of the area) and split into
+// segments of bounded size, so that the largest spilled shapes can be read
+// back a bounded number at a time, skipping the rest of each file. A file is
+// deleted once all of its segments have been read.
+class SpilledExpansions
+{
+public:
+    typedef chunk_vector<Shape, 10>     ShapeHeap;
+    typedef ShapeHeap::iterator         ShapeIter;
+    typedef std::function<bool ()>      Progress;
+        // called after each shape is written or read, returns false to stop
+    
+    SpilledExpansions() : mCount(0) { }
+    
+    bool empty() const { return mBuckets.empty(); }
+    size_t size() const { return mCount; }
+    double maxArea() const;
+        // largest area of any spilled shape, zero if there are none
+    
+    bool write(ShapeIter begin, ShapeIter& end, TempFile&& file,
+               size_t segmentSize, const Progress& progress);
+        // Writes the shapes, which must be sorted largest area first, and
+        // releases their parameters. If progress stops the write then end is
+        // moved back to the first shape that was not written. Returns false
+        // on I/O error.
+    bool readLargest(ShapeHeap& dest, size_t limit, const Progress& progress);
+        // Appends up to limit of the largest shapes to dest, at least one
+        // segment's worth. Returns false on I/O error.
+    void clear();
+    
+private:
+    struct Run {
+        TempFile    mFile;
+        unsigned    mSegments;      // segments not read yet
+        Run(TempFile&& f) : mFile(std::move(f)), mSegments(0) { }
+    };
+    struct Segment {
+        int             mRun;
+        std::streamoff  mOffset;
+        size_t          mCount;
+        double          mMaxArea;   // area of the first shape
+    };
+    struct Bucket {
+        std::vector<Segment>    mSegments;
+        double maxArea() const;
+    };
+    
+    std::map<int, Run>      mRuns;          // by temp file number
+    std::map<int, Bucket>   mBuckets;       // by area exponent
+    size_t                  mCount;
+    
+    static int BucketOf(double area);
+};
+
+// Finished shapes of an animation indexed by the frames that they are alive
+// in, so that each frame reads only the shapes that can be in it instead of
+// merging all of the temp files again. The shapes are added in drawing order
+// and kept in blocks that record the range of frames their shapes are alive
+// in. In memory the blocks index the renderer's finished shapes, otherwise
+// the shapes are written to a single run in a temp file.
+// If every shape lives until the last frame and the shapes appear in drawing
+// order then the animation accumulates: each frame is the previous frame with
+// the shapes that appear in it drawn over it.
+class FrameIndex
+{
+public:
+    typedef chunk_vector<FinishedShape, 10> ShapeSource;
+    
+    FrameIndex() : mFrames(0), mFrameInc(0.0), mShapes(nullptr),
+                   mCount(0), mLastFirst(0), mAccumulates(true) { }
+    
+    void start(const agg::trans_affine_time& time, int frames, ShapeSource& shapes);
+        // Indexes the shapes in place, which must be in drawing order
+    bool start(const agg::trans_affine_time& time, int frames, TempFile&& file);
+        // Writes the shapes to file. Returns false on I/O error.
+    bool add(const FinishedShape& s);
+        // Adds the next shape in drawing order, handing its parameters to
+        // the file. Returns false on I/O error.
+    bool finish();
+    
+    bool accumulates() const { return mAccumulates; }
+    std::istream* openForRead();
+        // A stream for forFrame(), or null if the shapes are in memory
+    bool forFrame(int frame, int since, ShapeFunction op, std::istream* f = nullptr);
+        // Calls op for the shapes that are alive in the frame, in drawing
+        // order, leaving out the ones that appear in frame since or before.
+        // The stream from openForRead() is used if given, so that frames
+        // can be read on several threads. Returns false on I/O error.
+    void clear();
+    
+    bool frameRange(const agg::trans_affine_time& t, int& first, int& last) const;
+        // Sets the first and last frame (from 1) that the time overlaps the
+        // same way as the renderer's frame time bounds. Returns false if
+        // there aren't any.
+    
+    static const size_t BlockShapes = 4096;
+    
+private:
+    struct Block {
+        std::streamoff  mOffset;
+        size_t          mBegin;
+        size_t          mCount;
+        int             mFirst;     // earliest frame of any shape
+        int             mFirstMax;  // latest frame that a shape appears in
+        int             mLast;      // latest frame of any shape
+    };
+    
+    agg::trans_affine_time          mTime;
+    int                             mFrames;
+    double                          mFrameInc;
+    ShapeSource*                    mShapes;
+    std::unique_ptr<TempFile>       mFile;
+    std::unique_ptr<std::ostream>   mStream;
+    std::vector<Block>              mBlocks;
+    size_t                          mCount;
+    int                             mLastFirst;
+    bool                            mAccumulates;
+    
+    void init(const agg::trans_affine_time& time, int frames);
+    double frameEnd(int frame) const { return mTime.tbegin + mFrameInc * frame; }
+};
+
+// Indexes the finished shapes by the bands of the canvas that they fall in,
+// for drawing a canvas one band at a time. In memory each band has a list of
+// the renderer's finished shapes, otherwise the shapes of each band are
+// buffered and written to a single temp file in segments, so that a band is
+// read back without reading the shapes of the others.
+class BandIndex
+{
+public:
+    typedef chunk_vector<FinishedShape, 10> ShapeSource;
+    
+    BandIndex() : mShapes(nullptr), mRenderer(nullptr), mCount(0), mEntries(0) { }
+    
+    void start(int bands, ShapeSource& shapes);
+        // Indexes the shapes in place, all of them must be added in order
+    bool start(int bands, TempFile&& file, RendererAST* r);
+        // Writes the shapes to file. Returns false on I/O error.
+    bool add(const FinishedShape& s, int first, int last);
+        // Adds the next shape in drawing order to bands first to last, or to
+        // none if first > last, handing its parameters to the file. Returns
+        // false on I/O error.
+    bool finish();
+    
+    size_t entries() const { return mEntries; }
+        // The shapes of all of the bands, counting the shapes that are in
+        // several bands once for each
+    bool forBand(int band, ShapeFunction op);
+        // Calls op for the shapes of the band, in drawing order. Returns
+        // false on I/O error.
+    void clear();
+    
+    static const size_t SegmentBytes = 1 << 16;
+    
+private:
+    struct Segment {
+        std::streamoff  mOffset;
+        size_t          mCount;
+    };
+    struct Band {
+        std::vector<size_t>                 mShapes;    // in memory
+        std::vector<Segment>                mSegments;  // in the file
+        std::unique_ptr<std::ostringstream> mBuffer;    // the next segment
+        size_t                              mBuffered = 0;
+    };
+    
+    ShapeSource*                    mShapes;
+    RendererAST*                    mRenderer;
+    std::unique_ptr<TempFile>       mFile;
+    std::unique_ptr<std::ostream>   mStream;
+    std::vector<Band>               mBands;
+    size_t                          mCount;
+    size_t                          mEntries;
+    
+    bool flush(Band& band);
+};
+
 #endif // INCLUDE_SHAPESTL_H
@@ -0,0 +1,500 @@
+// spanBlend.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+#include "spanBlend.h"
+#include <cstring>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SPANBLEND_X86 1
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+    // agg's fixed point multiplies, exact over the value type. Covers are
+    // widened to 16 bits the way agg's mult_cover does it.
+    inline agg::int8u
+    multiply(agg::int8u a, agg::int8u b)
+    {
+        unsigned t = a * b + 0x80;
+        return static_cast<agg::int8u>(((t >> 8) + t) >> 8);
+    }
+    
+    inline agg::int16u
+    multiply(agg::int16u a, agg::int16u b)
+    {
+        agg::int32u t = static_cast<agg::int32u>(a) * b + 0x8000;
+        return static_cast<agg::int16u>(((t >> 16) + t) >> 16);
+    }
+    
+    inline agg::int8u   widen(agg::int8u cover, agg::int8u*)    { return cover; }
+    inline agg::int16u  widen(agg::int8u cover, agg::int16u*)
+    { return static_cast<agg::int16u>(cover << 8 | cover); }
+    
+    template <class T>
+    inline void
+    blendPixel(T* p, unsigned n, const T* color, T alpha, agg::int8u cover)
+    {
+        T c = widen(cover, static_cast<T*>(nullptr));
+        T a = multiply(alpha, c);
+        for (unsigned i = 0; i < n; ++i)
+            p[i] = static_cast<T>(p[i] + multiply(color[i], c) - multiply(p[i], a));
+    }
+    
+    template <class T>
+    void
+    scalarSpan(T* p, unsigned len, unsigned n, const T* color, T alpha,
+               const agg::int8u* covers)
+    {
+        bool opaque = alpha == std::numeric_limits<T>::max();
+        for (; len; --len, p += n, ++covers) {
+            if (opaque && *covers == agg::cover_mask)
+                std::memcpy(p, color, n * sizeof(T));
+            else
+                blendPixel(p, n, color, alpha, *covers);
+        }
+    }
+    
+    template <class T>
+    void
+    scalarLine(T* p, unsigned len, unsigned n, const T* color, T alpha,
+               agg::int8u cover)
+    {
+        if (alpha == std::numeric_limits<T>::max() && cover == agg::cover_mask) {
+            for (; len; --len, p += n)
+                std::memcpy(p, color, n * sizeof(T));
+        } else {
+            for (; len; --len, p += n)
+                blendPixel(p, n, color, alpha, cover);
+        }
+    }
+    
+    // Composites a color under pixels whose accumulated alpha is in
+    // coverage: the color only shows through what is not covered yet, and
+    // what shows through adds to the coverage.
+    template <class T>
+    void
+    scalarUnder(T* p, T* coverage, unsigned len, unsigned n, const T* color, T alpha,
+                const agg::int8u* covers, unsigned coverStep)
+    {
+        const unsigned full = std::numeric_limits<T>::max();
+        for (; len; --len, p += n, ++coverage, covers += coverStep) {
+            T w = multiply(widen(*covers, static_cast<T*>(nullptr)),
+                           static_cast<T>(full - *coverage));
+            if (!w)
+                continue;
+            for (unsigned i = 0; i < n; ++i) {
+                unsigned v = p[i] + multiply(color[i], w);
+                p[i] = static_cast<T>(v < full ? v : full);
+            }
+            unsigned c = *coverage + multiply(alpha, w);
+            *coverage = static_cast<T>(c < full ? c : full);
+        }
+    }
+    
+    enum InstructionSet { Scalar, SSE41, AVX2 };
+    
+    InstructionSet
+    detect()
+    {
+#ifdef SPANBLEND_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return SSE41;
+#endif
+        return Scalar;
+    }
+    
+    const InstructionSet SupportedInstructionSet = detect();
+    InstructionSet TheInstructionSet = SupportedInstructionSet;
+    
+#ifdef SPANBLEND_X86
+    // Pixels are blended 16 bytes at a time, as many whole pixels as fit.
+    // Covers and the color are spread over each pixel's components with byte
+    // shuffles. Lanes past the last whole pixel get no cover and so blend to
+    // what was already there. The math is done in 16 bit lanes.
+    struct Lanes {
+        unsigned    pixels;     // whole pixels per 16 bytes
+        unsigned    bytes;      // bytes they take up
+        unsigned    minimum;    // pixels needed to load 16 bytes and their covers
+        alignas(16) agg::int8u spread[16];
+        alignas(16) agg::int8u colorSpread[16];
+        alignas(16) agg::int8u used[16];
+    };
+    
+    // Lanes for each value size (1 or 2 bytes) and component count (1 to 4)
+    struct LaneTable {
+        Lanes       lanes[2][5];
+        
+        LaneTable()
+        {
+            for (unsigned size = 1; size <= 2; ++size) {
+                for (unsigned n = 1; n <= 4; ++n) {
+                    Lanes& l = lanes[size - 1][n];
+                    unsigned values = 16 / size;
+                    l.pixels = values / n;
+                    l.bytes = l.pixels * n * size;
+                    unsigned coverLoad = l.pixels <= 4 ? 4 : (l.pixels <= 8 ? 8 : 16);
+                    unsigned bufferLoad = (16 + n * size - 1) / (n * size);
+                    l.minimum = coverLoad > bufferLoad ? coverLoad : bufferLoad;
+                    for (unsigned i = 0; i < 16; ++i) {
+                        unsigned value = i / size;
+                        bool inPixel = i < l.bytes;
+                        l.spread[i] = inPixel ? static_cast<agg::int8u>(value / n) : 0x80;
+                        l.colorSpread[i] = inPixel ? static_cast<agg::int8u>((value % n) * size + i % size) : 0x80;
+                        l.used[i] = inPixel ? 0xff : 0;
+                    }
+                }
+            }
+        }
+        
+        const Lanes& get(unsigned size, unsigned n) const { return lanes[size - 1][n]; }
+    };
+    
+    const LaneTable TheLanes;
+    
+    template <class T>
+    inline void
+    loadColor(agg::int8u* bytes, const T* color, unsigned n)
+    {
+        std::memset(bytes, 0, 16);
+        std::memcpy(bytes, color, n * sizeof(T));
+    }
+    
+    // Covers for one 16 byte block, before spreading
+    TARGET_SSE41 inline __m128i
+    loadCovers(const agg::int8u* covers, unsigned pixels)
+    {
+        if (pixels > 8)
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(covers));
+        if (pixels > 4)
+            return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(covers));
+        int four;
+        std::memcpy(&four, covers, 4);
+        return _mm_cvtsi32_si128(four);
+    }
+    
+    // agg's 8 bit multiply: with t = a * b + 0x80, (t + (t >> 8)) >> 8 is the
+    // same as (t * 257) >> 16
+    TARGET_SSE41 inline __m128i
+    mul8(__m128i a, __m128i b)
+    {
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(0x80));
+        return _mm_mulhi_epu16(t, _mm_set1_epi16(257));
+    }
+    
+    // agg's 16 bit multiply from the high and low halves of the product:
+    // t = a * b + 0x8000 and the result is (t + (t >> 16)) >> 16
+    TARGET_SSE41 inline __m128i
+    mul16(__m128i a, __m128i b)
+    {
+        __m128i lo = _mm_mullo_epi16(a, b);
+        __m128i hi = _mm_add_epi16(_mm_mulhi_epu16(a, b), _mm_srli_epi16(lo, 15));
+        lo = _mm_xor_si128(lo, _mm_set1_epi16(static_cast<short>(0x8000)));
+        __m128i noCarry = _mm_cmpeq_epi16(_mm_adds_epu16(lo, hi), _mm_add_epi16(lo, hi));
+        return _mm_add_epi16(_mm_sub_epi16(hi, _mm_set1_epi16(-1)), noCarry);
+    }
+    
+    TARGET_SSE41 inline __m128i
+    blendValues(__m128i d, __m128i k, __m128i c, __m128i alpha, agg::int8u*)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i mask = _mm_set1_epi16(0xff);
+        __m128i dl = _mm_unpacklo_epi8(d, zero), dh = _mm_unpackhi_epi8(d, zero);
+        __m128i cl = _mm_unpacklo_epi8(c, zero), ch = _mm_unpackhi_epi8(c, zero);
+        __m128i al = mul8(alpha, cl), ah = mul8(alpha, ch);
+        __m128i rl = _mm_sub_epi16(_mm_add_epi16(dl, mul8(_mm_unpacklo_epi8(k, zero), cl)), mul8(dl, al));
+        __m128i rh = _mm_sub_epi16(_mm_add_epi16(dh, mul8(_mm_unpackhi_epi8(k, zero), ch)), mul8(dh, ah));
+        return _mm_packus_epi16(_mm_and_si128(rl, mask), _mm_and_si128(rh, mask));
+    }
+    
+    TARGET_SSE41 inline __m128i
+    blendValues(__m128i d, __m128i k, __m128i c, __m128i alpha, agg::int16u*)
+    {
+        __m128i a = mul16(alpha, c);
+        return _mm_sub_epi16(_mm_add_epi16(d, mul16(k, c)), mul16(d, a));
+    }
+    
+    template <class T>
+    TARGET_SSE41 void
+    sseSpan(T* p, unsigned len, unsigned n, const T* color, T alpha,
+            const agg::int8u* covers, bool line)
+    {
+        const Lanes& l = TheLanes.get(sizeof(T), n);
+        agg::int8u* b = reinterpret_cast<agg::int8u*>(p);
+        if (len >= l.minimum) {
+            alignas(16) agg::int8u bytes[16];
+            loadColor(bytes, color, n);
+            __m128i spread = _mm_load_si128(reinterpret_cast<const __m128i*>(l.spread));
+            __m128i used = _mm_load_si128(reinterpret_cast<const __m128i*>(l.used));
+            __m128i k = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(bytes)),
+                                         _mm_load_si128(reinterpret_cast<const __m128i*>(l.colorSpread)));
+            __m128i alpha16 = _mm_set1_epi16(static_cast<short>(alpha));
+            __m128i lineCover = _mm_shuffle_epi8(_mm_set1_epi8(static_cast<char>(*covers)), spread);
+            bool opaque = alpha == std::numeric_limits<T>::max();
+            for (; len >= l.minimum; len -= l.pixels, b += l.bytes) {
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+                __m128i cover = lineCover;
+                if (!line) {
+                    cover = _mm_shuffle_epi8(loadCovers(covers, l.pixels), spread);
+                    covers += l.pixels;
+                }
+                __m128i r;
+                if (opaque && _mm_movemask_epi8(_mm_cmpeq_epi8(cover, used)) == 0xffff)
+                    r = _mm_blendv_epi8(d, k, used);
+                else
+                    r = blendValues(d, k, cover, alpha16, static_cast<T*>(nullptr));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(b), r);
+            }
+        }
+        p = reinterpret_cast<T*>(b);
+        if (line)
+            scalarLine(p, len, n, color, alpha, *covers);
+        else
+            scalarSpan(p, len, n, color, alpha, covers);
+    }
+    
+    TARGET_AVX2 inline __m256i
+    mul8x2(__m256i a, __m256i b)
+    {
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(0x80));
+        return _mm256_mulhi_epu16(t, _mm256_set1_epi16(257));
+    }
+    
+    TARGET_AVX2 inline __m256i
+    mul16x2(__m256i a, __m256i b)
+    {
+        __m256i lo = _mm256_mullo_epi16(a, b);
+        __m256i hi = _mm256_add_epi16(_mm256_mulhi_epu16(a, b), _mm256_srli_epi16(lo, 15));
+        lo = _mm256_xor_si256(lo, _mm256_set1_epi16(static_cast<short>(0x8000)));
+        __m256i noCarry = _mm256_cmpeq_epi16(_mm256_adds_epu16(lo, hi), _mm256_add_epi16(lo, hi));
+        return _mm256_add_epi16(_mm256_sub_epi16(hi, _mm256_set1_epi16(-1)), noCarry);
+    }
+    
+    TARGET_AVX2 inline __m256i
+    blendValues(__m256i d, __m256i k, __m256i c, __m256i alpha, agg::int8u*)
+    {
+        __m256i zero = _mm256_setzero_si256();
+        __m256i mask = _mm256_set1_epi16(0xff);
+        __m256i dl = _mm256_unpacklo_epi8(d, zero), dh = _mm256_unpackhi_epi8(d, zero);
+        __m256i cl = _mm256_unpacklo_epi8(c, zero), ch = _mm256_unpackhi_epi8(c, zero);
+        __m256i al = mul8x2(alpha, cl), ah = mul8x2(alpha, ch);
+        __m256i rl = _mm256_sub_epi16(_mm256_add_epi16(dl, mul8x2(_mm256_unpacklo_epi8(k, zero), cl)),
+                                      mul8x2(dl, al));
+        __m256i rh = _mm256_sub_epi16(_mm256_add_epi16(dh, mul8x2(_mm256_unpackhi_epi8(k, zero), ch)),
+                                      mul8x2(dh, ah));
+        return _mm256_packus_epi16(_mm256_and_si256(rl, mask), _mm256_and_si256(rh, mask));
+    }
+    
+    TARGET_AVX2 inline __m256i
+    blendValues(__m256i d, __m256i k, __m256i c, __m256i alpha, agg::int16u*)
+    {
+        __m256i a = mul16x2(alpha, c);
+        return _mm256_sub_epi16(_mm256_add_epi16(d, mul16x2(k, c)), mul16x2(d, a));
+    }
+    
+    TARGET_AVX2 inline __m256i
+    pair(__m128i lo, __m128i hi)
+    {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+    
+    // Two 16 byte blocks per step, the second starting right after the last
+    // whole pixel of the first
+    template <class T>
+    TARGET_AVX2 void
+    avxSpan(T* p, unsigned len, unsigned n, const T* color, T alpha,
+            const agg::int8u* covers, bool line)
+    {
+        const Lanes& l = TheLanes.get(sizeof(T), n);
+        agg::int8u* b = reinterpret_cast<agg::int8u*>(p);
+        if (len >= l.pixels + l.minimum) {
+            alignas(16) agg::int8u bytes[16];
+            loadColor(bytes, color, n);
+            __m128i spread1 = _mm_load_si128(reinterpret_cast<const __m128i*>(l.spread));
+            __m128i used1 = _mm_load_si128(reinterpret_cast<const __m128i*>(l.used));
+            __m128i k1 = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(bytes)),
+                                          _mm_load_si128(reinterpret_cast<const __m128i*>(l.colorSpread)));
+            __m256i spread = pair(spread1, spread1);
+            __m256i used = pair(used1, used1);
+            __m256i k = pair(k1, k1);
+            __m256i alpha16 = _mm256_set1_epi16(static_cast<short>(alpha));
+            __m256i lineCover = _mm256_shuffle_epi8(_mm256_set1_epi8(static_cast<char>(*covers)), spread);
+            bool opaque = alpha == std::numeric_limits<T>::max();
+            for (; len >= l.pixels + l.minimum; len -= 2 * l.pixels, b += 2 * l.bytes) {
+                agg::int8u* b2 = b + l.bytes;
+                __m256i d = pair(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(b2)));
+                __m256i cover = lineCover;
+                if (!line) {
+                    cover = _mm256_shuffle_epi8(pair(loadCovers(covers, l.pixels),
+                                                     loadCovers(covers + l.pixels, l.pixels)),
+                                                spread);
+                    covers += 2 * l.pixels;
+                }
+                __m256i r;
+                if (opaque && _mm256_movemask_epi8(_mm256_cmpeq_epi8(cover, used)) == -1)
+                    r = _mm256_blendv_epi8(d, k, used);
+                else
+                    r = blendValues(d, k, cover, alpha16, static_cast<T*>(nullptr));
+                // The first block's padding overlaps the second block, so it
+                // must be stored first
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(b), _mm256_castsi256_si128(r));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(b2), _mm256_extracti128_si256(r, 1));
+            }
+        }
+        sseSpan(reinterpret_cast<T*>(b), len, n, color, alpha, covers, line);
+    }
+#endif
+    
+    inline bool
+    vectorizable(unsigned n)
+    {
+        return n == 1 || n == 3 || n == 4;
+    }
+}
+
+void
+spanBlend::blendSpan(agg::int8u* p, unsigned len, unsigned n,
+                     const agg::int8u* color, agg::int8u alpha, const agg::int8u* covers)
+{
+#ifdef SPANBLEND_X86
+    if (vectorizable(n)) {
+        switch (TheInstructionSet) {
+            case AVX2:  avxSpan(p, len, n, color, alpha, covers, false); return;
+            case SSE41: sseSpan(p, len, n, color, alpha, covers, false); return;
+            default:    break;
+        }
+    }
+#endif
+    scalarSpan(p, len, n, color, alpha, covers);
+}
+
+void
+spanBlend::blendSpan(agg::int16u* p, unsigned len, unsigned n,
+                     const agg::int16u* color, agg::int16u alpha, const agg::int8u* covers)
+{
+#ifdef SPANBLEND_X86
+    if (vectorizable(n)) {
+        switch (TheInstructionSet) {
+            case AVX2:  avxSpan(p, len, n, color, alpha, covers, false); return;
+            case SSE41: sseSpan(p, len, n, color, alpha, covers, false); return;
+            default:    break;
+        }
+    }
+#endif
+    scalarSpan(p, len, n, color, alpha, covers);
+}
+
+void
+spanBlend::blendLine(agg::int8u* p, unsigned len, unsigned n,
+                     const agg::int8u* color, agg::int8u alpha, agg::int8u cover)
+{
+#ifdef SPANBLEND_X86
+    if (vectorizable(n)) {
+        switch (TheInstructionSet) {
+            case AVX2:  avxSpan(p, len, n, color, alpha, &cover, true); return;
+            case SSE41: sseSpan(p, len, n, color, alpha, &cover, true); return;
+            default:    break;
+        }
+    }
+#endif
+    scalarLine(p, len, n, color, alpha, cover);
+}
+
+void
+spanBlend::blendLine(agg::int16u* p, unsigned len, unsigned n,
+                     const agg::int16u* color, agg::int16u alpha, agg::int8u cover)
+{
+#ifdef SPANBLEND_X86
+    if (vectorizable(n)) {
+        switch (TheInstructionSet) {
+            case AVX2:  avxSpan(p, len, n, color, alpha, &cover, true); return;
+            case SSE41: sseSpan(p, len, n, color, alpha, &cover, true); return;
+            default:    break;
+        }
+    }
+#endif
+    scalarLine(p, len, n, color, alpha, cover);
+}
+
+void
+spanBlend::underSpan(agg::int8u* p, agg::int8u* coverage, unsigned len, unsigned n,
+                     const agg::int8u* color, agg::int8u alpha, const agg::int8u* covers)
+{
+    scalarUnder(p, coverage, len, n, color, alpha, covers, 1);
+}
+
+void
+spanBlend::underSpan(agg::int16u* p, agg::int16u* coverage, unsigned len, unsigned n,
+                     const agg::int16u* color, agg::int16u alpha, const agg::int8u* covers)
+{
+    scalarUnder(p, coverage, len, n, color, alpha, covers, 1);
+}
+
+void
+spanBlend::underLine(agg::int8u* p, agg::int8u* coverage, unsigned len, unsigned n,
+                     const agg::int8u* color, agg::int8u alpha, agg::int8u cover)
+{
+    scalarUnder(p, coverage, len, n, color, alpha, &cover, 0);
+}
+
+void
+spanBlend::underLine(agg::int16u* p, agg::int16u* coverage, unsigned len, unsigned n,
+                     const agg::int16u* color, agg::int16u alpha, agg::int8u cover)
+{
+    scalarUnder(p, coverage, len, n, color, alpha, &cover, 0);
+}
+
+const char*
+spanBlend::instructionSet()
+{
+    switch (TheInstructionSet) {
+        case AVX2:  return "AVX2";
+        case SSE41: return "SSE4.1";
+        default:    return "scalar";
+    }
+}
+
+bool
+spanBlend::useInstructionSet(const char* name)
+{
+    InstructionSet set;
+    if (std::strcmp(name, "AVX2") == 0)
+        set = AVX2;
+    else if (std::strcmp(name, "SSE4.1") == 0)
+        set = SSE41;
+    else if (std::strcmp(name, "scalar") == 0)
+        set = Scalar;
+    else
+        return false;
+    if (set > SupportedInstructionSet)
+        return false;
+    TheInstructionSet = set;
+    return true;
+}
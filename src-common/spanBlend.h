@@ -0,0 +1,123 @@
+// spanBlend.h
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// Solid color span blending for the premultiplied pixel formats that
+// aggCanvas renders into. agg blends one pixel at a time; these blend whole
+// spans with SSE4.1 or AVX2, picked at run time by what the CPU supports,
+// and store runs of full coverage of an opaque color directly. Results are
+// bit identical to agg's blenders. Spans can also be composited under the
+// pixels, for drawing back to front.
+
+#ifndef INCLUDE_SPANBLEND_H
+#define INCLUDE_SPANBLEND_H
+
+#include "agg_basics.h"
+
+namespace spanBlend {
+    // Blend a premultiplied color into len pixels of components values each.
+    // color holds the pixel's components in buffer order and alpha is the
+    // color's alpha. Blend spans have one cover per pixel, blend lines have
+    // one cover for all of them.
+    void blendSpan(agg::int8u* p, unsigned len, unsigned components,
+                   const agg::int8u* color, agg::int8u alpha, const agg::int8u* covers);
+    void blendSpan(agg::int16u* p, unsigned len, unsigned components,
+                   const agg::int16u* color, agg::int16u alpha, const agg::int8u* covers);
+    void blendLine(agg::int8u* p, unsigned len, unsigned components,
+                   const agg::int8u* color, agg::int8u alpha, agg::int8u cover);
+    void blendLine(agg::int16u* p, unsigned len, unsigned components,
+                   const agg::int16u* color, agg::int16u alpha, agg::int8u cover);
+    
+    // Composite a premultiplied color under len pixels rather than over them.
+    // coverage holds the alpha each pixel has accumulated so far, one value
+    // per pixel, and grows by what shows through.
+    void underSpan(agg::int8u* p, agg::int8u* coverage, unsigned len, unsigned components,
+                   const agg::int8u* color, agg::int8u alpha, const agg::int8u* covers);
+    void underSpan(agg::int16u* p, agg::int16u* coverage, unsigned len, unsigned components,
+                   const agg::int16u* color, agg::int16u alpha, const agg::int8u* covers);
+    void underLine(agg::int8u* p, agg::int8u* coverage, unsigned len, unsigned components,
+                   const agg::int8u* color, agg::int8u alpha, agg::int8u cover);
+    void underLine(agg::int16u* p, agg::int16u* coverage, unsigned len, unsigned components,
+                   const agg::int16u* color, agg::int16u alpha, agg::int8u cover);
+    
+    // The instruction set in use: "AVX2", "SSE4.1" or "scalar"
+    const char* instructionSet();
+    
+    // Switches to the named instruction set, for testing. Returns false and
+    // changes nothing if the CPU does not support it. Not thread safe.
+    bool useInstructionSet(const char* name);
+}
+
+// A premultiplied agg pixel format whose solid span and line blending go
+// through spanBlend
+template <class PixFmt>
+class spanBlendPixfmt : public PixFmt {
+public:
+    typedef typename PixFmt::color_type color_type;
+    typedef typename PixFmt::value_type value_type;
+    typedef typename PixFmt::pixel_type pixel_type;
+    
+    explicit spanBlendPixfmt(typename PixFmt::rbuf_type& rb)
+    : PixFmt(rb), mCoverage(nullptr) {}
+    
+    // While coverage is set, spans are composited under the pixels instead
+    // of over them. coverage holds the pixels' accumulated alpha in rows of
+    // width() values.
+    void under(value_type* coverage) { mCoverage = coverage; }
+    
+    void blend_hline(int x, int y, unsigned len, const color_type& c, agg::int8u cover)
+    {
+        if (c.is_transparent())
+            return;
+        pixel_type v;
+        v.set(c);
+        if (mCoverage)
+            spanBlend::underLine(this->pix_value_ptr(x, y, len)->c,
+                                 mCoverage + y * this->width() + x, len,
+                                 PixFmt::pix_step, v.c, c.a, cover);
+        else
+            spanBlend::blendLine(this->pix_value_ptr(x, y, len)->c, len, PixFmt::pix_step,
+                                 v.c, c.a, cover);
+    }
+    
+    void blend_solid_hspan(int x, int y, unsigned len, const color_type& c,
+                           const agg::int8u* covers)
+    {
+        if (c.is_transparent())
+            return;
+        pixel_type v;
+        v.set(c);
+        if (mCoverage)
+            spanBlend::underSpan(this->pix_value_ptr(x, y, len)->c,
+                                 mCoverage + y * this->width() + x, len,
+                                 PixFmt::pix_step, v.c, c.a, covers);
+        else
+            spanBlend::blendSpan(this->pix_value_ptr(x, y, len)->c, len, PixFmt::pix_step,
+                                 v.c, c.a, covers);
+    }
+    
+private:
+    value_type* mCoverage;
+};
+
+#endif  // INCLUDE_SPANBLEND_H
@@ -52,6 +52,11 @@
 // Note: only the root parameter token can be zero when there are no parameters.
 // Non-root parameter token nodes will have be a header token with a parameter
 // count of zero if they correspond to a rule with no parameters.
+//
+// Each file has a dictionary of the parameter blocks written to it. A block
+// that was already written is encoded as an index token holding its position
+// in the dictionary. The dictionary is bounded; when it is full the writer
+// emits a reset token and both sides start a new one.
 
 
 #include "stacktype.h"
@@ -61,6 +66,9 @@
 #include "astexpression.h"
 #include <cstring>
 #include <iostream>
+#include <unordered_set>
+#include <unordered_map>
+#include <mutex>
 
 static_assert(sizeof(StackType) == sizeof(double), "StackType must be 8 bytes");
 static_assert(sizeof(StackRule) == sizeof(double), "StackRule must be 8 bytes");
@@ -72,6 +80,158 @@ int StackRule::ParamUID = 0;
 int StackRule::ParamOfInterest = 3;
 #endif
 
+namespace {
+    // Table of interned parameter blocks. It is only added to by the
+    // renderer threads, but blocks are freed on the spill threads too.
+    // Blocks are only shared between the renderers of one design, so
+    // that each block's reference count is only changed by its own
+    // renderer: the type info is part of the key.
+    // Interned blocks are compared by value through their child blocks,
+    // because a child can be an equal copy instead of the same block (one
+    // read back from a temp file, for instance). The hash follows children
+    // down a few levels only, which keeps long chains of parameters cheap
+    // and still gives equal blocks equal hashes.
+    const int HashDepth = 4;
+    
+    uint64_t
+    HashMix(uint64_t h, uint64_t v)
+    {
+        h = (h ^ v) * 0x100000001b3ULL;
+        return h ^ (h >> 29);
+    }
+    
+    uint64_t
+    HashParams(const StackRule* s, int depth)
+    {
+        if (s == nullptr)
+            return 0;
+        uint64_t h = static_cast<uint64_t>(s->mRuleName) << 16 | s->mParamCount;
+        if (s->mParamCount == 0 || depth == 0)
+            return h;
+        for (StackRule::const_iterator it = s->begin(), e = s->end(); it != e; ++it) {
+            if (it.type().mType == AST::RuleType) {
+                h = HashMix(h, HashParams(it->rule, depth - 1));
+            } else {
+                const StackType* st = &*it;
+                for (int i = 0; i < it.type().mTuplesize; ++i) {
+                    uint64_t v;
+                    std::memcpy(&v, st + i, sizeof(v));
+                    h = HashMix(h, v);
+                }
+            }
+        }
+        return h;
+    }
+    
+    bool
+    SameParams(const StackRule* a, const StackRule* b)
+    {
+        if (a == b) return true;
+        if (a == nullptr || b == nullptr) return false;
+        if (a->mRuleName != b->mRuleName || a->mParamCount != b->mParamCount)
+            return false;
+        if (a->mParamCount == 0)
+            return true;
+        if (reinterpret_cast<const StackType*>(a)[1].typeInfo !=
+            reinterpret_cast<const StackType*>(b)[1].typeInfo)
+            return false;
+        for (StackRule::const_iterator ia = a->begin(), ib = b->begin(), e = a->end();
+             ia != e; ++ia, ++ib)
+        {
+            if (ia.type().mType == AST::RuleType) {
+                if (!SameParams(ia->rule, ib->rule))
+                    return false;
+            } else if (std::memcmp(&*ia, &*ib, ia.type().mTuplesize * sizeof(StackType))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    struct ParamHash {
+        size_t operator()(const StackRule* s) const
+        { return static_cast<size_t>(HashParams(s, HashDepth)); }
+    };
+    struct ParamEqual {
+        bool operator()(const StackRule* a, const StackRule* b) const
+        { return SameParams(a, b); }
+    };
+    typedef std::unordered_set<const StackRule*, ParamHash, ParamEqual> ParamTable;
+    
+    ParamTable  InternedParams;
+    std::mutex  InternLock;
+    
+    void
+    Forget(const StackRule* s)
+    {
+        std::lock_guard<std::mutex> lock(InternLock);
+        auto it = InternedParams.find(s);
+        if (it != InternedParams.end() && *it == s)
+            InternedParams.erase(it);
+    }
+    
+    enum tokens_t : uint64_t {
+        TokenMask = 0xff, HeaderToken = 0xff, IndexToken = 0xfe, ResetToken = 0xfd
+    };
+    const size_t MaxDictionary = 1024;
+    
+    struct WriteDictionary {
+        std::unordered_map<const StackRule*, uint64_t> mIndex;
+        std::vector<const StackRule*> mOwned;   // references handed over
+        void clear()
+        {
+            for (const StackRule* s: mOwned)
+                s->release();
+            mOwned.clear();
+            mIndex.clear();
+        }
+    };
+    struct ReadDictionary {
+        std::vector<const StackRule*> mBlocks;  // each holds a reference
+        void clear()
+        {
+            for (const StackRule* s: mBlocks)
+                s->release();
+            mBlocks.clear();
+        }
+    };
+    
+    const int WriteSlot = std::ios_base::xalloc();
+    const int ReadSlot = std::ios_base::xalloc();
+    
+    template <class Dict>
+    void
+    DictionaryEvent(std::ios_base::event ev, std::ios_base& ios, int slot)
+    {
+        if (ev != std::ios_base::erase_event) return;
+        if (Dict* d = static_cast<Dict*>(ios.pword(slot))) {
+            d->clear();
+            delete d;
+            ios.pword(slot) = nullptr;
+        }
+    }
+    
+    template <class Dict>
+    Dict&
+    Dictionary(std::ios_base& ios, int slot)
+    {
+        void*& p = ios.pword(slot);
+        if (p == nullptr) {
+            p = new Dict;
+            ios.register_callback(&DictionaryEvent<Dict>, slot);
+        }
+        return *static_cast<Dict*>(p);
+    }
+    
+    void
+    AddReference(const StackRule* s)
+    {
+        uint32_t count = s->refCount();
+        if (count < StackRule::MaxRefCount - 1)
+            s->setRefCount(count + 1);
+    }
+}
+
 StackRule*
 StackRule::alloc(int name, int size, const AST::ASTparameters* ti)
 {
@@ -79,7 +239,7 @@ StackRule::alloc(int name, int size, const AST::ASTparameters* ti)
     StackType* newrule = new StackType[size ? size + HeaderSize : 1];
     assert((reinterpret_cast<intptr_t>(newrule) & 3) == 0);   // confirm 32-bit alignment
     newrule[0].ruleHeader.mRuleName = static_cast<int16_t>(name);
-    newrule[0].ruleHeader.mRefCount = 0;
+    newrule[0].ruleHeader.setRefCount(0);
     newrule[0].ruleHeader.mParamCount = static_cast<uint16_t>(size);
     if (size)
         newrule[1].typeInfo = ti;
@@ -130,7 +290,10 @@ StackRule::release() const
     if (n == ParamOfInterest)
         (*f).second = ParamOfInterest;
 #endif
-    if (mRefCount == 0) {
+    uint32_t count = refCount();
+    if (count == 0) {
+        if (mParamCount)
+            Forget(this);
         for (const_iterator it = begin(), e = end(); it != e; ++it) {
             if (it.type().mType == AST::RuleType)
                 it->rule->release();
@@ -143,8 +306,8 @@ StackRule::release() const
         return;
     }
     
-    if (mRefCount < MaxRefCount)
-        --mRefCount;
+    if (count < MaxRefCount)
+        setRefCount(count - 1);
 }
 
 // Release arguments on the stack
@@ -167,11 +330,14 @@ StackRule::retain(RendererAST* r) const
     if (n == ParamOfInterest)
         (*f).second = ParamOfInterest;
 #endif
-    if (mRefCount == MaxRefCount)
+    uint32_t count = refCount();
+    if (count == MaxRefCount)
         return;
     
-    ++mRefCount;
-    if (mRefCount == MaxRefCount) {
+    setRefCount(++count);
+    if (count == MaxRefCount) {
+        if (mParamCount)
+            Forget(this);
         r->storeParams(this);
     }
 }
@@ -235,7 +401,7 @@ StackRule::write(std::ostream& os) const
             os.write(reinterpret_cast<const char*>(&*it), it.type().mTuplesize * sizeof(StackType));
             break;
         case AST::RuleType:
-            Write(os, it->rule);
+            Write(os, it->rule, false);
             break;
         default:
             assert(false);
@@ -249,25 +415,92 @@ StackRule::Read(std::istream& is)
 {
     uint64_t size = 0;
     is.read(reinterpret_cast<char*>(&size), sizeof(uint64_t));
-    if (size & 3) {
+    if ((size & TokenMask) == ResetToken) {
+        Dictionary<ReadDictionary>(is, ReadSlot).clear();
+        is.read(reinterpret_cast<char*>(&size), sizeof(uint64_t));
+    }
+    if ((size & TokenMask) == HeaderToken) {
         // Don't know the typeInfo yet, get it during read
         StackRule* s = StackRule::alloc((size >> 24) & 0xffff, (size >> 8) & 0xffff, nullptr);
         s->read(is);
+        AddReference(s);
+        Dictionary<ReadDictionary>(is, ReadSlot).mBlocks.push_back(s);
         return s;
+    } else if ((size & TokenMask) == IndexToken) {
+        ReadDictionary& dict = Dictionary<ReadDictionary>(is, ReadSlot);
+        size_t index = static_cast<size_t>(size >> 8);
+        if (index >= dict.mBlocks.size()) {
+            is.setstate(std::ios_base::failbit);
+            return nullptr;
+        }
+        const StackRule* s = dict.mBlocks[index];
+        AddReference(s);
+        return const_cast<StackRule*>(s);
     } else {
         return reinterpret_cast<StackRule*>(static_cast<intptr_t>(size));
     }
 }
 
 void
-StackRule::Write(std::ostream& os, const StackRule* s)
+StackRule::Write(std::ostream& os, const StackRule* s, bool release)
 {
-    if (s == nullptr || s->mRefCount == MaxRefCount) {
+    if (s == nullptr || s->refCount() == MaxRefCount) {
         uint64_t p = static_cast<uint64_t>(reinterpret_cast<intptr_t>(s));
         os.write(reinterpret_cast<const char*>(&p), sizeof(uint64_t));
-    } else {
-        s->write(os);
+        return;
+    }
+    
+    WriteDictionary& dict = Dictionary<WriteDictionary>(os, WriteSlot);
+    auto found = dict.mIndex.find(s);
+    if (found != dict.mIndex.end()) {
+        uint64_t token = found->second << 8 | IndexToken;
+        os.write(reinterpret_cast<const char*>(&token), sizeof(uint64_t));
+        if (release)
+            s->release();
+        return;
+    }
+    
+    if (dict.mIndex.size() >= MaxDictionary) {
+        dict.clear();
+        uint64_t token = ResetToken;
+        os.write(reinterpret_cast<const char*>(&token), sizeof(uint64_t));
+    }
+    s->write(os);
+    // Added after any child blocks, in the same order as the reader
+    dict.mIndex.emplace(s, dict.mIndex.size());
+    if (release)
+        dict.mOwned.push_back(s);
+}
+
+void
+StackRule::ResetDictionary(std::ostream& os)
+{
+    Dictionary<WriteDictionary>(os, WriteSlot).clear();
+}
+
+void
+StackRule::ResetDictionary(std::istream& is)
+{
+    Dictionary<ReadDictionary>(is, ReadSlot).clear();
+}
+
+const StackRule*
+StackRule::Intern(StackRule* s, RendererAST* r)
+{
+    if (r == nullptr || s == nullptr || s->mParamCount == 0)
+        return s;
+    
+    const StackRule* shared = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(InternLock);
+        auto ins = InternedParams.insert(s);
+        if (ins.second)
+            return s;
+        shared = *ins.first;
     }
+    shared->retain(r);
+    s->release();
+    return shared;
 }
 
 static void
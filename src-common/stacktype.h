@@ -110,7 +110,13 @@ struct StackRule {
     
     int16_t     mRuleName;
     uint16_t    mParamCount;
-    mutable uint32_t    mRefCount;
+    mutable uint32_t    mRefCount;      // use refCount() and setRefCount()
+    
+    uint32_t    refCount() const;
+    void        setRefCount(uint32_t count) const;
+        // The count is only changed by the renderer that owns the block, but
+        // the spill writer thread tests it for MaxRefCount, so it is read and
+        // written with relaxed atomic loads and stores.
     
     bool operator==(const StackRule& o) const;
     static bool Equal(const StackRule* a, const StackRule* b);
@@ -120,8 +126,19 @@ struct StackRule {
     void        release() const;
     void        retain(RendererAST* r) const;
     
+    static const StackRule* Intern(StackRule* s, RendererAST* r);
+        // Returns the shared block equal to s, releasing s, or s itself if
+        // there is none yet. s must not be modified afterwards.
+    
     static StackRule*  Read(std::istream& is);
-    static void        Write(std::ostream& os, const StackRule* s);
+    static void        Write(std::ostream& os, const StackRule* s, bool release = false);
+        // If release is true then the caller's reference to s is handed to
+        // the stream, which holds it until the stream is closed.
+    static void        ResetDictionary(std::ostream& os);
+        // Start a new dictionary for the following blocks, for files that
+        // are not read sequentially from the beginning
+    static void        ResetDictionary(std::istream& is);
+        // The same when reading, after seeking to such a block
     
     void        evalArgs(RendererAST* rti, const AST::ASTexpression* arguments,
                          const StackRule* parent);
@@ -175,6 +192,26 @@ union StackType {
     { return const_iterator(); }
 };
 
+inline uint32_t
+StackRule::refCount() const
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&mRefCount, __ATOMIC_RELAXED);
+#else
+    return *static_cast<const volatile uint32_t*>(&mRefCount);
+#endif
+}
+
+inline void
+StackRule::setRefCount(uint32_t count) const
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&mRefCount, count, __ATOMIC_RELAXED);
+#else
+    *static_cast<volatile uint32_t*>(&mRefCount) = count;
+#endif
+}
+
 inline StackRule::iterator
 StackRule::begin()
 {
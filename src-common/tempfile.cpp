@@ -28,8 +28,11 @@
 
 
 #include "tempfile.h"
+#include "traceLog.h"
 
 #include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #ifndef _WIN32
 #include <unistd.h>
 #endif
@@ -38,6 +41,7 @@
 
 using namespace std;
 
+std::atomic<unsigned long long> TempFile::BytesWritten(0);
 
 std::ostream*
 TempFile::forWrite()
@@ -66,7 +70,7 @@ TempFile::TempFile(AbstractSystem* system, AbstractSystem::TempType t, const cha
 
 TempFile::TempFile(TempFile&& from) NOEXCEPT
 : mSystem(from.mSystem), mPath(std::move(from.mPath)), mType(std::move(from.mType)),
-  mNum(from.mNum), mWritten(from.mWritten)
+  mTypeName(std::move(from.mTypeName)), mNum(from.mNum), mWritten(from.mWritten)
 {
     // Prevent old TempFile from triggering an unlink
     from.mWritten = false;
@@ -100,6 +104,12 @@ void
 TempFile::erase()
 {
     mSystem->message("Deleting %s temp file %d", mTypeName.c_str(), mNum);
+    struct stat sb;
+    if (stat(mPath.c_str(), &sb) == 0) {
+        unsigned long long total =
+            BytesWritten += static_cast<unsigned long long>(sb.st_size);
+        TraceLog::Counter("temp bytes", "written", static_cast<double>(total));
+    }
     if (unlink(mPath.c_str()))
         mSystem->message("Failed to delete %s, %d", mPath.c_str(), errno);
 }
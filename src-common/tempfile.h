@@ -32,6 +32,7 @@
 
 #include "cfdg.h"
 #include "mynoexcept.h"
+#include <atomic>
 
 class TempFile
 {
@@ -48,6 +49,10 @@ public:
     TempFile(const TempFile&) = delete;
     TempFile& operator=(const TempFile&) = delete;
     ~TempFile();
+    
+    static std::atomic<unsigned long long> BytesWritten;
+        // total size of all temp files, counted when they are deleted, on
+        // any thread
 
 private:
     AbstractSystem*     mSystem;
@@ -0,0 +1,278 @@
+// test-ffCanvas.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// The unit tests build ffCanvas.cpp against the FFmpeg headers in src-ffmpeg
+// and the stand-in for libavcodec and libavformat here, which records the
+// frames that the encoder thread hands it instead of encoding them. This
+// tests the queueing and the error handling of the canvas, not FFmpeg.
+
+#define __STDC_CONSTANT_MACROS 1
+
+#include "test.h"
+#include "ffCanvas.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#undef PixelFormat
+}
+
+namespace {
+    // What the stub library has been asked to do, and how it answers
+    struct StubAV {
+        std::mutex                  mutex;
+        std::condition_variable     cond;
+        std::vector<int>            encoded;    // first byte of each frame
+        int                         written;
+        int                         failAt;     // encode call that fails, from 1
+        bool                        hold;       // encoding waits until this is cleared
+        bool                        trailer;
+        int                         contexts;   // allocated and not freed
+        AVFrame                     codedFrame;
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            encoded.clear();
+            written = 0;
+            failAt = 0;
+            hold = false;
+            trailer = false;
+            contexts = 0;
+            std::memset(&codedFrame, 0, sizeof(codedFrame));
+        }
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hold = false;
+            cond.notify_all();
+        }
+        void waitForEncode(size_t calls)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&]() { return encoded.size() >= calls; });
+        }
+    };
+
+    StubAV Stub;
+
+    const int Width = 16;
+    const int Height = 8;
+
+    // Draws a frame that is all one shade of gray
+    void
+    frame(ffCanvas& canvas, double gray)
+    {
+        canvas.start(true, agg::rgba(gray, gray, gray, 1.0), Width, Height);
+        canvas.end();
+    }
+}
+
+extern "C" {
+    void avcodec_register_all(void) { }
+    void av_register_all(void) { }
+
+    int
+    avformat_alloc_output_context2(AVFormatContext** ctx, AVOutputFormat*,
+                                   const char*, const char*)
+    {
+        *ctx = static_cast<AVFormatContext*>(std::calloc(1, sizeof(AVFormatContext)));
+        std::lock_guard<std::mutex> lock(Stub.mutex);
+        ++Stub.contexts;
+        return 0;
+    }
+
+    void
+    avformat_free_context(AVFormatContext* s)
+    {
+        for (unsigned i = 0; i < s->nb_streams; ++i) {
+            std::free(s->streams[i]->codec);
+            std::free(s->streams[i]);
+        }
+        std::free(s->streams);
+        std::free(s);
+        std::lock_guard<std::mutex> lock(Stub.mutex);
+        --Stub.contexts;
+    }
+
+    AVCodec*
+    avcodec_find_encoder(enum AVCodecID)
+    {
+        static AVCodec codec;
+        return &codec;
+    }
+
+    AVStream*
+    avformat_new_stream(AVFormatContext* s, AVCodec*)
+    {
+        AVStream* stream = static_cast<AVStream*>(std::calloc(1, sizeof(AVStream)));
+        stream->codec = static_cast<AVCodecContext*>(std::calloc(1, sizeof(AVCodecContext)));
+        stream->codec->coded_frame = &Stub.codedFrame;
+        stream->index = static_cast<int>(s->nb_streams);
+        s->streams = static_cast<AVStream**>(std::realloc(s->streams,
+                                    (s->nb_streams + 1) * sizeof(AVStream*)));
+        s->streams[s->nb_streams++] = stream;
+        return stream;
+    }
+
+    int avcodec_get_context_defaults3(AVCodecContext*, const AVCodec*) { return 0; }
+    int avcodec_open2(AVCodecContext*, const AVCodec*, AVDictionary**) { return 0; }
+
+    AVFrame*
+    avcodec_alloc_frame(void)
+    {
+        return static_cast<AVFrame*>(std::calloc(1, sizeof(AVFrame)));
+    }
+
+    void av_free(void* ptr) { std::free(ptr); }
+
+    int avio_open(AVIOContext** s, const char*, int) { *s = nullptr; return 0; }
+    int avio_close(AVIOContext*) { return 0; }
+    int avformat_write_header(AVFormatContext*, AVDictionary**) { return 0; }
+
+    void
+    av_init_packet(AVPacket* pkt)
+    {
+        std::memset(pkt, 0, sizeof(AVPacket));
+    }
+
+    void av_free_packet(AVPacket*) { }
+
+    // A null frame flushes the encoder, which has nothing buffered
+    int
+    avcodec_encode_video2(AVCodecContext*, AVPacket* pkt, const AVFrame* frame,
+                          int* got_output)
+    {
+        *got_output = 0;
+        if (!frame)
+            return 0;
+        std::unique_lock<std::mutex> lock(Stub.mutex);
+        Stub.encoded.push_back(frame->data[0][0]);
+        Stub.cond.notify_all();
+        Stub.cond.wait(lock, []() { return !Stub.hold; });
+        if (static_cast<int>(Stub.encoded.size()) == Stub.failAt)
+            return -1;
+        static uint8_t data[4];
+        pkt->data = data;
+        pkt->size = sizeof(data);
+        *got_output = 1;
+        return 0;
+    }
+
+    int
+    av_write_frame(AVFormatContext*, AVPacket*)
+    {
+        std::lock_guard<std::mutex> lock(Stub.mutex);
+        ++Stub.written;
+        return 0;
+    }
+
+    int
+    av_write_trailer(AVFormatContext*)
+    {
+        std::lock_guard<std::mutex> lock(Stub.mutex);
+        Stub.trailer = true;
+        return 0;
+    }
+}
+
+TEST(ffCanvas, encodesInOrder) {
+    Stub.reset();
+    {
+        ffCanvas canvas("test.mov", aggCanvas::Gray8_Blend, Width, Height, 15);
+        CHECK(canvas.mErrorMsg == nullptr);
+        for (int i = 1; i <= 5; ++i)
+            frame(canvas, i * 0.15);
+        CHECK(canvas.mErrorMsg == nullptr);
+    }
+    CHECK_SAME(5u, Stub.encoded.size());
+    for (size_t i = 1; i < Stub.encoded.size(); ++i)
+        CHECK(Stub.encoded[i - 1] < Stub.encoded[i]);
+    CHECK_SAME(5, Stub.written);
+    CHECK(Stub.trailer);
+    CHECK_SAME(0, Stub.contexts);
+}
+
+TEST(ffCanvas, shutdownWithQueuedFrame) {
+    Stub.reset();
+    Stub.hold = true;
+    std::unique_ptr<ffCanvas> canvas(new ffCanvas("test.mov", aggCanvas::Gray8_Blend,
+                                                  Width, Height, 15));
+    CHECK(canvas->mErrorMsg == nullptr);
+
+    // The first frame is held in the encoder, so the second one is still
+    // queued when the canvas is deleted. Both have to be written, in order,
+    // before the trailer.
+    frame(*canvas, 0.2);
+    Stub.waitForEncode(1);
+    frame(*canvas, 0.6);
+    CHECK(canvas->mErrorMsg == nullptr);
+    std::thread release([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Stub.release();
+    });
+    canvas.reset();
+    release.join();
+
+    CHECK_SAME(2u, Stub.encoded.size());
+    CHECK(Stub.encoded[0] < Stub.encoded[1]);
+    CHECK_SAME(2, Stub.written);
+    CHECK(Stub.trailer);
+    CHECK_SAME(0, Stub.contexts);
+}
+
+TEST(ffCanvas, encoderError) {
+    Stub.reset();
+    Stub.failAt = 1;
+    std::unique_ptr<ffCanvas> canvas(new ffCanvas("test.mov", aggCanvas::Gray8_Blend,
+                                                  Width, Height, 15));
+    CHECK(canvas->mErrorMsg == nullptr);
+
+    // The second frame gets the spare buffer while the first one fails. The
+    // third has to wait for the buffer of the first one, which comes back
+    // with the error.
+    frame(*canvas, 0.2);
+    frame(*canvas, 0.4);
+    frame(*canvas, 0.6);
+    CHECK(canvas->mError);
+    CHECK_VALID(canvas->mErrorMsg);
+    CHECK(std::strcmp(canvas->mErrorMsg, "video encoding failed") == 0);
+
+    // Frames after an error are dropped, not encoded
+    frame(*canvas, 0.8);
+    canvas.reset();
+    CHECK_SAME(1u, Stub.encoded.size());
+    CHECK_SAME(0, Stub.written);
+    CHECK(!Stub.trailer);
+    CHECK_SAME(0, Stub.contexts);
+}
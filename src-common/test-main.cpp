@@ -24,7 +24,42 @@
 
 #include "test.h"
 
-int main()
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// With no arguments all of the unit tests are run. With -b the benchmarks
+// are run instead: -b [-r repetitions] [filter]
+
+int main(int argc, char* argv[])
 {
-	return Test::runAll(false, false) ? 0 : 1;
+	if (argc < 2)
+		return Test::runAll(false, false) ? 0 : 1;
+
+	const char* filter = 0;
+	unsigned repetitions = 5;
+	bool bench = false;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "-b") == 0) {
+			bench = true;
+		} else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+			repetitions = static_cast<unsigned>(std::atoi(argv[++i]));
+		} else if (argv[i][0] != '-' && filter == 0) {
+			filter = argv[i];
+		} else {
+			bench = false;
+			break;
+		}
+	}
+	if (!bench) {
+		std::fprintf(stderr, "Usage: %s [-b [-r repetitions] [filter]]\n", argv[0]);
+		return 2;
+	}
+
+	if (!Test::runBenchmarks(filter, repetitions)) {
+		std::fprintf(stderr, "No benchmarks match %s\n", filter);
+		return 1;
+	}
+	return 0;
 }
@@ -0,0 +1,82 @@
+// test-pathIterator.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+
+#include "test.h"
+#include "pathIterator.h"
+#include "CmdInfo.h"
+#include "agg_path_storage.h"
+#include "agg_trans_affine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    agg::point_d
+    cubic(const agg::point_d* c, double t)
+    {
+        double u = 1.0 - t;
+        return agg::point_d(u * u * u * c[0].x + 3 * u * u * t * c[1].x +
+                            3 * u * t * t * c[2].x + t * t * t * c[3].x,
+                            u * u * u * c[0].y + 3 * u * u * t * c[1].y +
+                            3 * u * t * t * c[2].y + t * t * t * c[3].y);
+    }
+}
+
+// A filled cubic that turns in x and in y between its end points: the bounds
+// are the curve's own, not its control points'
+TEST(pathIterator, fillCurveBounds) {
+    agg::point_d c[4] = { {0.0, 0.0}, {-1.0, 2.0}, {3.0, 2.5}, {2.0, 0.5} };
+    agg::path_storage path;
+    path.move_to(c[0].x, c[0].y);
+    path.curve4(c[1].x, c[1].y, c[2].x, c[2].y, c[3].x, c[3].y);
+    path.end_poly(agg::path_flags_close);
+    AST::CommandInfo attr(&path);
+    
+    agg::trans_affine tr = agg::trans_affine_rotation(0.3) *
+                           agg::trans_affine_scaling(40.0, 25.0);
+    agg::point_d tc[4];
+    for (int i = 0; i < 4; ++i) {
+        tc[i] = c[i];
+        tr.transform(&tc[i].x, &tc[i].y);
+    }
+    double sminx = tc[0].x, sminy = tc[0].y, smaxx = tc[0].x, smaxy = tc[0].y;
+    for (int i = 1; i <= 100000; ++i) {
+        agg::point_d p = cubic(tc, i / 100000.0);
+        sminx = std::min(sminx, p.x); smaxx = std::max(smaxx, p.x);
+        sminy = std::min(sminy, p.y); smaxy = std::max(smaxy, p.y);
+    }
+    
+    pathIterator iter;
+    double minx, miny, maxx, maxy, area;
+    agg::point_d cent;
+    CHECK(iter.boundingRect(tr, attr, minx, miny, maxx, maxy, 1.0, &cent, &area));
+    const double eps = 1e-6;
+    CHECK(minx <= sminx && minx > sminx - eps);
+    CHECK(miny <= sminy && miny > sminy - eps);
+    CHECK(maxx >= smaxx && maxx < smaxx + eps);
+    CHECK(maxy >= smaxy && maxy < smaxy + eps);
+    CHECK(area > 0.0);
+    CHECK(cent.x > minx && cent.x < maxx && cent.y > miny && cent.y < maxy);
+}
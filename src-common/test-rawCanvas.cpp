@@ -0,0 +1,325 @@
+// test-rawCanvas.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+
+#include "test.h"
+#include "testSystem.h"
+#include "rawCanvas.h"
+#include "agg_trans_affine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    const int Width = 100;      // wider than the longest QOI run
+    const int Height = 60;
+
+    // An image decoded to 8-bit RGBA that isn't premultiplied
+    struct Image {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+
+        const unsigned char* at(int x, int y) const
+        { return pixels.data() + (static_cast<size_t>(y) * width + x) * 4; }
+    };
+
+    std::string
+    readFile(const std::string& path)
+    {
+        std::ifstream f(path.c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(f),
+                           std::istreambuf_iterator<char>());
+    }
+
+    int
+    narrow(const unsigned char* sample, bool wide)
+    {
+        return wide ? ((sample[0] << 8 | sample[1]) + 128) / 257 : sample[0];
+    }
+
+    // PGM, PPM or PAM
+    bool
+    decodePNM(const std::string& data, Image& img)
+    {
+        std::istringstream in(data);
+        std::string magic;
+        int depth = 0, maxval = 0;
+        in >> magic;
+        if (magic == "P7") {
+            std::string key;
+            while (in >> key && key != "ENDHDR") {
+                if (key == "WIDTH") in >> img.width;
+                else if (key == "HEIGHT") in >> img.height;
+                else if (key == "DEPTH") in >> depth;
+                else if (key == "MAXVAL") in >> maxval;
+                else in >> key;
+            }
+        } else {
+            in >> img.width >> img.height >> maxval;
+            depth = magic == "P5" ? 1 : magic == "P6" ? 3 : 0;
+        }
+        in.get();       // the single whitespace before the samples
+        if (!in || !depth || (maxval != 255 && maxval != 65535))
+            return false;
+
+        bool wide = maxval == 65535;
+        size_t sample = wide ? 2 : 1;
+        size_t begin = static_cast<size_t>(in.tellg());
+        size_t count = static_cast<size_t>(img.width) * img.height;
+        if (data.size() != begin + count * depth * sample)
+            return false;
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(data.data()) + begin;
+        img.pixels.resize(count * 4);
+        for (size_t i = 0; i < count; ++i, src += depth * sample) {
+            unsigned char* px = img.pixels.data() + i * 4;
+            for (int c = 0; c < 3; ++c)
+                px[c] = static_cast<unsigned char>(narrow(src + (depth < 3 ? 0 : c) * sample, wide));
+            px[3] = depth == 4 ? static_cast<unsigned char>(narrow(src + 3 * sample, wide)) : 255;
+        }
+        return true;
+    }
+
+    // The Quite OK Image format, from the specification at qoiformat.org
+    bool
+    decodeQOI(const std::string& data, Image& img)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+        const unsigned char* end = p + data.size();
+        if (data.size() < 22 || data.compare(0, 4, "qoif") != 0)
+            return false;
+        img.width = p[4] << 24 | p[5] << 16 | p[6] << 8 | p[7];
+        img.height = p[8] << 24 | p[9] << 16 | p[10] << 8 | p[11];
+        p += 14;
+        end -= 8;
+        static const unsigned char Padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        if (!std::equal(Padding, Padding + 8, end))
+            return false;
+
+        unsigned char index[64][4] = {};
+        unsigned char px[4] = { 0, 0, 0, 255 };
+        size_t count = static_cast<size_t>(img.width) * img.height;
+        img.pixels.resize(count * 4);
+        int run = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (run) {
+                --run;
+            } else {
+                if (p >= end)
+                    return false;
+                int op = *p++;
+                if (op == 0xfe) {
+                    px[0] = p[0]; px[1] = p[1]; px[2] = p[2];
+                    p += 3;
+                } else if (op == 0xff) {
+                    px[0] = p[0]; px[1] = p[1]; px[2] = p[2]; px[3] = p[3];
+                    p += 4;
+                } else if ((op & 0xc0) == 0x00) {
+                    std::copy(index[op], index[op] + 4, px);
+                } else if ((op & 0xc0) == 0x40) {
+                    px[0] += ((op >> 4) & 3) - 2;
+                    px[1] += ((op >> 2) & 3) - 2;
+                    px[2] += (op & 3) - 2;
+                } else if ((op & 0xc0) == 0x80) {
+                    int dg = (op & 0x3f) - 32;
+                    int b = *p++;
+                    px[0] += dg + ((b >> 4) & 0xf) - 8;
+                    px[1] += dg;
+                    px[2] += dg + (b & 0xf) - 8;
+                } else {
+                    run = op & 0x3f;
+                }
+                int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+                std::copy(px, px + 4, index[hash]);
+            }
+            std::copy(px, px + 4, img.pixels.data() + i * 4);
+        }
+        return p == end;
+    }
+
+    // The canvas pixels, premultiplied and in native byte order
+    bool
+    decodeRGBA(const std::string& data, bool wide, Image& img)
+    {
+        size_t sample = wide ? 2 : 1;
+        size_t count = static_cast<size_t>(Width) * Height;
+        if (data.size() != count * 4 * sample)
+            return false;
+        img.width = Width;
+        img.height = Height;
+        img.pixels.resize(count * 4);
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(data.data());
+        unsigned max = wide ? 65535 : 255;
+        for (size_t i = 0; i < count; ++i) {
+            unsigned v[4];
+            for (int c = 0; c < 4; ++c, src += sample) {
+                if (wide) {
+                    unsigned short w;
+                    std::copy(src, src + 2, reinterpret_cast<unsigned char*>(&w));
+                    v[c] = w;
+                } else {
+                    v[c] = *src;
+                }
+            }
+            unsigned char* px = img.pixels.data() + i * 4;
+            for (int c = 0; c < 4; ++c) {
+                unsigned straight = c == 3 ? v[3] : v[3] ? (v[c] * max + v[3] / 2) / v[3] : 0;
+                px[c] = static_cast<unsigned char>(wide ? (straight + 128) / 257 : straight);
+            }
+        }
+        return true;
+    }
+
+    // A background, a solid square and a translucent circle over it, so
+    // there are long runs, small and large steps, and edges. A banded canvas
+    // gets every shape in every band, like the renderer without its index.
+    void
+    draw(rawCanvas& canvas, bool clearBackground)
+    {
+        agg::rgba back = clearBackground ? agg::rgba(0, 0, 0, 0) : agg::rgba(0.2, 0.4, 0.6, 1.0);
+        canvas.start(true, back, Width, Height);
+        agg::trans_affine square = agg::trans_affine_scaling(30.0);
+        square *= agg::trans_affine_translation(30.0, 30.0);
+        agg::trans_affine circle = agg::trans_affine_scaling(40.0);
+        circle *= agg::trans_affine_translation(60.0, 30.0);
+        int bands = canvas.bands();
+        for (int band = 0; band < bands; ++band) {
+            if (bands > 1)
+                canvas.startBand(band);
+            canvas.square(RGBA8(agg::rgba(0.9, 0.1, 0.3, 1.0)), square);
+            canvas.circle(RGBA8(agg::rgba(0.1, 0.8, 0.2, 0.5)), circle);
+            if (bands > 1)
+                canvas.endBand(band);
+        }
+        canvas.end();
+    }
+
+    bool
+    write(rawCanvas::Format format, aggCanvas::PixelFormat pixfmt, const std::string& path,
+          bool clearBackground, std::size_t bandBytes = 0)
+    {
+        std::remove(path.c_str());
+        rawCanvas canvas(format, path.c_str(), true, Width, Height, pixfmt,
+                         false, 0, 0, false, nullptr, 1, 1, bandBytes);
+        if (bandBytes && canvas.bands() < 2)
+            return false;
+        draw(canvas, clearBackground);
+        return !canvas.mError;
+    }
+
+    int
+    maxDifference(const Image& a, const Image& b)
+    {
+        int diff = 0;
+        for (size_t i = 0; i < a.pixels.size() && i < b.pixels.size(); ++i)
+            diff = std::max(diff, std::abs(a.pixels[i] - b.pixels[i]));
+        return diff;
+    }
+}
+
+TEST(rawCanvas, roundTrip) {
+    TestSystem system;
+    std::string dir = system.tempFileDirectory();
+    if (dir.empty() || dir.back() != '/')
+        dir.push_back('/');
+    std::string path = dir + "cfdg-test-raw";
+
+    const aggCanvas::PixelFormat formats[] = {
+        aggCanvas::Gray8_Blend, aggCanvas::RGB8_Blend, aggCanvas::RGBA8_Blend,
+        aggCanvas::RGB16_Blend, aggCanvas::RGBA16_Blend
+    };
+    for (aggCanvas::PixelFormat pixfmt: formats) {
+        bool wide = (pixfmt & aggCanvas::Has_16bit_Color) != 0;
+        bool alpha = pixfmt == aggCanvas::RGBA8_Blend || pixfmt == aggCanvas::RGBA16_Blend;
+
+        Image pnm, qoi, raw;
+        CHECK(write(rawCanvas::PNM, pixfmt, path, alpha));
+        CHECK(decodePNM(readFile(path), pnm));
+        CHECK(write(rawCanvas::QOI, pixfmt, path, alpha));
+        CHECK(decodeQOI(readFile(path), qoi));
+        CHECK(write(rawCanvas::RGBA, pixfmt, path, alpha));
+        CHECK(decodeRGBA(readFile(path), wide, raw));
+        std::remove(path.c_str());
+
+        CHECK_SAME(Width, pnm.width);
+        CHECK_SAME(Height, pnm.height);
+        CHECK_SAME(Width, qoi.width);
+        CHECK_SAME(Height, qoi.height);
+
+        // QOI has the same 8-bit samples as PNM, raw RGBA is premultiplied
+        // and agrees within rounding once it is demultiplied
+        CHECK(pnm.pixels == qoi.pixels);
+        CHECK(maxDifference(pnm, raw) <= 1);
+
+        // The background in the corner, and the square clear of the circle
+        const unsigned char* corner = pnm.at(0, 0);
+        const unsigned char* square = pnm.at(20, 30);
+        if (alpha) {
+            CHECK_SAME(0, static_cast<int>(corner[3]));
+        } else if (pixfmt == aggCanvas::Gray8_Blend) {
+            CHECK(corner[0] == corner[1] && corner[1] == corner[2]);
+            CHECK_SAME(255, static_cast<int>(corner[3]));
+        } else {
+            CHECK(std::abs(corner[0] - 51) <= 1);
+            CHECK(std::abs(corner[1] - 102) <= 1);
+            CHECK(std::abs(corner[2] - 153) <= 1);
+            CHECK_SAME(255, static_cast<int>(corner[3]));
+        }
+        if (pixfmt != aggCanvas::Gray8_Blend) {
+            CHECK(std::abs(square[0] - 230) <= 1);
+            CHECK(std::abs(square[1] - 26) <= 1);
+            CHECK(std::abs(square[2] - 77) <= 1);
+        }
+        CHECK_SAME(255, static_cast<int>(square[3]));
+    }
+}
+
+TEST(rawCanvas, bands) {
+    TestSystem system;
+    std::string dir = system.tempFileDirectory();
+    if (dir.empty() || dir.back() != '/')
+        dir.push_back('/');
+    std::string path = dir + "cfdg-test-raw";
+
+    // Seven rows of 16-bit RGBA to a band, so the last band is short and
+    // the shapes cross several band edges. Each format has to come out of
+    // the bands exactly as it does from the whole image.
+    const std::size_t BandBytes = static_cast<std::size_t>(Width) * 8 * 7;
+    const rawCanvas::Format formats[] = { rawCanvas::PNM, rawCanvas::QOI, rawCanvas::RGBA };
+    for (rawCanvas::Format format: formats) {
+        CHECK(write(format, aggCanvas::RGBA16_Blend, path, true));
+        std::string whole = readFile(path);
+        CHECK(write(format, aggCanvas::RGBA16_Blend, path, true, BandBytes));
+        std::string banded = readFile(path);
+        std::remove(path.c_str());
+
+        CHECK(!whole.empty());
+        CHECK(whole == banded);
+    }
+}
@@ -0,0 +1,120 @@
+// test-shapeSTL.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+
+#include "test.h"
+#include "testSystem.h"
+#include "shapeSTL.h"
+#include "stacktype.h"
+#include "primShape.h"
+
+#include <memory>
+
+namespace {
+    const int Frames = 3;
+
+    struct NumberType {
+        AST::ASTparameters  number;
+        NumberType() { number.emplace_back("number", 1, yy::location()); }
+    };
+
+    StackRule*
+    numberBlock(const NumberType& types, double value)
+    {
+        StackRule* s = StackRule::alloc(1, 1, &types.number);
+        reinterpret_cast<StackType*>(s)[StackRule::HeaderSize].number = value;
+        return s;
+    }
+
+    double
+    number(const StackRule* s)
+    {
+        return reinterpret_cast<const StackType*>(s)[StackRule::HeaderSize].number;
+    }
+
+    // A path shape alive in frame + 1 only, holding a reference to params
+    FinishedShape
+    frameShape(int frame, int order, const StackRule* params)
+    {
+        FinishedShape s;
+        s.mShapeType = primShape::circleType;
+        s.mOrder = order;
+        s.mTime.tbegin = frame + 0.25;
+        s.mTime.tend = frame + 0.75;
+        PathState* state = new PathState;
+        state->mParameters = params;
+        s.mPath.reset(state);
+        params->retain(nullptr);
+        return s;
+    }
+}
+
+TEST(shapeSTL, frameIndexOutOfOrder) {
+    NumberType types;
+    TestSystem system;
+    unsigned params = Renderer::ParamCount;
+
+    // Each frame fills a block of its own and all of its shapes share one
+    // parameter block, so every block after the first read has to start
+    // with an empty dictionary to read back the right parameters.
+    agg::trans_affine_time time;
+    time.tbegin = 0.0;
+    time.tend = Frames;
+    FrameIndex index;
+    bool ok = index.start(time, Frames,
+                          TempFile(&system, AbstractSystem::ShapeTemp, "frames", 1));
+    CHECK(ok);
+    const size_t PerFrame = FrameIndex::BlockShapes;
+    for (int frame = 0; frame < Frames; ++frame) {
+        const StackRule* p = numberBlock(types, frame);
+        for (size_t i = 0; i < PerFrame; ++i)
+            ok = index.add(frameShape(frame, static_cast<int>(frame * PerFrame + i), p)) && ok;
+        p->release();
+    }
+    ok = index.finish() && ok;
+    CHECK(ok);
+    CHECK(!index.accumulates());
+
+    std::unique_ptr<std::istream> f(index.openForRead());
+    CHECK_VALID(f.get());
+    for (int frame: {3, 1, 2, 3}) {
+        size_t count = 0;
+        bool inOrder = true, inFrame = true, rightParams = true;
+        ok = index.forFrame(frame, 0, [&](const FinishedShape& s) {
+            size_t order = (frame - 1) * PerFrame + count++;
+            inOrder = inOrder && s.mOrder == static_cast<int>(order);
+            inFrame = inFrame && s.mTime.tbegin == frame - 0.75;
+            rightParams = rightParams && s.mPath && s.mPath->mParameters &&
+                number(s.mPath->mParameters) == frame - 1;
+        }, f.get());
+        CHECK(ok);
+        CHECK_SAME(PerFrame, count);
+        CHECK(inOrder);
+        CHECK(inFrame);
+        CHECK(rightParams);
+    }
+    f.reset();
+    index.clear();
+    CHECK_SAME(params, static_cast<unsigned>(Renderer::ParamCount));
+}
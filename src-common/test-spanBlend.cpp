@@ -0,0 +1,153 @@
+// test-spanBlend.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+
+#include "test.h"
+#include "spanBlend.h"
+#include "Rand64.h"
+#include "agg_pixfmt_gray.h"
+#include "agg_pixfmt_rgb.h"
+#include "agg_pixfmt_rgba.h"
+#include "agg_rendering_buffer.h"
+
+#include <limits>
+#include <vector>
+
+namespace {
+    const unsigned Width = 67;      // odd, so spans end part way into a vector
+    const int Rounds = 4000;
+    
+    template <class T>
+    T
+    randomValue(Rand64& r, unsigned max = std::numeric_limits<T>::max())
+    {
+        return static_cast<T>(r.getInt(0, max));
+    }
+    
+    agg::int8u
+    randomCover(Rand64& r)
+    {
+        // full and empty covers take their own paths, so favor them
+        switch (r.getInt(0, 3)) {
+            case 0:  return 0;
+            case 1:  return agg::cover_mask;
+            default: return randomValue<agg::int8u>(r);
+        }
+    }
+    
+    // Random premultiplied colors, opaque a third of the time
+    template <class Color>
+    void
+    randomColor(Rand64& r, Color& c)
+    {
+        typedef typename Color::value_type value_type;
+        c.a = r.getInt(0, 2) ? randomValue<value_type>(r) : Color::base_mask;
+        c.r = randomValue<value_type>(r, c.a);
+        c.g = randomValue<value_type>(r, c.a);
+        c.b = randomValue<value_type>(r, c.a);
+    }
+    
+    void randomColor(Rand64& r, agg::gray8& c)
+    {
+        c.a = r.getInt(0, 2) ? randomValue<agg::int8u>(r) : agg::gray8::base_mask;
+        c.v = randomValue<agg::int8u>(r, c.a);
+    }
+    
+    void randomColor(Rand64& r, agg::gray16& c)
+    {
+        c.a = r.getInt(0, 2) ? randomValue<agg::int16u>(r) : agg::gray16::base_mask;
+        c.v = randomValue<agg::int16u>(r, c.a);
+    }
+    
+    // Blends the same random spans and lines into two rows of pixels, one
+    // through agg's own blender and one through spanBlend, and counts the
+    // blends after which the rows differ
+    template <class PixFmt>
+    int
+    compareBlends(unsigned long long seed)
+    {
+        typedef typename PixFmt::value_type value_type;
+        typedef typename PixFmt::color_type color_type;
+        const unsigned rowValues = Width * PixFmt::pix_step;
+        const unsigned stride = rowValues * sizeof(value_type);
+        
+        Rand64 r(seed);
+        std::vector<value_type> aggRow(rowValues), ourRow(rowValues);
+        agg::rendering_buffer aggBuf(reinterpret_cast<agg::int8u*>(aggRow.data()), Width, 1, stride);
+        agg::rendering_buffer ourBuf(reinterpret_cast<agg::int8u*>(ourRow.data()), Width, 1, stride);
+        PixFmt aggFmt(aggBuf);
+        spanBlendPixfmt<PixFmt> ourFmt(ourBuf);
+        agg::int8u covers[Width];
+        
+        int failures = 0;
+        for (int round = 0; round < Rounds; ++round) {
+            if (round % 16 == 0) {
+                for (value_type& v: aggRow)
+                    v = randomValue<value_type>(r);
+                ourRow = aggRow;
+            }
+            unsigned x = static_cast<unsigned>(r.getInt(0, Width - 1));
+            unsigned len = static_cast<unsigned>(r.getInt(1, Width - x));
+            color_type c;
+            randomColor(r, c);
+            if (r.getBernoulli(0.5)) {
+                for (unsigned i = 0; i < len; ++i)
+                    covers[i] = randomCover(r);
+                aggFmt.blend_solid_hspan(x, 0, len, c, covers);
+                ourFmt.blend_solid_hspan(x, 0, len, c, covers);
+            } else {
+                agg::int8u cover = randomCover(r);
+                aggFmt.blend_hline(x, 0, len, c, cover);
+                ourFmt.blend_hline(x, 0, len, c, cover);
+            }
+            if (aggRow != ourRow) {
+                ++failures;
+                ourRow = aggRow;
+            }
+        }
+        return failures;
+    }
+    
+    // Compares with each instruction set that the CPU has
+    template <class PixFmt>
+    void
+    compareInstructionSets(WHERE, unsigned long long seed)
+    {
+        const char* saved = spanBlend::instructionSet();
+        for (const char* set: { "AVX2", "SSE4.1", "scalar" }) {
+            if (spanBlend::useInstructionSet(set))
+                ::Test::check_same(THERE, set, 0, "failures", compareBlends<PixFmt>(seed));
+        }
+        spanBlend::useInstructionSet(saved);
+    }
+}
+
+TEST(spanBlend, rgba32)     { compareInstructionSets<agg::pixfmt_rgba32_pre>(HERE, 1); }
+TEST(spanBlend, bgra32)     { compareInstructionSets<agg::pixfmt_bgra32_pre>(HERE, 2); }
+TEST(spanBlend, argb32)     { compareInstructionSets<agg::pixfmt_argb32_pre>(HERE, 3); }
+TEST(spanBlend, rgb24)      { compareInstructionSets<agg::pixfmt_rgb24_pre>(HERE, 4); }
+TEST(spanBlend, gray8)      { compareInstructionSets<agg::pixfmt_gray8_pre>(HERE, 5); }
+TEST(spanBlend, rgba64)     { compareInstructionSets<agg::pixfmt_rgba64_pre>(HERE, 6); }
+TEST(spanBlend, rgb48)      { compareInstructionSets<agg::pixfmt_rgb48_pre>(HERE, 7); }
+TEST(spanBlend, gray16)     { compareInstructionSets<agg::pixfmt_gray16_pre>(HERE, 8); }
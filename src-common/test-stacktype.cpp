@@ -0,0 +1,164 @@
+// test-stacktype.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+
+#include "test.h"
+#include "testSystem.h"
+#include "stacktype.h"
+#include "rendererAST.h"
+
+#include <memory>
+#include <sstream>
+
+namespace {
+    // A number parameter and a shape parameter
+    struct ParamTypes {
+        AST::ASTparameters  number;
+        AST::ASTparameters  shape;
+        
+        ParamTypes()
+        {
+            number.emplace_back("number", 1, yy::location());
+            shape.emplace_back("shape", 2, yy::location());
+        }
+    };
+    
+    StackRule*
+    numberBlock(const ParamTypes& types, int name, double value)
+    {
+        StackRule* s = StackRule::alloc(name, 1, &types.number);
+        reinterpret_cast<StackType*>(s)[StackRule::HeaderSize].number = value;
+        return s;
+    }
+    
+    // Takes the caller's reference to child
+    StackRule*
+    shapeBlock(const ParamTypes& types, int name, const StackRule* child)
+    {
+        StackRule* s = StackRule::alloc(name, 1, &types.shape);
+        reinterpret_cast<StackType*>(s)[StackRule::HeaderSize].rule = child;
+        return s;
+    }
+    
+    const StackType&
+    param(const StackRule* s)
+    {
+        return reinterpret_cast<const StackType*>(s)[StackRule::HeaderSize];
+    }
+    
+    // A renderer to intern blocks with, it owns the design
+    struct TestRenderer {
+        TestSystem                  system;
+        std::unique_ptr<Renderer>   renderer;
+        
+        TestRenderer()
+        {
+            std::unique_ptr<CFDG> design(system.parse("startshape A shape A { CIRCLE [] }"));
+            if (design)
+                renderer.reset(design.release()->renderer(100, 100, 0.3, 0));
+        }
+        RendererAST* ast() { return dynamic_cast<RendererAST*>(renderer.get()); }
+    };
+}
+
+TEST(stacktype, internDeep) {
+    ParamTypes types;
+    TestRenderer tr;
+    RendererAST* r = tr.ast();
+    CHECK_VALID(r);
+    unsigned params = Renderer::ParamCount;
+    
+    // A child that is an equal copy of an interned child, like one read
+    // back from a temp file, still finds the interned parent
+    const StackRule* child = StackRule::Intern(numberBlock(types, 1, 3.5), r);
+    const StackRule* parent = StackRule::Intern(shapeBlock(types, 2, child), r);
+    const StackRule* copy = StackRule::Intern(shapeBlock(types, 2, numberBlock(types, 1, 3.5)), r);
+    CHECK(copy == parent);
+    
+    const StackRule* other = StackRule::Intern(shapeBlock(types, 2, numberBlock(types, 1, 4.5)), r);
+    CHECK(other != parent);
+    
+    other->release();
+    copy->release();
+    parent->release();
+    CHECK_SAME(params, static_cast<unsigned>(Renderer::ParamCount));
+}
+
+TEST(stacktype, roundTrip) {
+    ParamTypes types;
+    unsigned params = Renderer::ParamCount;
+    
+    const StackRule* shared = numberBlock(types, 1, 0.25);
+    const StackRule* permanent = numberBlock(types, 3, 7.0);
+    permanent->setRefCount(StackRule::MaxRefCount);
+    const int Count = 3000;     // more than the dictionary holds
+    
+    std::string data;
+    {
+        std::ostringstream out;
+        for (int i = 0; i < Count; ++i) {
+            if (i % 2) shared->retain(nullptr);
+            const StackRule* s = shapeBlock(types, 2, i % 2 ? shared : numberBlock(types, 1, i));
+            s->retain(nullptr);
+            s->retain(nullptr);
+            StackRule::Write(out, s, true);     // the stream holds a reference
+            StackRule::Write(out, s, true);     // an index token
+            StackRule::Write(out, s, true);
+            StackRule::Write(out, permanent);
+            StackRule::Write(out, nullptr);
+        }
+        CHECK(out.good());
+        data = out.str();
+    }
+    shared->release();
+    CHECK_SAME(params + 1, static_cast<unsigned>(Renderer::ParamCount));
+    
+    {
+        std::istringstream in(data);
+        for (int i = 0; i < Count; ++i) {
+            StackRule* s = StackRule::Read(in);
+            CHECK_VALID(s);
+            CHECK_SAME(2, s->mRuleName);
+            const StackRule* child = param(s).rule;
+            CHECK_VALID(child);
+            CHECK(param(child).number == (i % 2 ? 0.25 : i));
+            // Repeats within a dictionary read back as the same block
+            StackRule* s2 = StackRule::Read(in);
+            CHECK(s2 == s);
+            StackRule* s3 = StackRule::Read(in);
+            CHECK(s3 == s);
+            CHECK(StackRule::Read(in) == permanent);
+            CHECK(StackRule::Read(in) == nullptr);
+            s->release();
+            s2->release();
+            s3->release();
+        }
+        CHECK(in.good());
+        CHECK(in.peek() == std::char_traits<char>::eof());
+    }
+    CHECK_SAME(params + 1, static_cast<unsigned>(Renderer::ParamCount));
+    
+    delete[] reinterpret_cast<const StackType*>(permanent);
+    --Renderer::ParamCount;
+}
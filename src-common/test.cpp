@@ -24,6 +24,9 @@
 
 #include "test.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
 #include <exception>
 #include <iomanip>
 #include <iostream>
@@ -406,4 +409,61 @@ namespace Test
 
 		return failCount == 0;
 	}
+
+
+	namespace {
+		std::vector<benchmark*>&
+		benchmarks()
+		{
+			static std::vector<benchmark*>* b = new std::vector<benchmark*>;
+			return *b;
+		}
+
+		volatile const void* sink = 0;
+	}
+
+	benchmark::benchmark(const char* group, const char* n, unsigned long count)
+		: name(group), iterations(count)
+	{
+		name += '.';
+		name += n;
+		benchmarks().push_back(this);
+	}
+
+	void
+	consume(const void* p)
+		{ sink = p; }
+
+	bool
+	runBenchmarks(const char* filter, unsigned repetitions)
+	{
+		if (repetitions < 1) repetitions = 1;
+		bool ran = false;
+
+		std::printf("%-36s %12s %12s %12s\n", "benchmark", "iterations",
+					"best ns/op", "median ns/op");
+		for (benchmark* b: benchmarks()) {
+			if (filter && b->name.find(filter) == std::string::npos)
+				continue;
+			ran = true;
+
+			// one untimed run to warm up caches and the allocator
+			b->startTimer();
+			b->run(b->iterations);
+
+			std::vector<double> times;
+			for (unsigned rep = 0; rep < repetitions; ++rep) {
+				b->startTimer();
+				b->run(b->iterations);
+				std::chrono::duration<double, std::nano> elapsed =
+					benchmark::clock::now() - b->start;
+				times.push_back(elapsed.count() / b->iterations);
+			}
+			std::sort(times.begin(), times.end());
+			std::printf("%-36s %12lu %12.2f %12.2f\n", b->name.c_str(),
+						b->iterations, times.front(), times[times.size() / 2]);
+			std::fflush(stdout);
+		}
+		return ran;
+	}
 }
@@ -29,6 +29,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <chrono>
 
 namespace Test {
 	class testlocation {
@@ -111,6 +112,37 @@ namespace Test {
 		bool reportPerGroup = false,
 		bool stopOnFailingGroup = false);
 		// returns true if passes all tests
+
+
+	// Benchmarks run a fixed number of iterations per repetition so that
+	// results are comparable from run to run; the best and median time per
+	// iteration over all repetitions are reported.
+	class benchmark {
+	public:
+		typedef std::chrono::steady_clock clock;
+
+		benchmark(const char* group, const char* name, unsigned long iterations);
+		virtual void run(unsigned long iterations) = 0;
+
+		void startTimer()					{ start = clock::now(); }
+			// excludes any setup done in run() before the call from the
+			// measured time
+
+		std::string			name;
+		unsigned long		iterations;
+		clock::time_point	start;
+	};
+
+	void consume(const void* p);
+		// defined out of line so that the compiler cannot discard the
+		// computation that produced *p
+
+	template <typename T>
+	void keep(const T& v)						{ consume(&v); }
+
+	bool runBenchmarks(const char* filter = 0, unsigned repetitions = 5);
+		// runs every benchmark whose name contains filter (or all of them
+		// if filter is null), returns false if none matched
 }
 
 
@@ -122,6 +154,14 @@ namespace Test {
     void Test_##group##_##name::run()
 
 
+#define BENCH(group, name, count) \
+    struct Bench_##group##_##name : public ::Test::benchmark { \
+        Bench_##group##_##name() : ::Test::benchmark(#group, #name, count) { } \
+        void run(unsigned long iterations); \
+    } bench_##group##_##name; \
+    void Bench_##group##_##name::run(unsigned long iterations)
+
+
 #define HERE    ::Test::testlocation(__FILE__, __LINE__, _called_from)
 #define WHERE   const ::Test::testlocation& _called_from
 #define THERE   _called_from
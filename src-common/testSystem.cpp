@@ -0,0 +1,44 @@
+// testSystem.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+#include "testSystem.h"
+#include "cfdg.h"
+#include <sstream>
+
+std::istream*
+TestSystem::openFileForRead(const std::string& path)
+{
+    auto it = mSources.find(path);
+    if (it == mSources.end())
+        return CommandLineSystem::openFileForRead(path);
+    return new std::istringstream(it->second, std::ios::binary);
+}
+
+CFDG*
+TestSystem::parse(const char* source)
+{
+    std::string name = "test" + std::to_string(mSources.size()) + ".cfdg";
+    mSources[name] = source;
+    return CFDG::ParseFile(name.c_str(), this, 0);
+}
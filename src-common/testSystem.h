@@ -0,0 +1,51 @@
+// testSystem.h
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// The system the unit tests parse and render designs with. It is quiet and
+// reads designs from strings instead of from files.
+
+#ifndef INCLUDE_TESTSYSTEM_H
+#define INCLUDE_TESTSYSTEM_H
+
+#include "commandLineSystem.h"
+#include <map>
+#include <string>
+
+class CFDG;
+
+class TestSystem : public CommandLineSystem {
+public:
+    TestSystem() : CommandLineSystem(true) { }
+    
+    std::istream* openFileForRead(const std::string& path) override;
+    
+    CFDG* parse(const char* source);
+        // Parses the design, returns null on error. The caller must delete
+        // the design.
+    
+private:
+    std::map<std::string, std::string> mSources;
+};
+
+#endif // INCLUDE_TESTSYSTEM_H
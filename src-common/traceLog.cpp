@@ -0,0 +1,143 @@
+// traceLog.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+
+#include "traceLog.h"
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <map>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+std::atomic<bool> TraceLog::Enabled(false);
+
+namespace {
+    struct TraceEvent {
+        const char* name;
+        const char* cat;
+        char        phase;
+        unsigned    tid;
+        double      ts;         // microseconds since TraceLog::Start()
+        double      dur;
+        const char* argName;
+        double      argValue;
+    };
+    
+    mutex                           TraceMutex;
+    vector<TraceEvent>              TraceEvents;
+    map<thread::id, unsigned>       TraceThreads;
+    TraceLog::time_point            TraceOrigin;
+    string                          TracePath;
+    
+    double
+    micros(TraceLog::time_point t)
+    {
+        return chrono::duration<double, micro>(t - TraceOrigin).count();
+    }
+    
+    unsigned
+    threadNumber()
+    {
+        // caller holds TraceMutex
+        auto ins = TraceThreads.insert(make_pair(this_thread::get_id(),
+                                   static_cast<unsigned>(TraceThreads.size() + 1)));
+        return ins.first->second;
+    }
+}
+
+void
+TraceLog::Start(const char* path)
+{
+    lock_guard<mutex> lock(TraceMutex);
+    TracePath = path;
+    TraceEvents.clear();
+    TraceEvents.reserve(4096);
+    TraceOrigin = Now();
+    Enabled = true;
+}
+
+void
+TraceLog::Complete(const char* name, const char* cat, time_point begin,
+                   time_point end, const char* argName, double argValue)
+{
+    lock_guard<mutex> lock(TraceMutex);
+    if (!Enabled) return;
+    TraceEvent e = { name, cat, 'X', threadNumber(), micros(begin),
+                     chrono::duration<double, micro>(end - begin).count(),
+                     argName, argValue };
+    TraceEvents.push_back(e);
+}
+
+void
+TraceLog::Counter(const char* name, const char* argName, double value)
+{
+    if (!Enabled) return;
+    time_point now = Now();
+    lock_guard<mutex> lock(TraceMutex);
+    if (!Enabled) return;
+    TraceEvent e = { name, "counter", 'C', threadNumber(), micros(now), 0.0,
+                     argName, value };
+    TraceEvents.push_back(e);
+}
+
+bool
+TraceLog::Finish()
+{
+    lock_guard<mutex> lock(TraceMutex);
+    if (!Enabled) return true;
+    Enabled = false;
+    
+    ofstream out(TracePath.c_str(), ios::out | ios::trunc);
+    if (!out.good())
+        return false;
+    
+    // Event names and categories are string literals in the source, so no
+    // JSON escaping is needed.
+    out << fixed << setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (auto& thread: TraceThreads)
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << thread.second << ",\"args\":{\"name\":\""
+            << (thread.second == 1 ? "main" : "worker") << "\"}},\n";
+    for (const TraceEvent& e: TraceEvents) {
+        out << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.cat
+            << "\",\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << e.tid
+            << ",\"ts\":" << e.ts;
+        if (e.phase == 'X')
+            out << ",\"dur\":" << e.dur;
+        if (e.argName)
+            out << ",\"args\":{\"" << e.argName << "\":" << e.argValue << '}';
+        out << "},\n";
+    }
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"cfdg\"}}\n";
+    out << "]}\n";
+    
+    TraceEvents.clear();
+    TraceThreads.clear();
+    return out.good();
+}
@@ -0,0 +1,106 @@
+// traceLog.h
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// Phase-level tracing of the renderer. Events are recorded in memory and
+// written out in the Chrome trace-event format, which can be loaded into
+// chrome://tracing or Perfetto. When tracing is not enabled each trace point
+// costs one test of a static flag.
+
+#ifndef INCLUDE_TRACELOG_H
+#define INCLUDE_TRACELOG_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+class TraceLog {
+public:
+    typedef std::chrono::steady_clock       clock_type;
+    typedef clock_type::time_point          time_point;
+
+    static std::atomic<bool> Enabled;
+        // read by worker threads, so trace points can test it without
+        // taking the lock
+    
+    static void Start(const char* path);
+        // start recording events, they are written to path by Finish()
+    static bool Finish();
+        // write the recorded events and stop recording, returns false on
+        // I/O error
+
+    static void Complete(const char* name, const char* cat,
+                         time_point begin, time_point end,
+                         const char* argName = nullptr, double argValue = 0.0);
+    static void Counter(const char* name, const char* argName, double value);
+    
+    static time_point Now() { return clock_type::now(); }
+    
+    // Records a complete event spanning the lifetime of the scope object.
+    // The name and category must be string literals.
+    class Scope {
+    public:
+        Scope(const char* name, const char* cat)
+        : mName(name), mCat(cat), mArgName(nullptr), mArgValue(0.0), mOn(Enabled)
+        { if (mOn) mBegin = Now(); }
+        ~Scope()
+        { if (mOn) Complete(mName, mCat, mBegin, Now(), mArgName, mArgValue); }
+        
+        void arg(const char* name, double value)
+        { mArgName = name; mArgValue = value; }
+    private:
+        const char* mName;
+        const char* mCat;
+        const char* mArgName;
+        double      mArgValue;
+        bool        mOn;
+        time_point  mBegin;
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+    
+    // Records a sequence of back-to-back events, each call to next() closes
+    // the current event and begins a new one.
+    class Span {
+    public:
+        Span(const char* name, const char* cat)
+        : mName(name), mCat(cat), mOn(Enabled)
+        { if (mOn) mBegin = Now(); }
+        
+        void next(const char* argName = nullptr, double argValue = 0.0)
+        {
+            if (!mOn) return;
+            time_point end = Now();
+            Complete(mName, mCat, mBegin, end, argName, argValue);
+            mBegin = end;
+        }
+    private:
+        const char* mName;
+        const char* mCat;
+        bool        mOn;
+        time_point  mBegin;
+    };
+};
+
+#endif // INCLUDE_TRACELOG_H
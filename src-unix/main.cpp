@@ -36,6 +36,7 @@
 #include <stdio.h>
 #else
 #include <unistd.h>
+#include <sys/resource.h>
 #endif
 #include <stdlib.h>
 #include "cfdg.h"
@@ -45,12 +46,14 @@
 #else
 #include "pngCanvas.h"
 #endif
+#include "rawCanvas.h"
 #include "SVGCanvas.h"
 #include "ffCanvas.h"
 #include "commandLineSystem.h"
 #include "version.h"
 #include "Rand64.h"
 #include "makeCFfilename.h"
+#include "traceLog.h"
 #include <cassert>
 #include <memory>
 
@@ -95,36 +98,23 @@ BOOL CtrlHandler(DWORD ctrlType)
 }
 #else
 #include <csignal>
+#include <pthread.h>
+
+static pthread_t MainThread;
 
 void termination_handler(int signum)
 {
+    // Any thread can get the signal. Pass it on to the main thread, a worker
+    // must not hold the last reference to the renderer.
+    if (!pthread_equal(pthread_self(), MainThread)) {
+        pthread_kill(MainThread, signum);
+        return;
+    }
     processInterrupt();
 }
 #endif
 
 
-const char*
-prettyInt(unsigned long v)
-{
-    if (!v) return "0";
-    
-    static char temp[32];
-    temp[31] = '\0';
-    int i = 0;
-    char* pos = temp + 30;
-    for(;;) {
-        *pos = '0' + (v % 10);
-        v = v / 10;
-        if (!v) return pos;
-        ++i;
-        --pos;
-        if (i % 3 == 0) {
-            *pos = ',';
-            --pos;
-        }
-    }
-}
-
 void
 usage(bool inError)
 {
@@ -179,6 +169,11 @@ usage(bool inError)
         << "V        generate SVG (vector) output" << endl;
     out << "    " << APP_OPTCHAR()
         << "Q        generate Quicktime movie output" << endl;
+    out << "    " << APP_OPTCHAR()
+        << "f fmt    bitmap output format for other tools: pnm (PGM/PPM/PAM, 8 or 16 bit)," << endl;
+    out << "              qoi (fast lossless) or rgba (raw premultiplied RGBA in native byte order)." << endl;
+    out << "              Animation frames are written one after another to stdout or to an" << endl;
+    out << "              " << APP_OPTCHAR() << "o file name without %f, e.g. to pipe them to a video encoder" << endl;
 #ifdef _WIN32
     out << "    " << APP_OPTCHAR()
         << "W        generate desktop wallpaper output" << endl;
@@ -191,6 +186,27 @@ usage(bool inError)
         << "C        Check syntax, check syntax of cfdg file and exit" << endl;
     out << "    " << APP_OPTCHAR()
         << "t        time output, output the time taken to render the cfdg file" << endl;
+    out << "    " << APP_OPTCHAR()
+        << "O        occlusion culling, draw designs without alpha back to front and" << endl;
+    out << "              skip shapes that are hidden by shapes drawn over them" << endl;
+    out << "    " << APP_OPTCHAR()
+        << "L        level of detail, splat shapes below the minimum size instead of dropping" << endl;
+    out << "              them, for fine texture with a larger minimum size (" << APP_OPTCHAR() << "x)" << endl;
+    out << "    " << APP_OPTCHAR()
+        << "p secs   write a reduced size preview of the image so far every secs seconds," << endl;
+    out << "              as name_preview.png next to the output file" << endl;
+#ifndef _WIN32
+    // GDI+ writes the PNG files on Windows and has no such settings
+    out << "    " << APP_OPTCHAR()
+        << "Z num    PNG compression level, 0 (none) to 9 (smallest) (default 6)" << endl;
+    out << "    " << APP_OPTCHAR()
+        << "F name   PNG row filter: none, sub, up, average, paeth or adaptive (default adaptive)" << endl;
+#endif
+    out << "    " << APP_OPTCHAR()
+        << "B MB     draw and write the image in bands of at most MB megabytes, for still" << endl;
+    out << "              bitmap images that are too big for memory" << endl;
+    out << "    " << APP_OPTCHAR()
+        << "j file   write a trace of the rendering phases to file (Chrome trace format)" << endl;
     out << "    " << APP_OPTCHAR()
         << "P        Parameter allocation debug, test whether all the parameter blocks were cleaned up" << endl;
     out << "    " << APP_OPTCHAR()
@@ -198,12 +214,21 @@ usage(bool inError)
     out << "    " << APP_OPTCHAR()
         << "?        show this message, then exit" << endl;
     out << endl;
+#ifdef _WIN32
+    out << "Temporary files are written to %TEMP%, or round-robin to the directories" << endl;
+    out << "in %CFDG_TEMPDIRS% (separated by semicolons) if it is set." << endl;
+#else
+    out << "Temporary files are written to $TMPDIR, or round-robin to the directories" << endl;
+    out << "in $CFDG_TEMPDIRS (separated by colons) if it is set." << endl;
+#endif
+    out << endl;
     
     exit(inError ? 2 : 0);
 }
 
 struct options {
-    enum OutputFormat { PNGfile = 0, SVGfile = 1, MOVfile = 2, BMPfile = 3 };
+    enum OutputFormat { PNGfile = 0, SVGfile = 1, MOVfile = 2, BMPfile = 3,
+                        PNMfile = 4, QOIfile = 5, RGBAfile = 6 };
     int   width;
     int   height;
     int   widthMult;
@@ -231,6 +256,13 @@ struct options {
     bool outputWallpaper;
     bool paramTest;
     bool deleteTemps;
+    bool occlusionCulling;
+    bool levelOfDetail;
+    double previewInterval;
+    const char* traceFile;
+    int compressionLevel;
+    pngCanvas::FilterStrategy pngFilter;
+    size_t bandBytes;
     
     options()
     : width(500), height(500), widthMult(1), heightMult(1), maxShapes(0), 
@@ -238,7 +270,9 @@ struct options {
       animationFrames(0), animationTime(0), animationFPS(15), animationZoom(false), 
       input(nullptr), output(nullptr), output_fmt(nullptr), format(PNGfile), quiet(false),
       outputTime(false), outputStdout(false), outputWallpaper(false),
-      paramTest(false), deleteTemps(false)
+      paramTest(false), deleteTemps(false), occlusionCulling(false),
+      levelOfDetail(false), previewInterval(0.0), traceFile(nullptr),
+      compressionLevel(6), pngFilter(pngCanvas::FilterAdaptive), bandBytes(0)
     { }
 };
 
@@ -308,9 +342,9 @@ floatArg(char arg, const char* str)
 }
 
 #ifdef _WIN32
-#define OPTCHARS ":w:h:s:m:x:b:v:a:o:T:cCdVzqQPtW?"
+#define OPTCHARS ":w:h:s:m:x:b:v:a:o:T:j:p:Z:F:f:B:cCdVzqQPtOLW?"
 #else
-#define OPTCHARS ":w:h:s:m:x:b:v:a:o:T:cCdVzqQPt?"
+#define OPTCHARS ":w:h:s:m:x:b:v:a:o:T:j:p:Z:F:f:B:cCdVzqQPtOL?"
 #endif
 
 void
@@ -379,6 +413,19 @@ processCommandLine(int argc, char* argv[], options& opt)
                 opt.format = options::BMPfile;
                 opt.outputWallpaper = true;
                 break;
+            case 'f':
+                if (opt.format != options::PNGfile) usage(true);
+                if (strcmp(optarg, "pnm") == 0) {
+                    opt.format = options::PNMfile;
+                } else if (strcmp(optarg, "qoi") == 0) {
+                    opt.format = options::QOIfile;
+                } else if (strcmp(optarg, "rgba") == 0) {
+                    opt.format = options::RGBAfile;
+                } else {
+                    cerr << "Unknown output format: " << optarg << endl;
+                    usage(true);
+                }
+                break;
             case 'c':
                 if (opt.format == options::MOVfile) usage(true);
                 opt.crop = true;
@@ -411,6 +458,51 @@ processCommandLine(int argc, char* argv[], options& opt)
             case 'd':
                 opt.deleteTemps = true;
                 break;
+            case 'O':
+                opt.occlusionCulling = true;
+                break;
+            case 'L':
+                opt.levelOfDetail = true;
+                break;
+            case 'j':
+                opt.traceFile = optarg;
+                break;
+            case 'p':
+                opt.previewInterval = floatArg(c, optarg);
+                if (opt.previewInterval <= 0.0) usage(true);
+                break;
+            case 'Z': {
+                char* end;
+                long level = strtol(optarg, &end, 10);
+                if (end == optarg || *end || level < 0 || level > 9) {
+                    cerr << "Option -Z takes a compression level from 0 to 9" << endl;
+                    usage(true);
+                }
+                opt.compressionLevel = static_cast<int>(level);
+                break;
+            }
+            case 'F': {
+                static const char* filters[] = { "none", "sub", "up", "average", "paeth", "adaptive" };
+                int filter = 0;
+                while (filter < 6 && strcmp(optarg, filters[filter]) != 0)
+                    ++filter;
+                if (filter == 6) {
+                    cerr << "Unknown PNG filter: " << optarg << endl;
+                    usage(true);
+                }
+                opt.pngFilter = static_cast<pngCanvas::FilterStrategy>(filter);
+                break;
+            }
+            case 'B': {
+                char* end;
+                long mb = strtol(optarg, &end, 10);
+                if (end == optarg || *end || mb <= 0 || mb > 1 << 20) {
+                    cerr << "Option -B takes a band size in megabytes" << endl;
+                    usage(true);
+                }
+                opt.bandBytes = static_cast<size_t>(mb) << 20;
+                break;
+            }
         }
     }
     
@@ -425,6 +517,19 @@ processCommandLine(int argc, char* argv[], options& opt)
         usage(true);
     }
     
+    if (opt.levelOfDetail && (opt.format == options::SVGfile || opt.animationFrames)) {
+        cerr << "Level of detail is only supported for still bitmap output" << endl;
+        usage(true);
+    }
+    
+    if (opt.bandBytes && (opt.format == options::SVGfile || opt.format == options::MOVfile ||
+                          opt.format == options::BMPfile || opt.animationFrames ||
+                          opt.levelOfDetail))
+    {
+        cerr << "Banded output is only supported for still bitmap output without level of detail" << endl;
+        usage(true);
+    }
+    
     if (!opt.input && !opt.deleteTemps) {
         cerr << "Missing input file" << endl;
         usage(true);
@@ -436,6 +541,13 @@ processCommandLine(int argc, char* argv[], options& opt)
         opt.output_fmt = "-";
         opt.quiet = true;
     }
+    
+    if (opt.previewInterval > 0.0 &&
+        (opt.format != options::PNGfile || opt.animationFrames || opt.outputStdout))
+    {
+        cerr << "Previews are only supported for still PNG output to a file" << endl;
+        usage(true);
+    }
 }
 
 class nullstreambuf : public streambuf
@@ -451,6 +563,34 @@ public:
 
 static nullostream cnull;
 
+// Writes the trace file however main() returns
+class TraceFinisher
+{
+public:
+    explicit TraceFinisher(const char* path) : mPath(path)
+    { if (mPath) TraceLog::Start(mPath); }
+    ~TraceFinisher()
+    {
+        if (!mPath) return;
+#ifndef _WIN32
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            usage.ru_maxrss /= 1024;    // bytes on OS X, KiB elsewhere
+#endif
+            TraceLog::Counter("peak RSS", "KiB", static_cast<double>(usage.ru_maxrss));
+        }
+#endif
+        if (!TraceLog::Finish())
+            cerr << "Failed to write trace file " << mPath << endl;
+    }
+private:
+    const char* mPath;
+    
+    TraceFinisher(const TraceFinisher&) = delete;
+    TraceFinisher& operator=(const TraceFinisher&) = delete;
+};
+
 int main (int argc, char* argv[]) {
     options opts;
     int var = Variation::random(6);
@@ -459,6 +599,7 @@ int main (int argc, char* argv[]) {
     SetConsoleCtrlHandler((PHANDLER_ROUTINE)CtrlHandler, TRUE);
 #else
     struct sigaction new_action, old_action;
+    MainThread = pthread_self();
     new_action.sa_handler = termination_handler;
     sigemptyset(&new_action.sa_mask);
     new_action.sa_flags = 0;
@@ -472,6 +613,8 @@ int main (int argc, char* argv[]) {
     
     if (opts.quiet) myCout = &cnull;
     
+    TraceFinisher trace(opts.traceFile);
+    
     clock_t startTime = clock();
     clock_t fromTime = startTime;
     clock_t clocksPerMsec = CLOCKS_PER_SEC / 1000;
@@ -504,7 +647,7 @@ int main (int argc, char* argv[]) {
             }
         }
         
-        if (!opts.input) exit(0);
+        if (!opts.input) return 0;
     }
     
     CFDG* myDesign = CFDG::ParseFile(opts.input, &system, opts.variation);
@@ -515,11 +658,15 @@ int main (int argc, char* argv[]) {
             cerr << "Tiled output multiplication only allowed for tiled or frieze designs." << endl;
             return 6;
         }
-        if (opts.format != options::PNGfile && opts.format != options::BMPfile) {
-            cerr << "Tiled output multiplication only allowed for PNG output." << endl;
+        if (opts.format == options::SVGfile || opts.format == options::MOVfile) {
+            cerr << "Tiled output multiplication only allowed for bitmap output." << endl;
             return 6;
         }
     }
+    if (opts.bandBytes && (myDesign->isTiled() || myDesign->isFrieze())) {
+        cerr << "Banded output is not supported for tiled or frieze designs." << endl;
+        return 6;
+    }
 
     // If a static output file name is provided then generate an output
     // file name format string by escaping any '%' characters. If this is 
@@ -556,10 +703,23 @@ int main (int argc, char* argv[]) {
         opts.output_fmt = newOutput.c_str();
     }
     
+    string previewOutput;
+    if (opts.previewInterval > 0.0) {
+        previewOutput = opts.output_fmt;
+        size_t ext = previewOutput.find_last_of('.');
+        size_t dir = previewOutput.find_last_of("/\\");
+        if (ext != string::npos && (dir == string::npos || ext > dir)) {
+            previewOutput.insert(ext, "_preview");
+        } else {
+            previewOutput.append("_preview");
+        }
+    }
+    
     bool useRGBA = myDesign->usesColor;
     aggCanvas::PixelFormat pixfmt = aggCanvas::SuggestPixelFormat(myDesign);
     bool use16bit = (pixfmt & aggCanvas::Has_16bit_Color) != 0;
-    const char* fmtnames[4] = { "PNG image", "SVG vector output", "Quicktime movie", "Wallpaper BMP image" };
+    const char* fmtnames[7] = { "PNG image", "SVG vector output", "Quicktime movie", "Wallpaper BMP image",
+                                "PNM image", "QOI image", "raw RGBA image" };
     
     *myCout << "Generating " << (use16bit ? "16bit " : "8bit ") 
         << (useRGBA ? "color" : "gray-scale")
@@ -568,9 +728,10 @@ int main (int argc, char* argv[]) {
         << code << "..." << endl;
     
     { // Scope for canvas & renderer
-    unique_ptr<pngCanvas> png;
+    unique_ptr<abstractPngCanvas> png;
     unique_ptr<SVGCanvas> svg;
     unique_ptr<ffCanvas>  mov;
+    unique_ptr<pngCanvas> preview;
     Canvas* myCanvas = nullptr;
         
     shared_ptr<Renderer> TheRenderer(myDesign->renderer(opts.width, opts.height, opts.minSize,
@@ -585,6 +746,18 @@ int main (int argc, char* argv[]) {
     if (!opts.quiet) setupTimer(TheRenderer);
     
     TheRenderer->setMaxShapes(opts.maxShapes);
+    TheRenderer->setOcclusionCulling(opts.occlusionCulling);
+    TheRenderer->setLevelOfDetail(opts.levelOfDetail);
+    if (opts.previewInterval > 0.0) {
+        // About 512 pixels on the long side, for big renders
+        int div = max(1, max(opts.width, opts.height) / 512);
+        preview.reset(new pngCanvas(previewOutput.c_str(), true,
+                                    max(1, opts.width / div), max(1, opts.height / div),
+                                    pixfmt, false, 0, opts.variation, false,
+                                    nullptr, 1, 1));
+        preview->setAtomicOutput(true);
+        TheRenderer->setPreview(preview.get(), opts.previewInterval);
+    }
     TheRenderer->run(nullptr, false);
     
     opts.width = TheRenderer->m_width;
@@ -593,11 +766,26 @@ int main (int argc, char* argv[]) {
     
     switch (opts.format) {
         case options::BMPfile:
-        case options::PNGfile: {
-            png.reset(new pngCanvas(opts.output_fmt, opts.quiet, opts.width, opts.height,
-                                    pixfmt, opts.crop, opts.animationFrames, opts.variation,
-                                    opts.format == options::BMPfile, TheRenderer.get(),
-                                    opts.widthMult, opts.heightMult));
+        case options::PNGfile:
+        case options::PNMfile:
+        case options::QOIfile:
+        case options::RGBAfile: {
+            if (opts.format == options::BMPfile || opts.format == options::PNGfile) {
+                pngCanvas* pngc = new pngCanvas(opts.output_fmt, opts.quiet, opts.width, opts.height,
+                                                pixfmt, opts.crop, opts.animationFrames, opts.variation,
+                                                opts.format == options::BMPfile, TheRenderer.get(),
+                                                opts.widthMult, opts.heightMult, opts.bandBytes);
+                pngc->setCompression(opts.compressionLevel, opts.pngFilter);
+                png.reset(pngc);
+            } else {
+                rawCanvas::Format fmt = opts.format == options::PNMfile ? rawCanvas::PNM :
+                                        opts.format == options::QOIfile ? rawCanvas::QOI :
+                                                                          rawCanvas::RGBA;
+                png.reset(new rawCanvas(fmt, opts.output_fmt, opts.quiet, opts.width, opts.height,
+                                        pixfmt, opts.crop, opts.animationFrames, opts.variation,
+                                        false, TheRenderer.get(), opts.widthMult, opts.heightMult,
+                                        opts.bandBytes));
+            }
             myCanvas = static_cast<Canvas*>(png.get());
             if (png->mWidth != opts.width || png->mHeight != opts.height) {
                 TheRenderer->resetSize(png->mWidth, png->mHeight);
@@ -620,7 +808,7 @@ int main (int argc, char* argv[]) {
                                    opts.animationFPS));
             if (mov->mErrorMsg) {
                 cerr << "Failed to create movie file: " << mov->mErrorMsg << endl;
-                exit(8);
+                return 8;
             }
             myCanvas = static_cast<Canvas*>(mov.get());
             break;
@@ -28,9 +28,17 @@
 
 #include "pngCanvas.h"
 #include "png.h"
+#include "zlib.h"
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
-#include <arpa/inet.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 
@@ -47,46 +55,413 @@ namespace {
     {
         cerr << message << endl;
     }
+    
+    // Writes the filter type byte and the filtered row to out. The previous
+    // row is all zero for the first row of the image.
+    void
+    filterRow(int type, int bpp, const png_byte* row, const png_byte* prev,
+              size_t len, png_byte* out)
+    {
+        *out++ = static_cast<png_byte>(type);
+        size_t i = 0;
+        switch (type) {
+            case pngCanvas::FilterNone:
+                memcpy(out, row, len);
+                break;
+            case pngCanvas::FilterSub:
+                for (; i < static_cast<size_t>(bpp); ++i)
+                    out[i] = row[i];
+                for (; i < len; ++i)
+                    out[i] = static_cast<png_byte>(row[i] - row[i - bpp]);
+                break;
+            case pngCanvas::FilterUp:
+                for (; i < len; ++i)
+                    out[i] = static_cast<png_byte>(row[i] - prev[i]);
+                break;
+            case pngCanvas::FilterAverage:
+                for (; i < static_cast<size_t>(bpp); ++i)
+                    out[i] = static_cast<png_byte>(row[i] - (prev[i] >> 1));
+                for (; i < len; ++i)
+                    out[i] = static_cast<png_byte>(row[i] - ((row[i - bpp] + prev[i]) >> 1));
+                break;
+            case pngCanvas::FilterPaeth:
+                for (; i < static_cast<size_t>(bpp); ++i)
+                    out[i] = static_cast<png_byte>(row[i] - prev[i]);
+                for (; i < len; ++i) {
+                    int a = row[i - bpp], b = prev[i], c = prev[i - bpp];
+                    int pa = abs(b - c), pb = abs(a - c), pc = abs(a + b - 2 * c);
+                    int pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+                    out[i] = static_cast<png_byte>(row[i] - pred);
+                }
+                break;
+        }
+    }
+    
+    // The usual heuristic for adaptive filtering: the sum of the filtered
+    // bytes taken as signed values
+    size_t
+    filterCost(const png_byte* filtered, size_t len)
+    {
+        size_t sum = 0;
+        for (size_t i = 0; i < len; ++i)
+            sum += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+        return sum;
+    }
+    
+    // Compresses the image in bands of rows on several threads, pigz style:
+    // each band is a raw deflate stream primed with the last 32k of the data
+    // before it and ending on a byte boundary, so the bands concatenate into
+    // one zlib stream. The band size doesn't depend on the thread count, so
+    // the output is the same on every machine. Rows are taken as they come
+    // and each band keeps a copy of the rows before it that its filters and
+    // deflate window need, so the image doesn't have to be in memory all at
+    // once.
+    class bandEncoder {
+    public:
+        bandEncoder(png_structp png_ptr, aggCanvas::PixelFormat fmt, int width,
+                    int height, int level, pngCanvas::FilterStrategy filter);
+        ~bandEncoder();
+        
+        void addRows(const png_byte* rows, size_t stride, int count);
+            // Takes canvas rows, top first, and writes the IDAT chunks of
+            // the bands that are done
+        void finish();
+            // Writes the rest of the IDAT chunks
+        
+    private:
+        enum {
+            BandBytes = 1 << 20,
+            WindowBytes = 1 << 15
+        };
+        struct Band {
+            vector<png_byte> rows;      // context rows, then the band rows
+            int context = 0;
+            int first = 0;              // image row of the first band row
+            int last = 0;
+            vector<png_byte> data;
+            uLong adler = 0;
+            size_t length = 0;
+            const char* error = nullptr;
+            bool done = false;
+        };
+        
+        png_structp mPng;
+        aggCanvas::PixelFormat mFormat;
+        int mWidth;
+        int mHeight;
+        int mLevel;
+        pngCanvas::FilterStrategy mFilter;
+        int mBpp;
+        size_t mRowBytes;
+        int mBandRows;
+        int mContextRows;
+        int mRowsIn = 0;
+        uLong mAdler;
+        
+        unique_ptr<Band> mPending;
+        deque<unique_ptr<Band>> mBands;     // in output order
+        deque<Band*> mQueue;                // not started yet
+        vector<thread> mWorkers;
+        mutex mMutex;
+        condition_variable mCond;
+        bool mAbort = false;
+        
+        void submit();
+        void write(size_t ahead);
+        void work();
+        void encode(Band& band);
+    };
+    
+    bandEncoder::bandEncoder(png_structp png_ptr, aggCanvas::PixelFormat fmt,
+                             int width, int height, int level,
+                             pngCanvas::FilterStrategy filter)
+    : mPng(png_ptr), mFormat(fmt), mWidth(width), mHeight(height), mLevel(level),
+      mFilter(filter), mBpp(aggCanvas::BytesPerPixel.at(fmt)),
+      mRowBytes(static_cast<size_t>(width) * mBpp),
+      mBandRows(static_cast<int>(max<size_t>(1, BandBytes / (mRowBytes + 1)))),
+      mContextRows(1), mAdler(adler32(0, nullptr, 0)), mPending(new Band)
+    {
+        // The rows that fill the deflate window, plus the one before them
+        // for the filters
+        if (mLevel > 0)
+            mContextRows += static_cast<int>((WindowBytes + mRowBytes) / (mRowBytes + 1));
+        
+        int bands = (height + mBandRows - 1) / mBandRows;
+        int threads = min(static_cast<int>(thread::hardware_concurrency()), bands);
+        if (threads > 1)
+            for (int i = 0; i < threads; ++i)
+                mWorkers.emplace_back(&bandEncoder::work, this);
+    }
+    
+    bandEncoder::~bandEncoder()
+    {
+        {
+            lock_guard<mutex> lock(mMutex);
+            mAbort = true;
+        }
+        mCond.notify_all();
+        for (thread& worker: mWorkers)
+            worker.join();
+    }
+    
+    void
+    bandEncoder::addRows(const png_byte* rows, size_t stride, int count)
+    {
+        for (int i = 0; i < count; ++i, rows += stride) {
+            if (mRowsIn == mHeight)
+                throw "too many PNG rows";
+            mPending->rows.insert(mPending->rows.end(), rows, rows + mRowBytes);
+            if (++mRowsIn - mPending->first == mBandRows || mRowsIn == mHeight)
+                submit();
+        }
+    }
+    
+    void
+    bandEncoder::finish()
+    {
+        if (mRowsIn < mHeight)
+            throw "missing PNG rows";
+        write(0);
+    }
+    
+    void
+    bandEncoder::submit()
+    {
+        Band* band = mPending.get();
+        band->last = mRowsIn;
+        
+        unique_ptr<Band> next(new Band);
+        int rows = static_cast<int>(band->rows.size() / mRowBytes);
+        next->context = min(rows, mContextRows);
+        next->first = mRowsIn;
+        next->rows.assign(band->rows.end() - next->context * mRowBytes, band->rows.end());
+        
+        if (mWorkers.empty()) {
+            encode(*band);
+            band->done = true;
+            mBands.push_back(move(mPending));
+        } else {
+            {
+                lock_guard<mutex> lock(mMutex);
+                mBands.push_back(move(mPending));
+                mQueue.push_back(band);
+            }
+            mCond.notify_all();
+        }
+        mPending = move(next);
+        
+        // Stay a couple of bands per thread ahead of the writer, so that
+        // the compressed image isn't all held in memory
+        write(2 * mWorkers.size());
+    }
+    
+    // Writes the bands that are done, in order, and waits for more until
+    // no more than ahead are left
+    void
+    bandEncoder::write(size_t ahead)
+    {
+        static const png_byte idat[5] = "IDAT";
+        while (!mBands.empty()) {
+            Band& band = *mBands.front();
+            {
+                unique_lock<mutex> lock(mMutex);
+                if (!band.done && mBands.size() <= ahead)
+                    return;
+                mCond.wait(lock, [&]() { return band.done; });
+            }
+            if (band.error)
+                throw band.error;
+            
+            mAdler = adler32_combine(mAdler, band.adler, static_cast<z_off_t>(band.length));
+            if (band.last == mHeight)
+                for (int shift = 24; shift >= 0; shift -= 8)
+                    band.data.push_back(static_cast<png_byte>(mAdler >> shift));
+            png_write_chunk(mPng, idat, band.data.data(), band.data.size());
+            mBands.pop_front();
+        }
+    }
+    
+    void
+    bandEncoder::work()
+    {
+        unique_lock<mutex> lock(mMutex);
+        for (;;) {
+            mCond.wait(lock, [&]() { return mAbort || !mQueue.empty(); });
+            if (mAbort)
+                return;
+            Band* band = mQueue.front();
+            mQueue.pop_front();
+            lock.unlock();
+            encode(*band);
+            lock.lock();
+            band->done = true;
+            mCond.notify_all();
+        }
+    }
+    
+    void
+    bandEncoder::encode(Band& band)
+    {
+        size_t filteredBytes = mRowBytes + 1;
+        
+        // The context rows before the band fill the deflate window, the
+        // first of them only feeds the filters if there are enough
+        int windowRows = min(band.context, mContextRows - 1);
+        const png_byte* src = band.rows.data();
+        int count = static_cast<int>(band.rows.size() / mRowBytes);
+        
+        vector<png_byte> rows(2 * mRowBytes, 0);
+        png_byte* row = rows.data();
+        png_byte* prev = row + mRowBytes;
+        int start = 0;
+        if (band.context > windowRows) {
+            abstractPngCanvas::ConvertRow(mFormat, src, prev, mWidth);
+            start = 1;
+        }
+        
+        int candidates = mFilter == pngCanvas::FilterAdaptive ? 5 : 1;
+        vector<png_byte> filtered(candidates * filteredBytes);
+        vector<png_byte> window;
+        
+        z_stream z;
+        memset(&z, 0, sizeof(z));
+        int strategy = mFilter == pngCanvas::FilterNone ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+        if (deflateInit2(&z, mLevel, Z_DEFLATED, -15, 8, strategy) != Z_OK) {
+            band.error = "couldn't start PNG compression";
+            return;
+        }
+        
+        // The first band carries the zlib header
+        size_t header = band.first ? 0 : 2;
+        band.data.resize(header + deflateBound(&z, (count - band.context) * filteredBytes) + 64);
+        if (header) {
+            int flevel = mLevel < 2 ? 0 : mLevel < 6 ? 1 : mLevel == 6 ? 2 : 3;
+            unsigned check = 0x7800 | (flevel << 6);
+            check += 31 - check % 31;
+            band.data[0] = static_cast<png_byte>(check >> 8);
+            band.data[1] = static_cast<png_byte>(check);
+        }
+        z.next_out = band.data.data() + header;
+        z.avail_out = static_cast<uInt>(band.data.size() - header);
+        band.adler = adler32(0, nullptr, 0);
+        
+        auto compress = [&](const png_byte* in, size_t len, int flush) {
+            z.next_in = const_cast<png_byte*>(in);
+            z.avail_in = static_cast<uInt>(len);
+            for (;;) {
+                if (z.avail_out == 0) {
+                    size_t used = z.next_out - band.data.data();
+                    band.data.resize(used + max<size_t>(used / 2, 4096));
+                    z.next_out = band.data.data() + used;
+                    z.avail_out = static_cast<uInt>(band.data.size() - used);
+                }
+                int ret = deflate(&z, flush);
+                if (ret == Z_STREAM_ERROR)
+                    return false;
+                if (flush == Z_FINISH ? ret == Z_STREAM_END : z.avail_out != 0)
+                    return true;
+            }
+        };
+        
+        for (int r = start; r < count; ++r) {
+            abstractPngCanvas::ConvertRow(mFormat, src + r * mRowBytes, row, mWidth);
+            const png_byte* out = filtered.data();
+            if (mFilter == pngCanvas::FilterAdaptive) {
+                size_t best = 0;
+                for (int type = 0; type < 5; ++type) {
+                    png_byte* candidate = filtered.data() + type * filteredBytes;
+                    filterRow(type, mBpp, row, prev, mRowBytes, candidate);
+                    size_t cost = filterCost(candidate + 1, mRowBytes);
+                    if (type == 0 || cost < best) {
+                        best = cost;
+                        out = candidate;
+                    }
+                }
+            } else {
+                filterRow(mFilter, mBpp, row, prev, mRowBytes, filtered.data());
+            }
+            
+            if (r < band.context) {
+                window.insert(window.end(), out, out + filteredBytes);
+            } else {
+                if (r == band.context && !window.empty()) {
+                    size_t skip = window.size() > WindowBytes ? window.size() - WindowBytes : 0;
+                    deflateSetDictionary(&z, window.data() + skip,
+                                         static_cast<uInt>(window.size() - skip));
+                }
+                band.adler = adler32(band.adler, out, static_cast<uInt>(filteredBytes));
+                band.length += filteredBytes;
+                int flush = r + 1 < count ? Z_NO_FLUSH :
+                            band.last == mHeight ? Z_FINISH : Z_SYNC_FLUSH;
+                if (!compress(out, filteredBytes, flush)) {
+                    band.error = "PNG compression failed";
+                    break;
+                }
+            }
+            swap(row, prev);
+        }
+        band.data.resize(z.next_out - band.data.data());
+        deflateEnd(&z);
+        
+        vector<png_byte>().swap(band.rows);
+    }
 }
 
-const char* prettyInt(unsigned long);
+// The PNG being written, from beginOutput() to endOutput()
+struct pngCanvas::Output {
+    FILE* file = nullptr;
+    png_structp png_ptr = nullptr;
+    png_infop info_ptr = nullptr;
+    unique_ptr<bandEncoder> encoder;
+    
+    ~Output()
+    {
+        encoder.reset();
+        if (file && file != stdout)     fclose(file);
+        if (png_ptr)    png_destroy_write_struct(&png_ptr, &info_ptr);
+    }
+};
 
-void pngCanvas::output(const char* outfilename, int frame)
+pngCanvas::pngCanvas(const char* outfilename, bool quiet, int width, int height,
+                     PixelFormat pixfmt, bool crop, int frameCount, int variation,
+                     bool wallpaper, Renderer *r, int mx, int my, size_t bandBytes)
+: abstractPngCanvas(outfilename, quiet, width, height, pixfmt, crop,
+                    frameCount, variation, wallpaper, r, mx, my, bandBytes),
+  mCompressionLevel(6), mFilterStrategy(FilterAdaptive)
 {
-    FILE *out = nullptr;
-    png_structp png_ptr = 0;
-    png_infop info_ptr = 0;
+}
+
+pngCanvas::~pngCanvas() = default;
+
+bool
+pngCanvas::beginOutput(const char* outfilename, int frame, int width, int height)
+{
+    mOutput.reset();
+    unique_ptr<Output> out(new Output);
 
-    std::unique_ptr<png_byte[]> row;
-    std::unique_ptr<png_uint_16[]> row16;
-    if (mPixelFormat & Has_16bit_Color)
-        row16.reset(new png_uint_16[mStride]);
-    else
-        row.reset(new png_byte[mStride]);
-    
     try {
-        png_ptr = png_create_write_struct(
+        out->png_ptr = png_create_write_struct(
             PNG_LIBPNG_VER_STRING,
             0, pngWriteError, pngWriteWarning);
-        if (!png_ptr) throw "couldn't create png write struct";
+        if (!out->png_ptr) throw "couldn't create png write struct";
 
-        png_infop info_ptr = png_create_info_struct(png_ptr);
-        if (!info_ptr) throw "couldn't create png info struct";
+        out->info_ptr = png_create_info_struct(out->png_ptr);
+        if (!out->info_ptr) throw "couldn't create png info struct";
 
         if (*outfilename) {
-            out = fopen(outfilename, "wb");
+            out->file = fopen(outfilename, "wb");
         } else {
-            out = stdout;
+            out->file = stdout;
 #ifdef WIN32
             setmode(fileno(stdout), O_BINARY);
 #endif
         }
-        if (!out) {
+        if (!out->file) {
             cerr << "Couldn't open " << outfilename << "\n";
             throw false;
         }
 
-        png_init_io(png_ptr, out);
+        png_init_io(out->png_ptr, out->file);
         
         int pngFormat;
         switch (mPixelFormat) {
@@ -106,24 +481,7 @@ void pngCanvas::output(const char* outfilename, int frame)
                 throw "Unknown pixel format";
         }
         
-        int width = mFullWidth;
-        int height = mFullHeight;
-        int srcx = 0;
-        int srcy = 0;
-        if (mCrop) {
-            width = cropWidth();
-            height = cropHeight();
-            srcx = cropX();
-            srcy = cropY();
-        }
-
-        if (frame == -1 && !mQuiet) {
-            cerr << endl << "Writing "
-                 << prettyInt(static_cast<unsigned long>(width)) << "w x "
-                 << prettyInt(static_cast<unsigned long>(height)) << "h pixel image..." << endl;
-        } 
-        
-        png_set_IHDR(png_ptr, info_ptr,
+        png_set_IHDR(out->png_ptr, out->info_ptr,
             width, height, (mPixelFormat & Has_16bit_Color) + 8, pngFormat,
             PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
             PNG_FILTER_TYPE_DEFAULT);
@@ -136,64 +494,68 @@ void pngCanvas::output(const char* outfilename, int frame)
         comments[0].key = myKey;
         comments[0].text = myValue;
         comments[0].text_length = strlen(comments[0].text);
-        png_set_text(png_ptr, info_ptr,
+        png_set_text(out->png_ptr, out->info_ptr,
             comments, sizeof(comments)/sizeof(comments[0]));
 
-        png_write_info(png_ptr, info_ptr);
-
-        png_bytep rowPtr = mData.get() + srcy * mStride + srcx * aggCanvas::BytesPerPixel.at(mPixelFormat);
-        for (int r = 0; r < height; ++r) {
-            if (mPixelFormat == aggCanvas::RGBA8_Blend) {
-                // Convert each row to non-premultiplied alpha as per PNG spec
-                // This is done in a separate array instead of in-situ because
-                // for animations the main buffer might be drawn into again
-                for (int c = 0; c < width * 4; c += 4) {
-                    agg::rgba8 pix(rowPtr[c + 0], rowPtr[c + 1], rowPtr[c + 2], rowPtr[c + 3]);
-                    pix.demultiply();
-                    row[c + 0] = pix.r; 
-                    row[c + 1] = pix.g;
-                    row[c + 2] = pix.b; 
-                    row[c + 3] = pix.a;
-                }
-                png_write_row(png_ptr, row.get());
-            } else if (mPixelFormat == aggCanvas::RGBA16_Blend) {
-                // Ditto for rgba16
-                png_uint_16p rowPtr16 = reinterpret_cast<png_uint_16p>(rowPtr);
-                for (int c = 0; c < width * 4; c += 4) {
-                    agg::rgba16 pix(rowPtr16[c + 0], rowPtr16[c + 1], rowPtr16[c + 2], rowPtr16[c + 3]);
-                    pix.demultiply();
-                    row16[c + 0] = htons(pix.r);    // Also convert to network byte order
-                    row16[c + 1] = htons(pix.g);
-                    row16[c + 2] = htons(pix.b); 
-                    row16[c + 3] = htons(pix.a);
-                }
-                png_write_row(png_ptr, reinterpret_cast<png_bytep>(row16.get()));
-            } else if (mPixelFormat & Has_16bit_Color) {
-                // Convert rgb16/gray16 to network byte order
-                png_uint_16p rowPtr16 = reinterpret_cast<png_uint_16p>(rowPtr);
-                for (int c = 0; c < width * (BytesPerPixel.at(mPixelFormat) >> 1); ++c) 
-                    row16[c] = htons(rowPtr16[c]);
-                png_write_row(png_ptr, reinterpret_cast<png_bytep>(row16.get()));
-            } else {
-                png_write_row(png_ptr, rowPtr);
-            }
-            rowPtr += mStride;
-        }
+        png_write_info(out->png_ptr, out->info_ptr);
 
-        png_write_end(png_ptr, 0);
+        out->encoder.reset(new bandEncoder(out->png_ptr, mPixelFormat, width, height,
+                                           mCompressionLevel, mFilterStrategy));
+        mOutput = move(out);
+        return true;
+    }
+    catch (const char* msg) {
+        cerr << "***" << msg << endl;
+    }
+    catch (bool) { }
+    
+    return false;
+}
 
-        if (out != stdout) {
-            if (fclose(out) != 0) throw "File I/O error!?!?!";
-            out = nullptr;
-        }
+void
+pngCanvas::outputRows(const unsigned char* rows, int count)
+{
+    if (!mOutput)
+        return;
+    
+    try {
+        mOutput->encoder->addRows(rows, mStride, count);
+        return;
     }
     catch (const char* msg) {
         cerr << "***" << msg << endl;
     }
     catch (bool) { }
     
-    if (out && out != stdout)        fclose(out), out = nullptr;
-    if (png_ptr)    png_destroy_write_struct(&png_ptr, &info_ptr);
+    mOutput.reset();
 }
 
+bool
+pngCanvas::endOutput()
+{
+    if (!mOutput)
+        return false;
+    
+    bool written = false;
+    try {
+        mOutput->encoder->finish();
+        mOutput->encoder.reset();
+
+        static const png_byte iend[5] = "IEND";
+        png_write_chunk(mOutput->png_ptr, iend, nullptr, 0);
 
+        if (mOutput->file != stdout) {
+            FILE* file = mOutput->file;
+            mOutput->file = nullptr;
+            if (fclose(file) != 0) throw "File I/O error!?!?!";
+        }
+        written = true;
+    }
+    catch (const char* msg) {
+        cerr << "***" << msg << endl;
+    }
+    catch (bool) { }
+    
+    mOutput.reset();
+    return written;
+}
@@ -27,18 +27,37 @@
 //
 
 #include "abstractPngCanvas.h"
+#include <memory>
 
 class pngCanvas : public abstractPngCanvas
 {
 public:
+    // PNG row filters, plus picking the best filter for each row
+    enum FilterStrategy {
+        FilterNone = 0, FilterSub = 1, FilterUp = 2, FilterAverage = 3,
+        FilterPaeth = 4, FilterAdaptive = 5
+    };
+    
     pngCanvas(const char* outfilename, bool quiet, int width, int height, 
               PixelFormat pixfmt, bool crop, int frameCount, int variation,
-              bool wallpaper, Renderer *r, int mx, int my)
-    : abstractPngCanvas(outfilename, quiet, width, height, pixfmt, crop,
-                        frameCount, variation, wallpaper, r, mx, my)
+              bool wallpaper, Renderer *r, int mx, int my,
+              std::size_t bandBytes = 0);
+    ~pngCanvas() override;
+    
+    void setCompression(int level, FilterStrategy filter)
     {
+        mCompressionLevel = level;
+        mFilterStrategy = filter;
     }
 protected:
-    void output(const char * outfilename, int frame = -1) override;
+    bool beginOutput(const char* outfilename, int frame, int width, int height) override;
+    void outputRows(const unsigned char* rows, int count) override;
+    bool endOutput() override;
+    
+    int mCompressionLevel;
+    FilterStrategy mFilterStrategy;
+    
+private:
+    struct Output;
+    std::unique_ptr<Output> mOutput;
 };
-
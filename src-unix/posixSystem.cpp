@@ -42,6 +42,30 @@
 #include <cstdint>
 using namespace std;
 
+PosixSystem::PosixSystem()
+: mNextTempDir(0)
+{
+    struct stat sb;
+    if (const char* dirs = getenv("CFDG_TEMPDIRS")) {
+        string list(dirs);
+        string::size_type start = 0;
+        while (start <= list.length()) {
+            string::size_type end = list.find(':', start);
+            if (end == string::npos)
+                end = list.length();
+            string dir = list.substr(start, end - start);
+            if (!dir.empty() && stat(dir.c_str(), &sb) == 0 && S_ISDIR(sb.st_mode))
+                mTempDirs.push_back(std::move(dir));
+            start = end + 1;
+        }
+    }
+    if (mTempDirs.empty())
+        mTempDirs.emplace_back(tempFileDirectory());
+    for (string& dir: mTempDirs)
+        if (dir.back() != '/')
+            dir.push_back('/');
+}
+
 void
 PosixSystem::clearAndCR()
 {
@@ -69,9 +93,9 @@ PosixSystem::tempFileDirectory()
 ostream*
 PosixSystem::tempFileForWrite(AbstractSystem::TempType tt, string& nameOut)
 {
-    string t(tempFileDirectory());
-    if (t.back() != '/')
-        t.push_back('/');
+    // Parallel frame expansion creates temp files from its worker threads
+    unsigned dir = mNextTempDir++ % static_cast<unsigned>(mTempDirs.size());
+    string t(mTempDirs[dir]);
     t.append(TempPrefixes[tt]);
     t.append("XXXXXX");
     
@@ -105,15 +129,15 @@ vector<string>
 PosixSystem::findTempFiles()
 {
     vector<string> ret;
-    const char* dirname = tempFileDirectory();
     size_t len = strlen(TempPrefixAll);
-    unique_ptr<DIR, decltype(&closedir)> dirp(opendir(dirname), &closedir);
-    while (dirent* der = readdir(dirp.get())) {
-        if (strncmp(TempPrefixAll, der->d_name, len) == 0) {
-            ret.emplace_back(dirname);
-            if (ret.back().back() != '/')
-                ret.back().push_back('/');
-            ret.back().append(der->d_name);
+    for (const string& dirname: mTempDirs) {
+        unique_ptr<DIR, decltype(&closedir)> dirp(opendir(dirname.c_str()), &closedir);
+        if (!dirp) continue;
+        while (dirent* der = readdir(dirp.get())) {
+            if (strncmp(TempPrefixAll, der->d_name, len) == 0) {
+                ret.emplace_back(dirname);
+                ret.back().append(der->d_name);
+            }
         }
     }
     
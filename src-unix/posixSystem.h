@@ -30,13 +30,14 @@
 #define INCLUDE_POSIX_SYSTEM
 
 #include "cfdg.h"
+#include <atomic>
 
 class PosixSystem : public AbstractSystem
 {
 protected:
     virtual void clearAndCR();
 public:
-    PosixSystem() = default;
+    PosixSystem();
     ~PosixSystem() override = default;
     
     void catastrophicError(const char* what) override;
@@ -48,6 +49,12 @@ public:
     std::string relativeFilePath(
         const std::string& base, const std::string& rel) override;
     size_t getPhysicalMemory() override;
+    
+private:
+    std::vector<std::string> mTempDirs;
+        // from CFDG_TEMPDIRS, a colon-separated list of directories; temp
+        // files are placed in them round-robin
+    std::atomic<unsigned> mNextTempDir;
 };
 
 #endif // INCLUDE_POSIX_SYSTEM
@@ -0,0 +1,314 @@
+// rawCanvas.cpp
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+#include "rawCanvas.h"
+#include <cstring>
+#include <iostream>
+#ifdef WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+using namespace std;
+
+rawCanvas::rawCanvas(Format format, const char* outfilename, bool quiet,
+                     int width, int height, PixelFormat pixfmt, bool crop,
+                     int frameCount, int variation, bool wallpaper,
+                     Renderer *r, int mx, int my, size_t bandBytes)
+: abstractPngCanvas(outfilename, quiet, width, height, pixfmt, crop,
+                    frameCount, variation, wallpaper, r, mx, my, bandBytes),
+  mFormat(format), mFile(nullptr), mOutputWidth(0), mSamples(0), mRun(0)
+{
+    switch (pixfmt & ~Has_16bit_Color) {
+        case Gray8_Blend:   mSamples = 1; break;
+        case RGB8_Blend:    mSamples = 3; break;
+        case RGBA8_Blend:   mSamples = 4; break;
+        default: break;
+    }
+}
+
+rawCanvas::~rawCanvas()
+{
+    close();
+}
+
+bool
+rawCanvas::open(const char* outfilename)
+{
+    // Keep appending frames to the same output
+    if (mFile && mFileName == outfilename)
+        return true;
+    
+    close();
+    if (*outfilename) {
+        mFile = fopen(outfilename, "wb");
+    } else {
+        mFile = stdout;
+#ifdef WIN32
+        setmode(fileno(stdout), O_BINARY);
+#endif
+    }
+    if (!mFile) {
+        cerr << "Couldn't open " << outfilename << "\n";
+        return false;
+    }
+    mFileName = outfilename;
+    return true;
+}
+
+void
+rawCanvas::close()
+{
+    if (mFile && mFile != stdout)
+        fclose(mFile);
+    else if (mFile)
+        fflush(mFile);
+    mFile = nullptr;
+}
+
+void
+rawCanvas::put(const vector<unsigned char>& bytes)
+{
+    if (fwrite(bytes.data(), 1, bytes.size(), mFile) != bytes.size())
+        throw "File I/O error!?!?!";
+}
+
+bool
+rawCanvas::beginOutput(const char* outfilename, int frame, int width, int height)
+{
+    try {
+        if (!mSamples)
+            throw "Unknown pixel format";
+        if (!open(outfilename))
+            return false;
+        
+        mOutputWidth = width;
+        switch (mFormat) {
+            case PNM:
+                headerPNM(width, height);
+                mRow.resize(width * BytesPerPixel.at(mPixelFormat));
+                break;
+            case QOI:
+                headerQOI(width, height);
+                mRow.resize(width * BytesPerPixel.at(mPixelFormat));
+                break;
+            case RGBA:
+                mRow.resize(width * 4 * ((mPixelFormat & Has_16bit_Color) ? 2 : 1));
+                break;
+        }
+        return true;
+    }
+    catch (const char* msg) {
+        cerr << "***" << msg << endl;
+        close();
+    }
+    return false;
+}
+
+void
+rawCanvas::outputRows(const unsigned char* rows, int count)
+{
+    if (!mFile)
+        return;
+    
+    try {
+        for (int r = 0; r < count; ++r, rows += mStride) {
+            switch (mFormat) {
+                case PNM:
+                    rowPNM(rows);
+                    break;
+                case QOI:
+                    rowQOI(rows);
+                    break;
+                case RGBA:
+                    rowRGBA(rows);
+                    break;
+            }
+        }
+    }
+    catch (const char* msg) {
+        cerr << "***" << msg << endl;
+        close();
+    }
+}
+
+bool
+rawCanvas::endOutput()
+{
+    if (!mFile)
+        return false;
+    
+    try {
+        if (mFormat == QOI) {
+            mOut.clear();
+            if (mRun)
+                mOut.push_back(static_cast<unsigned char>(0xc0 | (mRun - 1)));
+            mOut.insert(mOut.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+            put(mOut);
+        }
+        
+        // A reader at the other end of a pipe gets each frame when it is done
+        if (fflush(mFile) != 0)
+            throw "File I/O error!?!?!";
+    }
+    catch (const char* msg) {
+        cerr << "***" << msg << endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void
+rawCanvas::headerPNM(int width, int height)
+{
+    int maxval = (mPixelFormat & Has_16bit_Color) ? 65535 : 255;
+    switch (mSamples) {
+        case 1:
+            fprintf(mFile, "P5\n%d %d\n%d\n", width, height, maxval);
+            break;
+        case 3:
+            fprintf(mFile, "P6\n%d %d\n%d\n", width, height, maxval);
+            break;
+        case 4:
+            fprintf(mFile, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL %d\n"
+                           "TUPLTYPE RGB_ALPHA\nENDHDR\n", width, height, maxval);
+            break;
+    }
+}
+
+// PAM alpha is not premultiplied and 16-bit samples are big-endian, same as
+// PNG
+void
+rawCanvas::rowPNM(const unsigned char* src)
+{
+    ConvertRow(mPixelFormat, src, mRow.data(), mOutputWidth);
+    put(mRow);
+}
+
+// The Quite OK Image format, see qoiformat.org. Encodes at about the speed
+// of a memory copy and compresses a lot better than none at all.
+void
+rawCanvas::headerQOI(int width, int height)
+{
+    vector<unsigned char> out = { 'q', 'o', 'i', 'f' };
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<unsigned char>(width >> shift));
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<unsigned char>(height >> shift));
+    out.push_back(mSamples == 4 ? 4 : 3);
+    out.push_back(0);           // sRGB with linear alpha
+    put(out);
+    
+    mPrev[0] = mPrev[1] = mPrev[2] = 0;
+    mPrev[3] = 255;
+    memset(mIndex, 0, sizeof(mIndex));
+    mRun = 0;
+}
+
+void
+rawCanvas::rowQOI(const unsigned char* src)
+{
+    int samples = mSamples;
+    bool wide = (mPixelFormat & Has_16bit_Color) != 0;
+    const vector<unsigned char>& row = mRow;
+    vector<unsigned char>& out = mOut;
+    unsigned char* prev = mPrev;
+    int& run = mRun;
+    
+    ConvertRow(mPixelFormat, src, mRow.data(), mOutputWidth);
+    out.clear();
+    for (int x = 0; x < mOutputWidth; ++x) {
+        unsigned char px[4];
+        for (int s = 0; s < samples; ++s) {
+            int i = x * samples + s;
+            px[s] = wide ? static_cast<unsigned char>(((row[2 * i] << 8 | row[2 * i + 1]) + 128) / 257)
+                         : row[i];
+        }
+        if (samples == 1)
+            px[1] = px[2] = px[0];
+        if (samples != 4)
+            px[3] = 255;
+        
+        if (memcmp(px, prev, 4) == 0) {
+            if (++run == 62) {
+                out.push_back(static_cast<unsigned char>(0xc0 | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run) {
+            out.push_back(static_cast<unsigned char>(0xc0 | (run - 1)));
+            run = 0;
+        }
+        
+        int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+        if (memcmp(mIndex[hash], px, 4) == 0) {
+            out.push_back(static_cast<unsigned char>(hash));
+        } else {
+            memcpy(mIndex[hash], px, 4);
+            if (px[3] == prev[3]) {
+                int dr = static_cast<signed char>(px[0] - prev[0]);
+                int dg = static_cast<signed char>(px[1] - prev[1]);
+                int db = static_cast<signed char>(px[2] - prev[2]);
+                int dr_dg = dr - dg;
+                int db_dg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    out.push_back(static_cast<unsigned char>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 &&
+                           db_dg >= -8 && db_dg <= 7) {
+                    out.push_back(static_cast<unsigned char>(0x80 | (dg + 32)));
+                    out.push_back(static_cast<unsigned char>((dr_dg + 8) << 4 | (db_dg + 8)));
+                } else {
+                    out.insert(out.end(), { 0xfe, px[0], px[1], px[2] });
+                }
+            } else {
+                out.insert(out.end(), { 0xff, px[0], px[1], px[2], px[3] });
+            }
+        }
+        memcpy(prev, px, 4);
+    }
+    put(out);
+}
+
+// The canvas pixels as they are, widened to RGBA, for tools that take raw
+// video (e.g. ffmpeg -f rawvideo -pix_fmt rgba or rgba64le)
+void
+rawCanvas::rowRGBA(const unsigned char* src)
+{
+    int sample = (mPixelFormat & Has_16bit_Color) ? 2 : 1;
+    if (mSamples == 4) {
+        memcpy(mRow.data(), src, mRow.size());
+    } else {
+        unsigned char* dst = mRow.data();
+        for (int x = 0; x < mOutputWidth; ++x) {
+            for (int s = 0; s < 3; ++s, dst += sample)
+                memcpy(dst, src + (mSamples == 3 ? s * sample : 0), sample);
+            memset(dst, 0xff, sample);      // opaque
+            dst += sample;
+            src += mSamples * sample;
+        }
+    }
+    put(mRow);
+}
@@ -0,0 +1,82 @@
+// rawCanvas.h
+// this file is part of Context Free
+// ---------------------
+// Copyright (C) 2026 Context Free contributors
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+// 
+// John Horigan can be contacted at john@glyphic.com or at
+// John Horigan, 1209 Villa St., Mountain View, CA 94041-1123, USA
+//
+//
+
+// Bitmap output for feeding renders to other tools, without the cost of PNG
+// compression: PAM/PPM/PGM, QOI, or the raw premultiplied RGBA canvas
+// pixels. Animation frames that all go to the same output (stdout, or a
+// file name without %f) are written back to back into one stream, so they
+// can be piped into an external encoder.
+
+#ifndef INCLUDE_RAWCANVAS_H
+#define INCLUDE_RAWCANVAS_H
+
+#include "abstractPngCanvas.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class rawCanvas : public abstractPngCanvas
+{
+public:
+    enum Format {
+        PNM,    // PGM, PPM or PAM (with alpha), 8 or 16 bits per sample
+        QOI,    // 8 bits per sample, RGB or RGBA
+        RGBA    // premultiplied RGBA, 8 or 16 bits in native byte order
+    };
+    
+    rawCanvas(Format format, const char* outfilename, bool quiet, int width,
+              int height, PixelFormat pixfmt, bool crop, int frameCount,
+              int variation, bool wallpaper, Renderer *r, int mx, int my,
+              std::size_t bandBytes = 0);
+    ~rawCanvas() override;
+protected:
+    bool beginOutput(const char* outfilename, int frame, int width, int height) override;
+    void outputRows(const unsigned char* rows, int count) override;
+    bool endOutput() override;
+    
+private:
+    Format mFormat;
+    FILE* mFile;
+    std::string mFileName;
+    int mOutputWidth;
+    int mSamples;
+    std::vector<unsigned char> mRow;
+    std::vector<unsigned char> mOut;
+    
+    // QOI encoder state, carried from row to row
+    unsigned char mPrev[4];
+    unsigned char mIndex[64][4];
+    int mRun;
+    
+    bool open(const char* outfilename);
+    void close();
+    void headerPNM(int width, int height);
+    void headerQOI(int width, int height);
+    void rowPNM(const unsigned char* src);
+    void rowQOI(const unsigned char* src);
+    void rowRGBA(const unsigned char* src);
+    void put(const std::vector<unsigned char>& bytes);
+};
+
+#endif  // INCLUDE_RAWCANVAS_H
@@ -37,6 +37,39 @@
 
 using namespace std;
 
+Win32System::Win32System()
+: mNextTempDir(0)
+{
+    wchar_t wdirs[32768];
+    char buf[32768];
+    DWORD len = ::GetEnvironmentVariableW(L"CFDG_TEMPDIRS", wdirs, 32768);
+    if (len > 0 && len < 32768 &&
+        ::WideCharToMultiByte(CP_UTF8, 0, wdirs, -1, buf, 32768, NULL, NULL))
+    {
+        string list(buf);
+        string::size_type start = 0;
+        while (start <= list.length()) {
+            string::size_type end = list.find(';', start);
+            if (end == string::npos)
+                end = list.length();
+            string dir = list.substr(start, end - start);
+            wchar_t wdir[32768];
+            if (!dir.empty() &&
+                ::MultiByteToWideChar(CP_UTF8, 0, dir.c_str(), -1, wdir, 32768) &&
+                ::PathIsDirectoryW(wdir))
+            {
+                mTempDirs.push_back(std::move(dir));
+            }
+            start = end + 1;
+        }
+    }
+    if (mTempDirs.empty())
+        mTempDirs.emplace_back(tempFileDirectory());
+    for (string& dir: mTempDirs)
+        if (dir.back() != '\\' && dir.back() != '/')
+            dir.push_back('\\');
+}
+
 void
 Win32System::clearAndCR()
 {
@@ -83,8 +116,9 @@ Win32System::tempFileForWrite(AbstractSystem::TempType tt, string& nameOut)
 {    
     ofstream* f = nullptr;
     
+    unsigned dir = mNextTempDir++ % static_cast<unsigned>(mTempDirs.size());
     wchar_t wtempdir[32768];
-    if (!::MultiByteToWideChar(CP_UTF8, 0, tempFileDirectory(), -1, wtempdir, 32768))
+    if (!::MultiByteToWideChar(CP_UTF8, 0, mTempDirs[dir].c_str(), -1, wtempdir, 32768))
         return nullptr;
 
     wchar_t* b = _wtempnam(wtempdir, TempPrefixes_w[tt]);
@@ -124,31 +158,29 @@ vector<string>
 Win32System::findTempFiles()
 {
     vector<string> ret;
-    const char* tempdir = tempFileDirectory();
+    for (const string& tempdir: mTempDirs) {
+        wchar_t wtempdir[32768];
+        char buf[32768];
+        if (!::MultiByteToWideChar(CP_UTF8, 0, tempdir.c_str(), -1, wtempdir, 32768) ||
+            !::PathAppendW(wtempdir, TempPrefixAll_w) || 
+            wcsncat_s(wtempdir, 32768, L"*", 1))
+            continue;
+
+        ::WIN32_FIND_DATAW ffd;
+        unique_ptr<void, decltype(&FindClose)> fff(::FindFirstFileW(wtempdir, &ffd), &FindClose);
+        if (fff.get() == INVALID_HANDLE_VALUE) {
+            fff.release();  // Don't call FindClose() if invalid
+            continue;
+        }
 
-    wchar_t wtempdir[32768];
-    char buf[32768];
-    if (!::MultiByteToWideChar(CP_UTF8, 0, tempdir, -1, wtempdir, 32768) ||
-        !::PathAppendW(wtempdir, TempPrefixAll_w) || 
-        wcsncat_s(wtempdir, 32768, L"*", 1))
-        return ret;
-
-    ::WIN32_FIND_DATAW ffd;
-    unique_ptr<void, decltype(&FindClose)> fff(::FindFirstFileW(wtempdir, &ffd), &FindClose);
-    if (fff.get() == INVALID_HANDLE_VALUE) {
-        fff.release();  // Don't call FindClose() if invalid
-        return ret;     // Return empty
+        do {
+            if (::WideCharToMultiByte(CP_UTF8, 0, ffd.cFileName, -1, buf, 32768, NULL, NULL)) {
+                std::string name(tempdir);
+                name.append(buf);
+                ret.push_back(std::move(name));
+            }
+        } while (::FindNextFileW(fff.get(), &ffd));
     }
-
-    do {
-        if (::WideCharToMultiByte(CP_UTF8, 0, ffd.cFileName, -1, buf, 32768, NULL, NULL)) {
-            std::string name(tempdir);
-            if (name.back() != '\\')
-                name.push_back('\\');
-            name.append(buf);
-            ret.push_back(std::move(name));
-        }
-    } while (::FindNextFileW(fff.get(), &ffd));
     return ret;
 }
 
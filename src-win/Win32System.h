@@ -30,13 +30,16 @@
 #define INCLUDE_WIN32_SYSTEM
 
 #include "cfdg.h"
+#include <atomic>
+#include <string>
+#include <vector>
 
 class Win32System : public AbstractSystem
 {
 protected:
     virtual void clearAndCR();
 public:
-    Win32System() {};
+    Win32System();
     ~Win32System() {};
 
     virtual void catastrophicError(const char* what);
@@ -49,6 +52,12 @@ public:
 
     virtual std::string relativeFilePath(
         const std::string& base, const std::string& rel);
+
+private:
+    std::vector<std::string> mTempDirs;
+        // from CFDG_TEMPDIRS, a semicolon-separated list of directories;
+        // temp files are placed in them round-robin
+    std::atomic<unsigned> mNextTempDir;
 };
 
 #endif // INCLUDE_WIN32_SYSTEM
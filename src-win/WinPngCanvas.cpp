@@ -26,6 +26,7 @@
 #include <windows.h>
 #include "WinPngCanvas.h"
 #include <stdlib.h>
+#include <string.h>
 #include "makeCFfilename.h"
 
 #ifndef ULONG_PTR
@@ -51,11 +52,14 @@ int pngCanvas::CanvasCount = 0;
 
 pngCanvas::pngCanvas(const char* outfilename, bool quiet, int width, int height, 
                      PixelFormat pixfmt, bool crop, int frameCount,
-                     int variation, bool wallpaper, Renderer *r, int mx, int my)
+                     int variation, bool wallpaper, Renderer *r, int mx, int my,
+                     std::size_t bandBytes)
     : abstractPngCanvas(outfilename, quiet, 
                         wallpaper ? ::GetSystemMetrics(SM_CXFULLSCREEN) : width, 
                         wallpaper ? ::GetSystemMetrics(SM_CYFULLSCREEN) : height, 
-                        pixfmt, crop, frameCount, variation, wallpaper, r, mx, my)
+                        pixfmt, crop, frameCount, variation, wallpaper, r, mx, my,
+                        bandBytes),
+      mOutputFrame(-1), mOutputWidth(0), mOutputHeight(0), mOutputRows(0)
 {
     if (CanvasCount++ == 0)
         GdiplusStartup(&GdiPToken, &GdiPStartInput, &GdiPStartOutput);
@@ -128,13 +132,33 @@ static LPCSTR errorMsg[] = {
 
 static CLSID encClsid = CLSID_NULL;
 
-void pngCanvas::output(const char* outfilename, int frame)
+bool pngCanvas::beginOutput(const char* outfilename, int frame, int width, int height)
 {
-    int width = mFullWidth;
-    int height = mFullHeight;
+    mOutputName = outfilename;
+    mOutputFrame = frame;
+    mOutputWidth = width;
+    mOutputHeight = height;
+    mOutputRows = 0;
+    mOutputData.reset(new unsigned char[static_cast<size_t>(mStride) * height]);
+    return true;
+}
+
+void pngCanvas::outputRows(const unsigned char* rows, int count)
+{
+    size_t bytes = static_cast<size_t>(mOutputWidth) * BytesPerPixel.at(mPixelFormat);
+    for (; count > 0 && mOutputRows < mOutputHeight; --count, rows += mStride)
+        memcpy(mOutputData.get() + static_cast<size_t>(mOutputRows++) * mStride, rows, bytes);
+}
+
+bool pngCanvas::endOutput()
+{
+    const char* outfilename = mOutputName.c_str();
+    int frame = mOutputFrame;
+    int width = mOutputWidth;
+    int height = mOutputHeight;
     // If the canvas is 16-bit then copy it to an 8-bit version
     // and output that. GDI+ doesn't really support 16-bit modes.
-    unsigned char* data = mData.get();
+    unsigned char* data = mOutputData.get();
     int stride = mStride;
     int bpp = BytesPerPixel.at(mPixelFormat);
     std::unique_ptr<unsigned char[]> data8;
@@ -145,7 +169,7 @@ void pngCanvas::output(const char* outfilename, int frame)
         data8.reset(new unsigned char[stride * height]);
         bpp = bpp >> 1;
         unsigned char* row8 = data8.get();
-        unsigned char* srcrow = mData.get();
+        unsigned char* srcrow = mOutputData.get();
         for (int y = 0; y < height; ++y) {
             unsigned __int16* row16 = (unsigned __int16*)srcrow;
             for (int x = 0; x < width; ++x)
@@ -157,12 +181,6 @@ void pngCanvas::output(const char* outfilename, int frame)
         pf = (PixelFormat)(pf & (~Has_16bit_Color));
     }
 
-    if (mCrop) {
-        width = cropWidth();
-        height = cropHeight();
-        data += cropY() * stride + cropX() * BytesPerPixel.at(pf);
-    }
-
     WCHAR wpath[MAX_PATH];
     TCHAR fullpath[MAX_PATH];
 	size_t cvt;
@@ -172,7 +190,7 @@ void pngCanvas::output(const char* outfilename, int frame)
 
     if (encClsid == CLSID_NULL && GetEncoderClsid(mimetype, &encClsid) == -1) {
         cerr << endl << "Image encoder missing from GDI+!" << endl;
-        return;
+        return false;
     } 
 
     if (pf == aggCanvas::Gray8_Blend && !GrayPalette) {
@@ -200,11 +218,6 @@ void pngCanvas::output(const char* outfilename, int frame)
             break;
     }
 
-    if (frame == -1 && !mQuiet) {
-        cerr << endl << "Writing "
-             << width << "w x " << height << "h pixel image..." << endl;
-    }
-
     PropertyItem pi;
     pi.id = PropertyTagImageDescription;
     pi.type = PropertyTagTypeASCII;
@@ -240,7 +253,9 @@ void pngCanvas::output(const char* outfilename, int frame)
                              SPIF_SENDWININICHANGE | SPIF_UPDATEINIFILE);
     }
 
-    return;
+    saveBM.reset();
+    mOutputData.reset();
+    return s == Ok;
 }
 
 
@@ -23,19 +23,41 @@
 //
 
 #include "abstractPngCanvas.h"
+#include <memory>
+#include <string>
 
 class pngCanvas : public abstractPngCanvas
 {
 public:
+  // The same as the PNG row filters of the command line canvas. GDI+ picks
+  // its own compression and filters, so setCompression() does nothing here.
+  enum FilterStrategy {
+    FilterNone = 0, FilterSub = 1, FilterUp = 2, FilterAverage = 3,
+    FilterPaeth = 4, FilterAdaptive = 5
+  };
+
   pngCanvas(const char* outfilename, bool quiet, int width, int height, 
             PixelFormat pixfmt, bool crop, int frameCount, int variation,
-            bool wallpaper, Renderer *r, int mx, int my);
+            bool wallpaper, Renderer *r, int mx, int my,
+            std::size_t bandBytes = 0);
   ~pngCanvas();
 
+  void setCompression(int, FilterStrategy) { }
+
 protected:
-  virtual void output(const char * outfilename, int frame = -1);
+  virtual bool beginOutput(const char* outfilename, int frame, int width, int height);
+  virtual void outputRows(const unsigned char* rows, int count);
+  virtual bool endOutput();
 
 private:
   static int CanvasCount;
+
+  // GDI+ takes the whole image, so the rows are gathered here
+  std::string mOutputName;
+  int mOutputFrame;
+  int mOutputWidth;
+  int mOutputHeight;
+  int mOutputRows;
+  std::unique_ptr<unsigned char[]> mOutputData;
 };
 